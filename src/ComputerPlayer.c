@@ -0,0 +1,126 @@
+// src/ComputerPlayer.c
+#include "ComputerPlayer.h"
+#include <string.h>
+
+#define MIN_THINK_TIME_MS (COMPUTER_MOVE_TIME_MS / 10)
+
+void initComputerPlayer(ComputerPlayer* player) {
+    memset(player, 0, sizeof(*player));
+    initTranspositionTable(&player->tt, DEFAULT_TT_SIZE_MB);
+}
+
+void destroyComputerPlayer(ComputerPlayer* player) {
+    if (isSearchThreadRunning(&player->search)) {
+        stopSearchThread(&player->search);
+    }
+    freeTranspositionTable(&player->tt);
+}
+
+static void startThinking(ComputerPlayer* player, GameState* state, uint64_t hash, int timeLimitMs) {
+    SearchLimits limits = {0, timeLimitMs, NULL, &player->tt, NULL};
+    unsigned char color = state->blackTurn ? 1 : 0;
+    if (startSearchThread(&player->search, state->board, color, &state->lastDoublePushPawn, state->kingsPositions,
+                          &state->positionHistory, limits)) {
+        player->thinking = true;
+        player->searchHash = hash;
+        player->searchStart = SDL_GetTicks();
+    }
+}
+
+bool updateComputerPlayer(ComputerPlayer* player, GameState* state, EngineMove* move) {
+    unsigned char color = state->blackTurn ? 1 : 0;
+    uint64_t hash = hashPosition(state->board, color, &state->lastDoublePushPawn);
+
+    // The human has replied: the ponder search either was for this position or is useless
+    if (player->pondering) {
+        Uint32 ponderTime = SDL_GetTicks() - player->searchStart;
+        SearchResult result = stopSearchThread(&player->search);
+        player->pondering = false;
+
+        if (player->searchHash == hash) {
+            player->ponderHits++;
+            if (ponderTime >= COMPUTER_MOVE_TIME_MS && result.bestMove.from.x != -1) {
+                // Already thought for a full move: answer at once
+                player->timeSavedMs += COMPUTER_MOVE_TIME_MS;
+                player->lastResult = result;
+                *move = result.bestMove;
+                return true;
+            }
+
+            // Carry on for the rest of the move time; the table still holds the ponder search
+            player->timeSavedMs += ponderTime;
+            int remaining = COMPUTER_MOVE_TIME_MS - (int)ponderTime;
+            startThinking(player, state, hash, remaining > MIN_THINK_TIME_MS ? remaining : MIN_THINK_TIME_MS);
+            return false;
+        }
+
+        player->ponderMisses++;
+    }
+
+    if (!player->thinking) {
+        startThinking(player, state, hash, COMPUTER_MOVE_TIME_MS);
+        return false;
+    }
+
+    if (!isSearchThreadFinished(&player->search)) {
+        return false;
+    }
+    SearchResult result = joinSearchThread(&player->search);
+    player->thinking = false;
+
+    // The position changed under the search (undo, load); think again next frame
+    if (player->searchHash != hash || result.bestMove.from.x == -1) {
+        return false;
+    }
+
+    player->lastResult = result;
+    *move = result.bestMove;
+    return true;
+}
+
+void startPondering(ComputerPlayer* player, GameState* state) {
+    if (isSearchThreadRunning(&player->search) || player->lastResult.pvLength < 2) {
+        return;
+    }
+
+    // Play the expected reply on a copy of the game
+    unsigned char color = state->blackTurn ? 1 : 0;
+    unsigned char board[8][8];
+    Vector2f lastDoublePawn = state->lastDoublePushPawn;
+    Vector2f kings[2] = {state->kingsPositions[0], state->kingsPositions[1]};
+    PositionHistory history = state->positionHistory;
+    memcpy(board, state->board, sizeof(board));
+
+    EngineMove reply = player->lastResult.pv[1];
+    MoveList legalMoves;
+    generateMoves(board, color, &legalMoves, &lastDoublePawn);
+    bool legal = false;
+    for (int i = 0; i < legalMoves.count; i++) {
+        if (memcmp(&legalMoves.moves[i].from, &reply.from, sizeof(Vector2f)) == 0 &&
+            memcmp(&legalMoves.moves[i].to, &reply.to, sizeof(Vector2f)) == 0) {
+            legal = true;
+            break;
+        }
+    }
+
+    if (legal && getDrawReason(board, &history) == DRAW_NONE) {
+        bool irreversible = reply.capturedPiece != NONE || (board[reply.from.x][reply.from.y] & TYPE_MASK) == PAWN;
+        engineMakeMove(board, reply, &lastDoublePawn, kings, 0);
+        recordPosition(&history, board, color ^ 1, &lastDoublePawn, irreversible);
+
+        // No time limit: the search runs until the human moves or it reaches PONDER_MAX_DEPTH
+        SearchLimits limits = {PONDER_MAX_DEPTH, 0, NULL, &player->tt, NULL};
+        if (startSearchThread(&player->search, board, color ^ 1, &lastDoublePawn, kings, &history, limits)) {
+            player->pondering = true;
+            player->searchHash = history.hashes[history.count - 1];
+            player->searchStart = SDL_GetTicks();
+        }
+    }
+}
+
+void stopPondering(ComputerPlayer* player) {
+    if (player->pondering) {
+        stopSearchThread(&player->search);
+        player->pondering = false;
+    }
+}
@@ -0,0 +1,46 @@
+// src/ComputerPlayer.h
+#ifndef COMPUTERPLAYER_H
+#define COMPUTERPLAYER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <SDL2/SDL.h>
+#include "engine.h"
+#include "GameState.h"
+#include "SearchThread.h"
+
+#define COMPUTER_MOVE_TIME_MS 1000 // Thinking time per computer move in PvE
+#define PONDER_MAX_DEPTH 8         // Pondering stops here, a few seconds in the middlegame, if the human takes longer
+
+// The PvE opponent. Searches on a background thread so the window stays responsive,
+// and ponders the expected reply while the human is thinking.
+typedef struct {
+    TranspositionTable tt;      // Shared by thinking and pondering, so a ponder hit starts warm
+    SearchThread search;
+    bool thinking;              // Searching the current position for a move
+    bool pondering;             // Searching the position expected after the human's reply
+    uint64_t searchHash;        // Position the running search is for
+    Uint32 searchStart;
+    SearchResult lastResult;    // Result behind the last move played; its PV gives the ponder move
+
+    // Ponder statistics
+    int ponderHits;
+    int ponderMisses;
+    Uint32 timeSavedMs;
+} ComputerPlayer;
+
+void initComputerPlayer(ComputerPlayer* player);
+
+// Stops any search
+void destroyComputerPlayer(ComputerPlayer* player);
+
+// Call every frame on the computer's turn. Returns true with the move once one is ready.
+bool updateComputerPlayer(ComputerPlayer* player, GameState* state, EngineMove* move);
+
+// Call after the computer's move has been played: search the position after the expected reply
+void startPondering(ComputerPlayer* player, GameState* state);
+
+// Abandon the ponder search, e.g. when the game ends or the position is set some other way
+void stopPondering(ComputerPlayer* player);
+
+#endif // COMPUTERPLAYER_H
@@ -9,53 +9,16 @@
 #include "Events.h"
 #include "Piece.h"
 #include "GameState.h" // Now necessary
+#include "MoveHistoryView.h"
+#include "InputRecorder.h"
 #include "util.h" // For screenWidth, squareSize, etc. from util.c
 #include "app_globals.h" // For global enums/macros
 
 const int scrollStep = 20;
 
-// addMoveToHistory is already taking GameState* state, which is good.
-
-void addMoveToHistory(GameState* state, int startRow, int startCol, int endRow, int endCol, unsigned char piece) {
-    if (state->moveCount >= MAX_MOVES) return; // Use state->moveCount
-
-    const char *pieceChar;
-    switch (piece & TYPE_MASK) { // Using TYPE_MASK from Piece.h
-        case PAWN:
-            pieceChar = ""; // Pawn usually has no character, just notation like e4
-            break;
-        case KNIGHT:
-            pieceChar = "N";
-            break;
-        case BISHOP:
-            pieceChar = "B";
-            break;
-        case ROOK:
-            pieceChar = "R";
-            break;
-        case QUEEN:
-            pieceChar = "Q";
-            break;
-        case KING:
-            pieceChar = "K";
-            break;
-        default:
-            pieceChar = "?";
-            break;
-    }
-
-    char from[3] = {'a' + startCol, '8' - startRow, '\0'};
-    char to[3] = {'a' + endCol, '8' - endRow, '\0'};
-
-    snprintf(state->moveHistory[state->moveCount].notation, sizeof(state->moveHistory[state->moveCount].notation),
-             "%s%s%s", pieceChar, from, to);
-
-    state->moveCount++;
-}
-
 // In src/Events.c
-void getEvents(SDL_Event event, GameState *state, int *scrollOffset) {
-    while (SDL_PollEvent(&event)) {
+void getEvents(SDL_Event event, GameState *state, MoveHistoryView *moveHistory) {
+    while (pollInputEvent(&event)) {
         switch (event.type) {
             case SDL_QUIT:
                 state->gameRunning = false;
@@ -83,13 +46,8 @@ void getEvents(SDL_Event event, GameState *state, int *scrollOffset) {
                 break;
 
             case SDL_MOUSEWHEEL:
-                *scrollOffset -= event.wheel.y * scrollStep;
-                if (*scrollOffset < 0) *scrollOffset = 0;
-
-                // screenHeight should be visible via util.h
-                int maxScroll = (state->moveCount * 25) - screenHeight; // Use state->moveCount and global screenHeight
-                if (maxScroll < 0) maxScroll = 0;
-                if (*scrollOffset > maxScroll) *scrollOffset = maxScroll;
+                // Clamped to the moves there are by the list itself
+                scrollMoveHistory(moveHistory, -event.wheel.y * scrollStep, state->moveCount);
                 break;
 
             case SDL_TEXTINPUT:
@@ -111,9 +69,7 @@ void getEvents(SDL_Event event, GameState *state, int *scrollOffset) {
                             } else if (currentPromptAction == PROMPT_ACTION_LOAD) {
                                 loadGameFromFile(state, inputFileNameBuffer);
                                 // After loading, reset history to the loaded state
-                                historyCount = 0; // Clear existing history
-                                currentHistoryIdx = -1; // Reset index
-                                recordGameState(state); // Record the newly loaded state
+                                resetGameHistory(state);
                             }
                         } else {
                             printf("Filename cannot be empty. Please enter a name.\n");
@@ -150,38 +106,13 @@ bool mouseInsideBoard(int mouseX, int mouseY, int screenWidth_local, int squareS
 void selectAndHold(GameState *state, int squareX, int squareY) {
     state->pieceActions[0] = true;
     state->pieceActions[1] = true;
-    state->board[squareY][squareX] |= SELECTED_MASK;
     state->selectedSquare.x = squareX;
     state->selectedSquare.y = squareY;
 }
 
-// isMoveLegal now takes GameState* state
-bool isMoveLegal(GameState* state, int destX, int destY) {
-    unsigned char tempBoard[8][8];
-    Vector2f tempKingsPositions[2] = {state->kingsPositions[0], state->kingsPositions[1]}; // Copy king positions
-
-    // Copy the board to a temporary board
-    memcpy(tempBoard, state->board, sizeof(unsigned char) * 64);
-
-    // Get the color and type of the moving piece
-    int oldX = state->selectedSquare.x;
-    int oldY = state->selectedSquare.y;
-    unsigned char movingPiece = state->board[oldY][oldX];
-    unsigned int pieceType = movingPiece & TYPE_MASK;
-    unsigned int color = (movingPiece & COLOR_MASK) >> 4;
-
-    // Make the move on the temporary board
-    tempBoard[destY][destX] = tempBoard[oldY][oldX];
-    tempBoard[oldY][oldX] = 0;
-
-    // Update king position if king is moving
-    if(pieceType == KING) {
-        tempKingsPositions[color].x = destY;
-        tempKingsPositions[color].y = destX;
-    }
-
-    // Check if the king is in check after the move
-    return !isCheck(tempBoard, tempKingsPositions[color]);
+// The selected piece can legally move to the square
+static bool canMoveTo(GameState* state, int destX, int destY) {
+    return (getSelectedDestinations(state) & SQUARE_BIT(SQUARE(destY, destX))) != 0;
 }
 
 void makeMove(GameState *state, int destX, int destY) {
@@ -201,13 +132,10 @@ void makeMove(GameState *state, int destX, int destY) {
         }
     }
 
-    // Check if the move is legal (doesn't leave the king in check)
-    if (!isMoveLegal(state, destX, destY)) { // Pass state
-        printf("Illegal move! King would be in check.\n");
-        deselectPiece(state); // Pass state
-        clearPossibleBoard(state->board);
-        return;
-    }
+    // Write the move down while the board still shows the position it was played in
+    MoveGenContext gen;
+    initMoveGen(&gen, state->board, color, &state->lastDoublePushPawn);
+    addMoveToHistory(state, createEngineMove(&gen, state->board, SQUARE(oldY, oldX), SQUARE(destY, destX), QUEEN));
 
     // Check for capture
     unsigned char capturedPieceOnDest = state->board[destY][destX];
@@ -226,9 +154,6 @@ void makeMove(GameState *state, int destX, int destY) {
     // Move piece to destination
     state->board[destY][destX] = state->board[oldY][oldX];
 
-    // Deselect piece
-    state->board[destY][destX] &= (~SELECTED_MASK);
-
     // For kings and rooks, clear the MODIFIER flag
     if (pieceType == KING || pieceType == ROOK) {
         // Clear the MODIFIER flag (set it to 0)
@@ -260,7 +185,7 @@ void makeMove(GameState *state, int destX, int destY) {
             // if not a standard capture AND it was a diagonal move
             if(!isStandardCapture && abs(destX - oldX) == 1) { // This implies en passant if no piece at dest
                 // Check if the move was actually an en passant capture
-                if(lastDoubleX == destX && lastDoubleY == oldY + (color == 0 ? 1 : -1)) { // Pawn moved to square behind double-pushed pawn
+                if(lastDoubleX == destX && lastDoubleY == oldY) { // Pawn moved to square behind double-pushed pawn
                     printf("En passant capture executed: removing pawn at (%d, %d)\n", lastDoubleY, lastDoubleX);
                     state->board[lastDoubleY][lastDoubleX] = NONE;
 
@@ -325,9 +250,6 @@ void makeMove(GameState *state, int destX, int destY) {
     // Delete from old position
     state->board[oldY][oldX] = NONE;
 
-    // Add move to history
-    addMoveToHistory(state, oldY, oldX, destY, destX, movingPiece);
-
     // Deselect square and piece actions
     state->selectedSquare.x = -1;
     state->selectedSquare.y = -1;
@@ -343,14 +265,15 @@ void makeMove(GameState *state, int destX, int destY) {
         printf("In check!\n");
     }
 
+    // Remember the position for the repetition and fifty-move rules
+    recordPosition(&state->positionHistory, state->board, nextColor, &state->lastDoublePushPawn,
+                   pieceType == PAWN || isStandardCapture);
+    updateGameStatus(state);
+
     // The timestamp and position analysis are now handled in main.c after this function returns.
 }
 
 void deselectPiece(GameState *state) {
-    int oldX = state->selectedSquare.x;
-    int oldY = state->selectedSquare.y;
-
-    state->board[oldY][oldX] &= (~SELECTED_MASK);
     state->selectedSquare.x = -1;
     state->selectedSquare.y = -1;
     state->pieceActions[0] = false;
@@ -382,15 +305,12 @@ void handleMouseInput(GameState *state, int mouseX, int mouseY, int squareSize_l
                 if (state->board[squareY][squareX] != NONE &&
                     !opposingColor(state->board[squareY][squareX], state->blackTurn)) { // Check if it's current player's piece
                     selectAndHold(state, squareX, squareY); // Pass state
-                    generatePossibleMoves(state->board, squareY, squareX, &state->lastDoublePushPawn); // Pass board and lastDoublePawn
                 }
             } else { // A SELECTED PIECE => TRY TO MOVE
-                if ((state->board[squareY][squareX] & MOVABLE_MASK) == MOVABLE_MASK) {
+                if (canMoveTo(state, squareX, squareY)) {
                     makeMove(state, squareX, squareY); // Pass state
-                    clearPossibleBoard(state->board);
                 } else {
                     deselectPiece(state); // Pass state
-                    clearPossibleBoard(state->board);
                 }
             }
         } else if (state->mouseActions[1]) { // MOUSE RELEASED
@@ -398,22 +318,18 @@ void handleMouseInput(GameState *state, int mouseX, int mouseY, int squareSize_l
                 if (squareX == state->selectedSquare.x && squareY == state->selectedSquare.y) {
                     state->pieceActions[1] = false; // Stop holding, but piece remains selected
                 } else {
-                    if ((state->board[squareY][squareX] & MOVABLE_MASK) == MOVABLE_MASK) {
+                    if (canMoveTo(state, squareX, squareY)) {
                         makeMove(state, squareX, squareY); // Pass state
-                        clearPossibleBoard(state->board);
                     } else {
                         deselectPiece(state); // Pass state
-                        clearPossibleBoard(state->board);
                     }
                 }
             } else { // NOT HOLDING (click-click scenario)
                 // If a piece was selected previously and now clicked on a new valid square
-                if (state->pieceActions[0] && (state->board[squareY][squareX] & MOVABLE_MASK) == MOVABLE_MASK) {
+                if (state->pieceActions[0] && canMoveTo(state, squareX, squareY)) {
                     makeMove(state, squareX, squareY); // Pass state
-                    clearPossibleBoard(state->board);
                 } else { // Clicked on empty/invalid square or same selected square
                     deselectPiece(state); // Pass state
-                    clearPossibleBoard(state->board);
                 }
             }
         }
@@ -0,0 +1,80 @@
+// src/FontManager.c
+#include "FontManager.h"
+#include <stdio.h>
+#include <string.h>
+#include "TextCache.h"
+#include "Resources.h"
+
+#define MAX_FALLBACKS 3
+
+typedef struct {
+    FontFamily family;
+    int size;
+    TTF_Font* font;
+} LoadedFont;
+
+static const char* familyFiles[FONT_FAMILY_COUNT][MAX_FALLBACKS] = {
+    [FONT_SANS_BOLD] = {"DejaVuSans-Bold.ttf", "FreeSans.ttf", "LiberationSans-Regular.ttf"},
+    [FONT_SANS] = {"FreeSans.ttf", "LiberationSans-Regular.ttf", "DejaVuSans-Bold.ttf"},
+    [FONT_MONO] = {"JetBrainsMono/JetBrainsMono-Regular.ttf", "FreeSans.ttf", "DejaVuSans-Bold.ttf"},
+};
+
+// Linear lookup: a handful of entries, and most frames ask for the same two or three
+static LoadedFont loadedFonts[MAX_LOADED_FONTS];
+static int loadedCount = 0;
+
+static TTF_Font* openFamily(FontFamily family, int size) {
+    for (int i = 0; i < MAX_FALLBACKS && familyFiles[family][i]; i++) {
+        char name[128];
+        char path[1100];
+        snprintf(name, sizeof(name), FONT_DIRECTORY "%s", familyFiles[family][i]);
+        resourcePath(name, path, sizeof(path));
+        Uint64 start = SDL_GetPerformanceCounter();
+        TTF_Font* font = TTF_OpenFont(path, size);
+        if (font) {
+            snprintf(name + strlen(name), sizeof(name) - strlen(name), " %dpt", size);
+            recordResourceTiming(name, start, true);
+            return font;
+        }
+        printf("Failed to load font %s: %s\n", path, TTF_GetError());
+    }
+    return NULL;
+}
+
+TTF_Font* getFont(FontFamily family, int size) {
+    if ((unsigned)family >= FONT_FAMILY_COUNT) {
+        return NULL;
+    }
+    for (int i = 0; i < loadedCount; i++) {
+        if (loadedFonts[i].family == family && loadedFonts[i].size == size) {
+            return loadedFonts[i].font;
+        }
+    }
+    if (loadedCount == MAX_LOADED_FONTS) {
+        fprintf(stderr, "Error: More than %d fonts requested\n", MAX_LOADED_FONTS);
+        return NULL;
+    }
+
+    // A failed open is remembered too, so a missing family is not retried every frame
+    TTF_Font* font = openFamily(family, size);
+    loadedFonts[loadedCount++] = (LoadedFont){family, size, font};
+    return font;
+}
+
+bool loadFonts(void) {
+    if (!getFont(FONT_SANS_BOLD, UI_FONT_SIZE)) {
+        fprintf(stderr, "Font failed to load, check the path and font file.\n");
+        return false;
+    }
+    getFont(FONT_SANS, SMALL_FONT_SIZE);
+    getFont(FONT_SANS_BOLD, TITLE_FONT_SIZE);
+    return true;
+}
+
+void closeFonts(void) {
+    clearTextCache();
+    for (int i = 0; i < loadedCount; i++) {
+        if (loadedFonts[i].font) TTF_CloseFont(loadedFonts[i].font);
+    }
+    loadedCount = 0;
+}
@@ -0,0 +1,37 @@
+// src/FontManager.h
+#ifndef FONTMANAGER_H
+#define FONTMANAGER_H
+
+#include <stdbool.h>
+#include <SDL2/SDL_ttf.h>
+
+#define FONT_DIRECTORY "fonts/"       // Inside the res directory
+#define MAX_LOADED_FONTS 16          // Distinct (family, size) pairs open at once
+#define PRELOADED_FONT_COUNT 3       // Opened by loadFonts
+
+// Sizes the UI draws with
+#define UI_FONT_SIZE 24              // Sidebars, buttons, status line
+#define SMALL_FONT_SIZE 16           // Evaluation bar value
+#define TITLE_FONT_SIZE 32           // Menu
+
+// Bundled families; each falls back to the next bundled file that opens
+typedef enum {
+    FONT_SANS_BOLD,                  // DejaVu Sans Bold, FreeSans, Liberation Sans
+    FONT_SANS,                       // FreeSans, Liberation Sans, DejaVu Sans Bold
+    FONT_MONO,                       // JetBrains Mono, then the sans families
+    FONT_FAMILY_COUNT
+} FontFamily;
+
+// Open the faces the UI draws with; false when not even the main UI font opens.
+// Call after TTF_Init, so nothing is read from disk once the render loop runs. It may run on
+// a loading thread, as long as nothing else uses the font manager until it returns.
+bool loadFonts(void);
+
+// Shared handle for a family at a point size: opened the first time it is asked for,
+// then the same one every call. NULL when no file of the family opens. Do not close it.
+TTF_Font* getFont(FontFamily family, int size);
+
+// Close every font, dropping the cached text rendered with them first; call before TTF_Quit
+void closeFonts(void);
+
+#endif // FONTMANAGER_H
@@ -1,13 +1,21 @@
 // GameState.c
 #include "GameState.h"
 #include "Piece.h" // Required for placePieces and findKings
+#include "pgn.h"
+#include "Profiler.h"
 #include <string.h> // For strcmp, strcpy, etc. for move history
 #include <stdio.h> // For snprintf, etc.
+#include <stdlib.h>
+#include <time.h>
+
+// The one game's moves, behind every GameState's moveLog
+static MoveLog gameMoveLog;
 
 void initGameState(GameState* state) {
-    // Initialize the board with the standard starting position
-    char startPosition[] = "RNBQKBNR/PPPPPPPP/////pppppppp/rnbqkbnr";
-    placePieces(state->board, startPosition);
+    // Initialize the board with the standard starting position, castling rights included
+    bool blackTurn;
+    loadFEN(START_FEN, state->board, &blackTurn, &state->lastDoublePushPawn);
+    strcpy(state->startFEN, START_FEN);
 
     // Set initial game flags
     state->gameRunning = true;
@@ -23,6 +31,8 @@ void initGameState(GameState* state) {
     // Initialize special chess rule trackers
     findKings(state->board, state->kingsPositions);
     state->lastDoublePushPawn = createVector(-1.0f, -1.0f);
+    resetPositionHistory(&state->positionHistory, state->board, 0, &state->lastDoublePushPawn, 0);
+    updateGameStatus(state);
 
     // Set initial game timers
     state->whiteTimeMs = 5 * 60 * 1000; // 5 minutes in milliseconds
@@ -32,16 +42,207 @@ void initGameState(GameState* state) {
     state->numWhiteCapturedPieces = 0;
     state->numBlackCapturedPieces = 0;
 
-    // --- ADDED: Initialize move history count ---
+    // The log keeps its memory; its old moves are overwritten as new ones are made
+    state->moveLog = &gameMoveLog;
     state->moveCount = 0;
-    // --- END ADDED ---
+}
+
+void updateGameStatus(GameState* state) {
+    beginProfilePhase(PHASE_STATUS);
+    unsigned char color = state->blackTurn ? 1 : 0;
+    generateLegalDestinations(state->board, color, &state->lastDoublePushPawn, state->legalDestinations);
+
+    // The destinations already hold the legal move set; no second generation for the count
+    GameStatus* status = &state->status;
+    status->legalMoveCount = 0;
+    for (int square = 0; square < 64; square++) {
+        status->legalMoveCount += popCount(state->legalDestinations[square]);
+    }
+    status->inCheck = isCheck(state->board, state->kingsPositions[color]);
+    status->checkmate = status->legalMoveCount == 0 && status->inCheck;
+    status->stalemate = status->legalMoveCount == 0 && !status->inCheck;
+    status->drawReason = status->legalMoveCount == 0 ? DRAW_NONE : getDrawReason(state->board, &state->positionHistory);
+    status->gameOver = status->legalMoveCount == 0 || status->drawReason != DRAW_NONE;
+    status->evaluation = evaluatePosition(state->board, color);
+    endProfilePhase(PHASE_STATUS);
+}
+
+Bitboard getSelectedDestinations(const GameState* state) {
+    if (!state->pieceActions[0] || state->selectedSquare.x < 0) {
+        return 0;
+    }
+    return state->legalDestinations[SQUARE((int)state->selectedSquare.y, (int)state->selectedSquare.x)];
 }
 
 void resetGameState(GameState* state) {
     initGameState(state);
 }
 
+// Slot for the move after moveCount, dropping the moves that were only kept for redo; NULL when out of memory
+static Move* appendMove(GameState* state) {
+    MoveLog* log = state->moveLog;
+    if (state->moveCount == log->capacity) {
+        int capacity = log->capacity ? log->capacity * 2 : 256;
+        Move* moves = realloc(log->moves, capacity * sizeof(Move));
+        if (!moves) {
+            fprintf(stderr, "Error: Out of memory recording move %d\n", state->moveCount + 1);
+            return NULL;
+        }
+        log->moves = moves;
+        log->capacity = capacity;
+    }
+    log->count = state->moveCount + 1;
+    return &log->moves[state->moveCount++];
+}
+
+void addMoveToHistory(GameState* state, EngineMove move) {
+    unsigned char color = state->blackTurn ? 1 : 0;
+    Move* slot = appendMove(state);
+    if (slot) {
+        moveToSAN(state->board, move, color, &state->lastDoublePushPawn, state->kingsPositions, slot->notation);
+    }
+}
+
+const char* getMoveNotation(const GameState* state, int index) {
+    return state->moveLog->moves[index].notation;
+}
+
+void freeMoveLog(GameState* state) {
+    MoveLog* log = state->moveLog;
+    free(log->moves);
+    log->moves = NULL;
+    log->count = 0;
+    log->capacity = 0;
+    state->moveCount = 0;
+}
+
+// "1-0", "0-1", "1/2-1/2", or "*" while the game goes on
+static const char* gameResult(GameState* state) {
+    if (state->status.checkmate) {
+        return state->blackTurn ? "1-0" : "0-1";
+    }
+    return state->status.gameOver ? "1/2-1/2" : "*";
+}
+
+// Turn the SAN move list back into moves from startFEN; false when it doesn't replay
+static bool replayMoveHistory(GameState* state, PgnGame* game) {
+    unsigned char board[8][8];
+    bool blackTurn;
+    Vector2f lastDoublePawn;
+    Vector2f kings[2];
+    if (!loadFEN(state->startFEN, board, &blackTurn, &lastDoublePawn)) {
+        return false;
+    }
+    findKings(board, kings);
+
+    unsigned char color = blackTurn ? 1 : 0;
+    game->plyCount = 0;
+    for (int i = 0; i < state->moveCount && i < PGN_MAX_PLIES; i++) {
+        EngineMove move;
+        if (!parseSAN(board, color, &lastDoublePawn, getMoveNotation(state, i), &move)) {
+            return false;
+        }
+        game->moves[game->plyCount++] = move;
+        engineMakeMove(board, move, &lastDoublePawn, kings, 0);
+        color ^= 1;
+    }
+    return memcmp(board, state->board, sizeof(board)) == 0;
+}
+
+static bool saveGameAsPgn(GameState* state, const char* filePath) {
+    PgnGame* game = malloc(sizeof(PgnGame));
+    if (!game) {
+        fprintf(stderr, "Error: Out of memory saving %s\n", filePath);
+        return false;
+    }
+    initPgnTags(&game->tags);
+    strcpy(game->tags.event, "Casual game");
+    time_t now = time(NULL);
+    strftime(game->tags.date, sizeof(game->tags.date), "%Y.%m.%d", localtime(&now));
+    strcpy(game->tags.result, gameResult(state));
+
+    if (replayMoveHistory(state, game)) {
+        if (strcmp(state->startFEN, START_FEN) != 0) {
+            strcpy(game->tags.fen, state->startFEN);
+        }
+    } else {
+        // Saves from before SAN notation: keep the position, without the moves
+        printf("Move list doesn't replay; saving the current position only\n");
+        writeFEN(state->board, state->blackTurn, &state->lastDoublePushPawn, state->positionHistory.halfmoveClock,
+                 state->moveCount / 2 + 1, game->tags.fen);
+        game->plyCount = 0;
+    }
+
+    FILE* file = fopen(filePath, "w");
+    bool saved = file && writePgnGame(file, game);
+    if (file && fclose(file) != 0) saved = false;
+    if (!saved) {
+        fprintf(stderr, "Error: Could not write %s\n", filePath);
+    }
+    free(game);
+    return saved;
+}
+
+// Play the first game of a PGN file from its starting position
+static bool loadGameFromPgn(GameState* state, const char* filePath) {
+    PgnReader* reader = malloc(sizeof(PgnReader));
+    PgnGame* game = malloc(sizeof(PgnGame));
+    bool loaded = reader && game && openPgnReader(reader, filePath) && readPgnGame(reader, game) == PGN_GAME_READ;
+    if (reader) closePgnReader(reader);
+    free(reader);
+    if (!loaded) {
+        fprintf(stderr, "Error: No game could be read from %s\n", filePath);
+        free(game);
+        return false;
+    }
+
+    resetGameState(state);
+    if (game->tags.fen[0]) {
+        bool blackTurn;
+        loadFEN(game->tags.fen, state->board, &blackTurn, &state->lastDoublePushPawn);
+        state->blackTurn = blackTurn;
+        findKings(state->board, state->kingsPositions);
+        snprintf(state->startFEN, sizeof(state->startFEN), "%s", game->tags.fen);
+    }
+    resetPositionHistory(&state->positionHistory, state->board, state->blackTurn ? 1 : 0, &state->lastDoublePushPawn, 0);
+
+    for (int i = 0; i < game->plyCount; i++) {
+        EngineMove move = game->moves[i];
+        unsigned char color = state->blackTurn ? 1 : 0;
+        bool irreversible = move.capturedPiece != NONE ||
+                            (state->board[move.from.x][move.from.y] & TYPE_MASK) == PAWN;
+        addMoveToHistory(state, move);
+        if (move.capturedPiece != NONE) {
+            if (color == 0 && state->numWhiteCapturedPieces < MAX_CAPTURED) {
+                state->whiteCapturedPieces[state->numWhiteCapturedPieces++] = move.capturedPiece & TYPE_MASK;
+            } else if (color == 1 && state->numBlackCapturedPieces < MAX_CAPTURED) {
+                state->blackCapturedPieces[state->numBlackCapturedPieces++] = move.capturedPiece & TYPE_MASK;
+            }
+        }
+        engineMakeMove(state->board, move, &state->lastDoublePushPawn, state->kingsPositions, 0);
+        state->blackTurn = !state->blackTurn;
+        recordPosition(&state->positionHistory, state->board, color ^ 1, &state->lastDoublePushPawn, irreversible);
+    }
+    updateGameStatus(state);
+    free(game);
+
+    printf("Game loaded from %s\n", filePath);
+    return true;
+}
+
+static bool isPgnPath(const char* filePath) {
+    size_t len = strlen(filePath);
+    return len >= 4 && SDL_strcasecmp(filePath + len - 4, ".pgn") == 0;
+}
+
 void saveGameToFile(GameState* state, const char* filePath) {
+    if (isPgnPath(filePath)) {
+        if (saveGameAsPgn(state, filePath)) {
+            printf("Game saved to %s\n", filePath);
+        }
+        return;
+    }
+
     FILE* file = fopen(filePath, "w");
     if (!file) {
         fprintf(stderr, "Error: Could not open file %s for writing\n", filePath);
@@ -72,11 +273,13 @@ void saveGameToFile(GameState* state, const char* filePath) {
     fprintf(file, "WHITE_KING_Y:%d\n", state->kingsPositions[0].y);
     fprintf(file, "BLACK_KING_X:%d\n", state->kingsPositions[1].x);
     fprintf(file, "BLACK_KING_Y:%d\n", state->kingsPositions[1].y);
+    fprintf(file, "HALFMOVE_CLOCK:%d\n", state->positionHistory.halfmoveClock);
+    fprintf(file, "START_FEN:%s\n", state->startFEN);
     
     // Save move history
     fprintf(file, "MOVE_COUNT:%d\n", state->moveCount);
     for (int i = 0; i < state->moveCount; i++) {
-        fprintf(file, "MOVE_%d:%s\n", i, state->moveHistory[i].notation);
+        fprintf(file, "MOVE_%d:%s\n", i, getMoveNotation(state, i));
     }
     
     // Save captured pieces
@@ -111,12 +314,21 @@ void loadGameFromFile(GameState* state, const char* filePath) {
         fprintf(stderr, "Error: Could not open file %s for reading\n", filePath);
         return;
     }
+
+    // Saves in this format start with the board; anything else is read as PGN
+    char line[256];
+    if (!fgets(line, sizeof(line), file) || strncmp(line, "BOARD:", 6) != 0) {
+        fclose(file);
+        loadGameFromPgn(state, filePath);
+        return;
+    }
+    rewind(file);
     
     // Reset the game state before loading
     resetGameState(state);
     
-    char line[256];
     float tempFloatX, tempFloatY;
+    int halfmoveClock = 0;
     char tempBuffer[256]; // Buffer for string values
     
     while (fgets(line, sizeof(line), file)) {
@@ -134,7 +346,7 @@ void loadGameFromFile(GameState* state, const char* filePath) {
             
             char* token = strtok(boardData, ",");
             while (token != NULL && row < 8) {
-                state->board[row][col] = (unsigned char)atoi(token);
+                state->board[row][col] = (unsigned char)atoi(token) & PIECE_MASK; // Older saves carried highlight bits
                 
                 col++;
                 if (col >= 8) {
@@ -178,20 +390,21 @@ void loadGameFromFile(GameState* state, const char* filePath) {
         else if (sscanf(line, "BLACK_KING_Y:%f", &tempFloatY) == 1) {
             state->kingsPositions[1].y = (int)tempFloatY;
         }
+        else if (sscanf(line, "HALFMOVE_CLOCK:%d", &halfmoveClock) == 1) {
+            // Halfmove clock already parsed
+        }
         // Handle move history
-        else if (sscanf(line, "MOVE_COUNT:%d", &state->moveCount) == 1) {
-            // Ensure move count is within bounds
-            if (state->moveCount > MAX_MOVES) {
-                state->moveCount = MAX_MOVES;
-                printf("Warning: Move count exceeds maximum, truncating to %d\n", MAX_MOVES);
-            }
+        else if (strncmp(line, "START_FEN:", 10) == 0) {
+            snprintf(state->startFEN, sizeof(state->startFEN), "%s", line + 10);
+        }
+        else if (strncmp(line, "MOVE_COUNT:", 11) == 0) {
+            // The MOVE_n lines that follow are counted as they are read
         }
         else if (sscanf(line, "MOVE_%*d:%255[^\n]", tempBuffer) == 1) {
-            // Only add the move if we haven't reached the maximum
-            if (state->moveCount < MAX_MOVES) {
-                strncpy(state->moveHistory[state->moveCount].notation, tempBuffer, 255);
-                state->moveHistory[state->moveCount].notation[255] = '\0'; // Ensure null termination
-                state->moveCount++;
+            Move* move = appendMove(state);
+            if (move) {
+                strncpy(move->notation, tempBuffer, sizeof(move->notation) - 1);
+                move->notation[sizeof(move->notation) - 1] = '\0'; // Ensure null termination
             }
         }
         // Handle captured pieces
@@ -251,6 +464,11 @@ void loadGameFromFile(GameState* state, const char* filePath) {
         state->kingsPositions[1].y = 4;
         printf("Black king position was invalid, reset to default\n");
     }
+
+    // Earlier positions aren't saved, so repetitions are counted from the loaded position
+    resetPositionHistory(&state->positionHistory, state->board, state->blackTurn ? 1 : 0,
+                         &state->lastDoublePushPawn, halfmoveClock);
+    updateGameStatus(state);
     
     printf("Game loaded from %s\n", filePath);
 }
\ No newline at end of file
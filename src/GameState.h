@@ -6,7 +6,28 @@
 #include <SDL2/SDL.h>
 #include "util.h"     // For Vector2f structure
 #include "Piece.h"    // Required for MAX_CAPTURED
-#include "app_globals.h" // Includes MAX_MOVES, MAX_HISTORY_STATES, and Move struct
+#include "app_globals.h" // Includes the Move struct
+#include "engine.h"   // For PositionHistory
+
+// What the UI shows about the position, worked out once each time it changes
+typedef struct {
+    int legalMoveCount;          // A promotion counts once, not once per piece
+    int evaluation;              // evaluatePosition, from white's point of view
+    DrawReason drawReason;       // Draw by rule; DRAW_NONE when there are no legal moves
+    bool inCheck;
+    bool checkmate;
+    bool stalemate;
+    bool gameOver;               // Mate, stalemate or a draw by rule
+} GameStatus;
+
+// Every move of the game, in SAN. All copies of a GameState (undo keyframes included) share
+// one log and show its first moveCount moves; moves past that are kept for redo until a new
+// move replaces them. Grows without limit.
+typedef struct {
+    Move* moves;
+    int count;
+    int capacity;
+} MoveLog;
 
 typedef struct {
     // Board state
@@ -24,6 +45,9 @@ typedef struct {
     // Special chess rule tracking
     Vector2f kingsPositions[2]; // Index 0 for white king, 1 for black king
     Vector2f lastDoublePushPawn; // Tracks the pawn that made a double push for en passant
+    PositionHistory positionHistory; // Position hashes and halfmove clock for the draw rules
+    Bitboard legalDestinations[64]; // Where each piece of the side to move can go, by square (row * 8 + col)
+    GameStatus status;              // Refreshed together with legalDestinations
 
     // Game timers
     int whiteTimeMs;
@@ -36,25 +60,40 @@ typedef struct {
     unsigned char blackCapturedPieces[MAX_CAPTURED];
     int numBlackCapturedPieces;
 
-    // --- RE-ADDED: Move History as part of GameState ---
-    Move moveHistory[MAX_MOVES]; // Array to store move notations
-    int moveCount;               // Number of moves currently in history
-    // --- END RE-ADDED ---
+    // Move history
+    MoveLog* moveLog;            // Shared; see MoveLog
+    int moveCount;               // Moves of the log played to reach this state
+    char startFEN[FEN_LENGTH];   // Position the move log starts from
 
-} GameState;
 
-// External declarations for history management globals (defined in main.c)
-extern GameState historyStates[MAX_HISTORY_STATES];
-extern int historyCount;
-extern int currentHistoryIdx;
+} GameState;
 
 // Function Prototypes for Undo/Redo operations (implemented in main.c)
 void recordGameState(GameState* state);
+void resetGameHistory(GameState* state); // Start a new history at the state, e.g. after loading
 void undoGame(GameState* state);
 void redoGame(GameState* state);
 
 void initGameState(GameState* state);
+
+// Refresh legalDestinations and status; call after every change to the position,
+// once positionHistory has been brought up to date
+void updateGameStatus(GameState* state);
+
+// Squares the selected piece can move to (empty when nothing is selected)
+Bitboard getSelectedDestinations(const GameState* state);
 void resetGameState(GameState* state);
+
+// Append the move, in SAN, to the move log; call before the move is made on the board
+void addMoveToHistory(GameState* state, EngineMove move);
+
+// SAN of move 'index' (from 0) of the game leading to this state
+const char* getMoveNotation(const GameState* state, int index);
+
+// Release the move log; every state sharing it is left without moves
+void freeMoveLog(GameState* state);
+
+// Files ending in .pgn are written as PGN; loading tells the two formats apart by their content
 void saveGameToFile(GameState* state, const char* filePath);
 void loadGameFromFile(GameState* state, const char* filePath);
 
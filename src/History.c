@@ -0,0 +1,234 @@
+// src/History.c
+#include "History.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+void initGameHistory(GameHistory* history) {
+    memset(history, 0, sizeof(*history));
+    history->current = -1;
+}
+
+// Drop entries from 'count' on, with the keyframes only they use
+static void truncateHistory(GameHistory* history, int count) {
+    int keyframeCount = 0;
+    for (int i = count - 1; i >= 0; i--) {
+        if (history->entries[i].keyframe >= 0) {
+            keyframeCount = history->entries[i].keyframe + 1;
+            break;
+        }
+    }
+    for (int i = keyframeCount; i < history->keyframeCount; i++) {
+        free(history->keyframes[i]);
+    }
+    history->keyframeCount = keyframeCount;
+    history->count = count;
+}
+
+void clearGameHistory(GameHistory* history) {
+    truncateHistory(history, 0);
+    history->current = -1;
+}
+
+void freeGameHistory(GameHistory* history) {
+    clearGameHistory(history);
+    free(history->entries);
+    free(history->keyframes);
+    initGameHistory(history);
+}
+
+// Mouse and selection state belongs to the moment, not the position
+static void clearInteraction(GameState* state) {
+    state->mouseActions[0] = false;
+    state->mouseActions[1] = false;
+    state->pieceActions[0] = false;
+    state->pieceActions[1] = false;
+    state->selectedSquare = createVector(-1, -1);
+}
+
+// Replay a delta on the state before it; legalDestinations and status are left for the caller to refresh
+static void applyDelta(GameState* state, const HistoryEntry* entry) {
+    for (int i = 0; i < entry->squareCount; i++) {
+        state->board[entry->squares[i] >> 3][entry->squares[i] & 7] = entry->pieces[i];
+    }
+    state->blackTurn = entry->blackTurn;
+    for (int color = 0; color < 2; color++) {
+        state->kingsPositions[color] = createVector(entry->kings[color][0], entry->kings[color][1]);
+    }
+    state->lastDoublePushPawn = createVector(entry->lastDoublePushPawn[0], entry->lastDoublePushPawn[1]);
+
+    if (entry->whiteCaptured != NONE) {
+        state->whiteCapturedPieces[state->numWhiteCapturedPieces++] = entry->whiteCaptured;
+    }
+    if (entry->blackCaptured != NONE) {
+        state->blackCapturedPieces[state->numBlackCapturedPieces++] = entry->blackCaptured;
+    }
+    if (entry->moveAdded) {
+        state->moveCount++;
+    }
+    if (entry->positionRecorded) {
+        recordPosition(&state->positionHistory, state->board, state->blackTurn ? 1 : 0, &state->lastDoublePushPawn,
+                       entry->irreversible);
+    }
+    state->whiteTimeMs = entry->whiteTimeMs;
+    state->blackTimeMs = entry->blackTimeMs;
+}
+
+static bool fitsInByte(int value) {
+    return value >= -128 && value <= 127;
+}
+
+// Describe next as a change to prev; false when a delta can't express it exactly
+static bool buildDelta(const GameState* prev, const GameState* next, HistoryEntry* entry) {
+    memset(entry, 0, sizeof(*entry));
+    entry->keyframe = -1;
+
+    for (int square = 0; square < 64; square++) {
+        unsigned char piece = next->board[square >> 3][square & 7];
+        if (piece != prev->board[square >> 3][square & 7]) {
+            if (entry->squareCount == HISTORY_DELTA_SQUARES) return false;
+            entry->squares[entry->squareCount] = (unsigned char)square;
+            entry->pieces[entry->squareCount++] = piece;
+        }
+    }
+
+    entry->blackTurn = next->blackTurn;
+    for (int color = 0; color < 2; color++) {
+        if (!fitsInByte(next->kingsPositions[color].x) || !fitsInByte(next->kingsPositions[color].y)) return false;
+        entry->kings[color][0] = (signed char)next->kingsPositions[color].x;
+        entry->kings[color][1] = (signed char)next->kingsPositions[color].y;
+    }
+    if (!fitsInByte(next->lastDoublePushPawn.x) || !fitsInByte(next->lastDoublePushPawn.y)) return false;
+    entry->lastDoublePushPawn[0] = (signed char)next->lastDoublePushPawn.x;
+    entry->lastDoublePushPawn[1] = (signed char)next->lastDoublePushPawn.y;
+
+    // Lists only ever grow by one per move
+    if (next->numWhiteCapturedPieces == prev->numWhiteCapturedPieces + 1) {
+        entry->whiteCaptured = next->whiteCapturedPieces[prev->numWhiteCapturedPieces];
+    } else if (next->numWhiteCapturedPieces != prev->numWhiteCapturedPieces) {
+        return false;
+    }
+    if (next->numBlackCapturedPieces == prev->numBlackCapturedPieces + 1) {
+        entry->blackCaptured = next->blackCapturedPieces[prev->numBlackCapturedPieces];
+    } else if (next->numBlackCapturedPieces != prev->numBlackCapturedPieces) {
+        return false;
+    }
+    if (next->moveCount == prev->moveCount + 1) {
+        entry->moveAdded = true;
+    } else if (next->moveCount != prev->moveCount) {
+        return false;
+    }
+
+    entry->positionRecorded = memcmp(&prev->positionHistory, &next->positionHistory, sizeof(PositionHistory)) != 0;
+    entry->irreversible = next->positionHistory.halfmoveClock == 0;
+    entry->whiteTimeMs = next->whiteTimeMs;
+    entry->blackTimeMs = next->blackTimeMs;
+
+    // The delta must reproduce the state byte for byte; anything else it changed
+    // (a loaded game, a field added later) gets a keyframe instead
+    GameState* replayed = malloc(sizeof(GameState));
+    if (!replayed) return false;
+    *replayed = *prev;
+    applyDelta(replayed, entry);
+    updateGameStatus(replayed);
+    bool exact = memcmp(replayed, next, sizeof(GameState)) == 0;
+    free(replayed);
+    return exact;
+}
+
+// Only the clocks moved (a click that didn't make a move)
+static bool isSamePosition(const GameState* prev, const HistoryEntry* entry) {
+    return entry->squareCount == 0 && entry->blackTurn == prev->blackTurn && !entry->moveAdded &&
+           !entry->positionRecorded && entry->whiteCaptured == NONE && entry->blackCaptured == NONE &&
+           entry->lastDoublePushPawn[0] == prev->lastDoublePushPawn.x &&
+           entry->lastDoublePushPawn[1] == prev->lastDoublePushPawn.y;
+}
+
+static int keyframeEntryBefore(const GameHistory* history, int index) {
+    while (history->entries[index].keyframe < 0) {
+        index--;
+    }
+    return index;
+}
+
+bool recordHistory(GameHistory* history, const GameState* state) {
+    GameState* next = malloc(sizeof(GameState));
+    if (!next) {
+        fprintf(stderr, "Error: Out of memory recording history\n");
+        return false;
+    }
+    *next = *state;
+    clearInteraction(next);
+
+    HistoryEntry entry;
+    bool isDelta = history->current >= 0 && buildDelta(&history->currentState, next, &entry);
+    if (isDelta && isSamePosition(&history->currentState, &entry)) {
+        free(next);
+        return false;
+    }
+
+    int index = history->current + 1;
+    truncateHistory(history, index);
+    if (isDelta && index - keyframeEntryBefore(history, history->current) >= HISTORY_KEYFRAME_INTERVAL) {
+        isDelta = false;
+    }
+
+    // Make room
+    if (history->count == history->capacity) {
+        int capacity = history->capacity ? history->capacity * 2 : 256;
+        HistoryEntry* entries = realloc(history->entries, capacity * sizeof(HistoryEntry));
+        if (!entries) {
+            fprintf(stderr, "Error: Out of memory recording history\n");
+            free(next);
+            return false;
+        }
+        history->entries = entries;
+        history->capacity = capacity;
+    }
+    if (!isDelta && history->keyframeCount == history->keyframeCapacity) {
+        int capacity = history->keyframeCapacity ? history->keyframeCapacity * 2 : 16;
+        GameState** keyframes = realloc(history->keyframes, capacity * sizeof(GameState*));
+        if (!keyframes) {
+            fprintf(stderr, "Error: Out of memory recording history\n");
+            free(next);
+            return false;
+        }
+        history->keyframes = keyframes;
+        history->keyframeCapacity = capacity;
+    }
+
+    if (isDelta) {
+        history->currentState = *next;
+        free(next);
+    } else {
+        memset(&entry, 0, sizeof(entry));
+        entry.keyframe = history->keyframeCount;
+        history->keyframes[history->keyframeCount++] = next;
+        history->currentState = *next;
+    }
+    history->entries[history->count++] = entry;
+    history->current = index;
+    return true;
+}
+
+bool gotoHistoryEntry(GameHistory* history, GameState* state, int index) {
+    if (index < 0 || index >= history->count) {
+        return false;
+    }
+
+    // Replay from the keyframe before the entry, or from where we are when that is closer
+    int start = keyframeEntryBefore(history, index);
+    if (history->current >= start && history->current <= index) {
+        start = history->current;
+    } else {
+        history->currentState = *history->keyframes[history->entries[start].keyframe];
+    }
+    for (int i = start + 1; i <= index; i++) {
+        applyDelta(&history->currentState, &history->entries[i]);
+    }
+    updateGameStatus(&history->currentState);
+
+    history->current = index;
+    *state = history->currentState;
+    return true;
+}
@@ -0,0 +1,60 @@
+// src/History.h
+#ifndef HISTORY_H
+#define HISTORY_H
+
+#include <stdbool.h>
+#include "GameState.h"
+
+#define HISTORY_KEYFRAME_INTERVAL 64 // Most deltas replayed to reach any entry
+#define HISTORY_DELTA_SQUARES 4      // Squares a move can change (castling moves two pieces)
+
+// One recorded state: either a full keyframe or what changed since the previous entry
+typedef struct {
+    int keyframe;                    // Index into GameHistory.keyframes, or -1 for a delta
+
+    // Delta: squares that changed and their new contents (row * 8 + col)
+    unsigned char squareCount;
+    unsigned char squares[HISTORY_DELTA_SQUARES];
+    unsigned char pieces[HISTORY_DELTA_SQUARES];
+
+    bool blackTurn;
+    signed char kings[2][2];         // kingsPositions after the move
+    signed char lastDoublePushPawn[2];
+    unsigned char whiteCaptured;     // Piece added to each captured list, or NONE
+    unsigned char blackCaptured;
+    bool moveAdded;                  // One more move of the shared move log is played
+    bool positionRecorded;           // recordPosition was called for the new position
+    bool irreversible;
+    int whiteTimeMs;
+    int blackTimeMs;
+} HistoryEntry;
+
+// Undo/redo log. Memory grows by one small entry per ply plus a keyframe every
+// HISTORY_KEYFRAME_INTERVAL plies; any entry is reached from the keyframe before it.
+typedef struct {
+    HistoryEntry* entries;
+    int count;
+    int capacity;
+    int current;                     // Entry the game is at, -1 when empty
+
+    GameState** keyframes;
+    int keyframeCount;
+    int keyframeCapacity;
+
+    GameState currentState;          // The state at 'current', to diff the next one against
+} GameHistory;
+
+void initGameHistory(GameHistory* history);
+void freeGameHistory(GameHistory* history);
+
+// Forget everything, e.g. before recording a loaded game
+void clearGameHistory(GameHistory* history);
+
+// Record the state as the entry after 'current', dropping any redo entries.
+// Returns false when the position hasn't changed since the current entry.
+bool recordHistory(GameHistory* history, const GameState* state);
+
+// Restore entry 'index' into state; returns false when it doesn't exist
+bool gotoHistoryEntry(GameHistory* history, GameState* state, int index);
+
+#endif // HISTORY_H
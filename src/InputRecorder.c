@@ -0,0 +1,326 @@
+// src/InputRecorder.c
+#include "InputRecorder.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "util.h"
+
+typedef struct {
+    int tick;
+    SDL_Event event;
+} LoggedEvent;
+
+typedef struct {
+    int tick;
+    int x, y;
+    Uint32 buttons;
+} LoggedMouse;
+
+typedef struct {
+    int tick;
+    EngineMove move;
+} LoggedMove;
+
+static InputMode mode = INPUT_LIVE;
+static int tick = 0;
+static Uint64 clockOrigin = 0;
+static double tickClockMs = 0.0;
+static bool quitSent = false;
+
+// The mouse state of the current tick
+static LoggedMouse mouse = {0, -1, -1, 0};
+static bool mouseSampled = false;
+
+// Recording
+static FILE* recording = NULL;
+
+// Replay, read in whole at the start; each kind is consumed in order
+static double* clocks = NULL;
+static int clockCount = 0, clockCapacity = 0;
+static LoggedEvent* events = NULL;
+static int eventCount = 0, eventCapacity = 0, nextEvent = 0;
+static LoggedMouse* mouseStates = NULL;
+static int mouseCount = 0, mouseCapacity = 0, nextMouse = 0;
+static LoggedMove* moves = NULL;
+static int moveCount = 0, moveCapacity = 0, nextMove = 0;
+static bool replayFinished = false;
+
+// Room for one more element; false when out of memory
+static bool reserve(void** array, int count, int* capacity, size_t size) {
+    if (count < *capacity) {
+        return true;
+    }
+    int grown = *capacity ? *capacity * 2 : 256;
+    void* resized = realloc(*array, grown * size);
+    if (!resized) {
+        fprintf(stderr, "Error: Out of memory reading the input recording\n");
+        return false;
+    }
+    *array = resized;
+    *capacity = grown;
+    return true;
+}
+
+static void writeEvent(const SDL_Event* event) {
+    int a = 0, b = 0, c = 0;
+    switch (event->type) {
+        case SDL_QUIT:
+        case SDL_RENDER_TARGETS_RESET:
+            break;
+        case SDL_KEYDOWN:
+            a = event->key.keysym.sym;
+            break;
+        case SDL_MOUSEBUTTONDOWN:
+        case SDL_MOUSEBUTTONUP:
+            a = event->button.button;
+            b = event->button.x;
+            c = event->button.y;
+            break;
+        case SDL_MOUSEWHEEL:
+            a = event->wheel.x;
+            b = event->wheel.y;
+            break;
+        case SDL_WINDOWEVENT:
+            a = event->window.event;
+            break;
+        case SDL_TEXTINPUT:
+            fprintf(recording, "E %d %u 0 0 0 %s\n", tick, event->type, event->text.text);
+            return;
+        default:
+            // Nothing the game reacts to
+            return;
+    }
+    fprintf(recording, "E %d %u %d %d %d\n", tick, event->type, a, b, c);
+}
+
+static SDL_Event readEvent(Uint32 type, int a, int b, int c, const char* text) {
+    SDL_Event event;
+    memset(&event, 0, sizeof(event));
+    event.type = type;
+    switch (type) {
+        case SDL_KEYDOWN:
+            event.key.keysym.sym = a;
+            break;
+        case SDL_MOUSEBUTTONDOWN:
+        case SDL_MOUSEBUTTONUP:
+            event.button.button = a;
+            event.button.x = b;
+            event.button.y = c;
+            break;
+        case SDL_MOUSEWHEEL:
+            event.wheel.x = a;
+            event.wheel.y = b;
+            break;
+        case SDL_WINDOWEVENT:
+            event.window.event = a;
+            break;
+        case SDL_TEXTINPUT:
+            snprintf(event.text.text, sizeof(event.text.text), "%s", text);
+            break;
+    }
+    return event;
+}
+
+bool startInputRecording(const char* path) {
+    recording = fopen(path, "w");
+    if (!recording) {
+        fprintf(stderr, "Error: Could not open file %s for writing\n", path);
+        return false;
+    }
+    fprintf(recording, "%s\n", INPUT_RECORDING_HEADER);
+    mode = INPUT_RECORDING;
+    clockOrigin = SDL_GetPerformanceCounter();
+    printf("Recording input to %s\n", path);
+    return true;
+}
+
+static bool readRecordingLine(const char* line) {
+    int lineTick, consumed = 0;
+    if (line[0] == 'T') {
+        double clockMs;
+        if (sscanf(line, "T %d %lf", &lineTick, &clockMs) != 2 || lineTick != clockCount + 1) return false;
+        if (!reserve((void**)&clocks, clockCount, &clockCapacity, sizeof(double))) return false;
+        clocks[clockCount++] = clockMs;
+    } else if (line[0] == 'E') {
+        unsigned type;
+        int a, b, c;
+        if (sscanf(line, "E %d %u %d %d %d%n", &lineTick, &type, &a, &b, &c, &consumed) != 5) return false;
+        if (!reserve((void**)&events, eventCount, &eventCapacity, sizeof(LoggedEvent))) return false;
+        const char* text = line[consumed] == ' ' ? line + consumed + 1 : "";
+        events[eventCount++] = (LoggedEvent){lineTick, readEvent(type, a, b, c, text)};
+    } else if (line[0] == 'P') {
+        LoggedMouse state;
+        if (sscanf(line, "P %d %d %d %u", &state.tick, &state.x, &state.y, &state.buttons) != 4) return false;
+        if (!reserve((void**)&mouseStates, mouseCount, &mouseCapacity, sizeof(LoggedMouse))) return false;
+        mouseStates[mouseCount++] = state;
+    } else if (line[0] == 'M') {
+        int from[2], to[2], captured, isPromotion, promotionPiece, modifier;
+        if (sscanf(line, "M %d %d %d %d %d %d %d %d %d", &lineTick, &from[0], &from[1], &to[0], &to[1],
+                   &captured, &isPromotion, &promotionPiece, &modifier) != 9) return false;
+        if (!reserve((void**)&moves, moveCount, &moveCapacity, sizeof(LoggedMove))) return false;
+        EngineMove move = {0};
+        move.from = createVector(from[0], from[1]);
+        move.to = createVector(to[0], to[1]);
+        move.capturedPiece = captured;
+        move.isPromotion = isPromotion;
+        move.promotionPiece = promotionPiece;
+        move.originalModifier = modifier;
+        moves[moveCount++] = (LoggedMove){lineTick, move};
+    } else if (line[0] != '#' && line[0] != '\0') {
+        return false;
+    }
+    return true;
+}
+
+bool startInputReplay(const char* path) {
+    FILE* file = fopen(path, "r");
+    if (!file) {
+        fprintf(stderr, "Error: Could not open file %s for reading\n", path);
+        return false;
+    }
+
+    char line[256];
+    int lineNumber = 0;
+    bool valid = fgets(line, sizeof(line), file) && strncmp(line, INPUT_RECORDING_HEADER, strlen(INPUT_RECORDING_HEADER)) == 0;
+    if (!valid) {
+        fprintf(stderr, "Error: %s is not an input recording\n", path);
+    }
+    while (valid && fgets(line, sizeof(line), file)) {
+        lineNumber++;
+        line[strcspn(line, "\r\n")] = '\0';
+        if (!readRecordingLine(line)) {
+            fprintf(stderr, "Error: Invalid line %d in %s: %s\n", lineNumber + 1, path, line);
+            valid = false;
+        }
+    }
+    fclose(file);
+    if (!valid) {
+        stopInput();
+        return false;
+    }
+
+    mode = INPUT_REPLAYING;
+    printf("Replaying %s: %d ticks, %d events, %d computer moves\n", path, clockCount, eventCount, moveCount);
+    return true;
+}
+
+void stopInput(void) {
+    if (recording) {
+        fclose(recording);
+        recording = NULL;
+    }
+    free(clocks);
+    free(events);
+    free(mouseStates);
+    free(moves);
+    clocks = NULL;
+    events = NULL;
+    mouseStates = NULL;
+    moves = NULL;
+    clockCount = clockCapacity = 0;
+    eventCount = eventCapacity = nextEvent = 0;
+    mouseCount = mouseCapacity = nextMouse = 0;
+    moveCount = moveCapacity = nextMove = 0;
+    mode = INPUT_LIVE;
+}
+
+InputMode getInputMode(void) {
+    return mode;
+}
+
+int beginInputTick(void) {
+    tick++;
+    mouseSampled = false;
+    quitSent = false;
+
+    if (mode == INPUT_REPLAYING) {
+        if (tick > clockCount) {
+            replayFinished = true;
+        } else {
+            tickClockMs = clocks[tick - 1];
+        }
+        return tick;
+    }
+
+    if (clockOrigin == 0) {
+        clockOrigin = SDL_GetPerformanceCounter();
+    }
+    tickClockMs = 1000.0 * (SDL_GetPerformanceCounter() - clockOrigin) / SDL_GetPerformanceFrequency();
+    if (mode == INPUT_RECORDING) {
+        fprintf(recording, "T %d %.3f\n", tick, tickClockMs);
+    }
+    return tick;
+}
+
+int getInputTick(void) {
+    return tick;
+}
+
+double getInputClockMs(void) {
+    return tickClockMs;
+}
+
+bool pollInputEvent(SDL_Event* event) {
+    if (mode != INPUT_REPLAYING) {
+        if (!SDL_PollEvent(event)) {
+            return false;
+        }
+        if (mode == INPUT_RECORDING) {
+            writeEvent(event);
+        }
+        return true;
+    }
+
+    if (nextEvent < eventCount && events[nextEvent].tick <= tick) {
+        *event = events[nextEvent++].event;
+        return true;
+    }
+    if (replayFinished && !quitSent) {
+        memset(event, 0, sizeof(*event));
+        event->type = SDL_QUIT;
+        quitSent = true;
+        return true;
+    }
+    return false;
+}
+
+Uint32 getInputMouseState(int* x, int* y) {
+    if (mode == INPUT_LIVE) {
+        return SDL_GetMouseState(x, y);
+    }
+
+    if (mode == INPUT_REPLAYING) {
+        while (nextMouse < mouseCount && mouseStates[nextMouse].tick <= tick) {
+            mouse = mouseStates[nextMouse++];
+        }
+    } else if (!mouseSampled) {
+        LoggedMouse sampled = {tick, 0, 0, 0};
+        sampled.buttons = SDL_GetMouseState(&sampled.x, &sampled.y);
+        if (sampled.x != mouse.x || sampled.y != mouse.y || sampled.buttons != mouse.buttons) {
+            fprintf(recording, "P %d %d %d %u\n", tick, sampled.x, sampled.y, sampled.buttons);
+        }
+        mouse = sampled;
+        mouseSampled = true;
+    }
+
+    if (x) *x = mouse.x;
+    if (y) *y = mouse.y;
+    return mouse.buttons;
+}
+
+void recordComputerMove(const EngineMove* move) {
+    if (mode != INPUT_RECORDING) {
+        return;
+    }
+    fprintf(recording, "M %d %d %d %d %d %d %d %d %d\n", tick, (int)move->from.x, (int)move->from.y,
+            (int)move->to.x, (int)move->to.y, move->capturedPiece, move->isPromotion,
+            move->promotionPiece, move->originalModifier);
+}
+
+bool replayComputerMove(EngineMove* move) {
+    if (mode != INPUT_REPLAYING || nextMove >= moveCount || moves[nextMove].tick > tick) {
+        return false;
+    }
+    *move = moves[nextMove++].move;
+    return true;
+}
@@ -0,0 +1,50 @@
+// src/InputRecorder.h
+#ifndef INPUTRECORDER_H
+#define INPUTRECORDER_H
+
+#include <stdbool.h>
+#include <SDL2/SDL.h>
+#include "engine.h"
+
+#define INPUT_RECORDING_HEADER "# Chess-Game input recording 1"
+
+typedef enum {
+    INPUT_LIVE,                  // Straight from SDL
+    INPUT_RECORDING,             // From SDL, and written to the recording
+    INPUT_REPLAYING              // From a recording; SDL's own input is ignored
+} InputMode;
+
+// Everything the game reacts to goes through here: events, the mouse state, the clock and
+// the computer's moves. A recording logs them per tick, one tick being one pass of a UI loop,
+// and a replay feeds back the same ones on the same ticks, so the game takes the same path
+// without waiting for anything.
+//
+// The recording is text, one line per item:
+//   T <tick> <clock ms>               start of every tick
+//   E <tick> <type> <a> <b> <c> [text] an event the game handles
+//   P <tick> <x> <y> <buttons>        mouse state, when it changed
+//   M <tick> <from x> <from y> <to x> <to y> <captured> <promotion> <promotion piece> <modifier>
+bool startInputRecording(const char* path);
+bool startInputReplay(const char* path);
+void stopInput(void);
+
+InputMode getInputMode(void);
+
+// Call at the top of every pass of a loop that polls input. Returns the tick number.
+int beginInputTick(void);
+int getInputTick(void);
+
+// Milliseconds since input started, as of the current tick
+double getInputClockMs(void);
+
+// In place of SDL_PollEvent. Once a replay runs out, it delivers SDL_QUIT once per tick.
+bool pollInputEvent(SDL_Event* event);
+
+// In place of SDL_GetMouseState; recordings and replays see it once per tick
+Uint32 getInputMouseState(int* x, int* y);
+
+// The computer's moves: recorded as they are played, handed back on the same tick in a replay
+void recordComputerMove(const EngineMove* move);
+bool replayComputerMove(EngineMove* move);
+
+#endif // INPUTRECORDER_H
@@ -0,0 +1,113 @@
+// src/MoveHistoryView.c
+#include "MoveHistoryView.h"
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <SDL2/SDL_ttf.h>
+#include "FontManager.h"
+
+void initMoveHistoryView(MoveHistoryView* view, SDL_Rect area) {
+    memset(view, 0, sizeof(*view));
+    view->area = area;
+    for (int i = 0; i < MOVE_HISTORY_CACHED_LINES; i++) {
+        view->lines[i].index = -1;
+    }
+}
+
+void destroyMoveHistoryView(MoveHistoryView* view) {
+    for (int i = 0; i < MOVE_HISTORY_CACHED_LINES; i++) {
+        if (view->lines[i].texture) {
+            SDL_DestroyTexture(view->lines[i].texture);
+        }
+        view->lines[i].texture = NULL;
+        view->lines[i].index = -1;
+    }
+}
+
+static int maxScrollOffset(const MoveHistoryView* view, int moveCount) {
+    int overflow = moveCount * MOVE_HISTORY_LINE_HEIGHT - view->area.h;
+    return overflow > 0 ? overflow : 0;
+}
+
+static void setTargetOffset(MoveHistoryView* view, int offset, int moveCount) {
+    int maxOffset = maxScrollOffset(view, moveCount);
+    view->targetOffset = offset < 0 ? 0 : offset > maxOffset ? maxOffset : offset;
+}
+
+void setMoveHistoryArea(MoveHistoryView* view, SDL_Rect area, int moveCount) {
+    view->area = area;
+    setTargetOffset(view, view->targetOffset, moveCount);
+}
+
+void scrollMoveHistory(MoveHistoryView* view, int pixels, int moveCount) {
+    setTargetOffset(view, view->targetOffset + pixels, moveCount);
+}
+
+void scrollMoveHistoryToEnd(MoveHistoryView* view, int moveCount) {
+    setTargetOffset(view, maxScrollOffset(view, moveCount), moveCount);
+}
+
+bool animateMoveHistory(MoveHistoryView* view, double elapsedMs) {
+    double distance = view->targetOffset - view->scrollOffset;
+    if (distance == 0.0) {
+        return false;
+    }
+    // Close most of the distance each time constant; the last half pixel snaps
+    double step = distance * (1.0 - exp(-elapsedMs / MOVE_HISTORY_GLIDE_MS));
+    if (fabs(distance - step) < 0.5) {
+        view->scrollOffset = view->targetOffset;
+    } else {
+        view->scrollOffset += step;
+    }
+    return true;
+}
+
+// The slot holding move 'index', rendered again only when it held another move
+static MoveHistoryLine* getLine(MoveHistoryView* view, SDL_Renderer* renderer, TTF_Font* font, const GameState* state, int index) {
+    MoveHistoryLine* line = &view->lines[index % MOVE_HISTORY_CACHED_LINES];
+    const char* notation = getMoveNotation(state, index);
+    if (line->index == index && strcmp(line->notation, notation) == 0) {
+        return line;
+    }
+
+    if (line->texture) {
+        SDL_DestroyTexture(line->texture);
+        line->texture = NULL;
+    }
+    line->index = index;
+    snprintf(line->notation, sizeof(line->notation), "%s", notation);
+
+    char text[32];
+    snprintf(text, sizeof(text), "%d. %s", index + 1, notation);
+    SDL_Surface* surface = TTF_RenderText_Blended(font, text, (SDL_Color){255, 255, 255, 255});
+    if (!surface) {
+        printf("Text render error: %s\n", TTF_GetError());
+        return line;
+    }
+    line->texture = SDL_CreateTextureFromSurface(renderer, surface);
+    line->w = surface->w;
+    line->h = surface->h;
+    SDL_FreeSurface(surface);
+    return line;
+}
+
+void drawMoveHistory(MoveHistoryView* view, SDL_Renderer* renderer, const GameState* state) {
+    TTF_Font* font = getFont(FONT_SANS_BOLD, UI_FONT_SIZE);
+    if (!font) {
+        return;
+    }
+
+    int offset = (int)lround(view->scrollOffset);
+    int first = offset / MOVE_HISTORY_LINE_HEIGHT;
+    int last = (offset + view->area.h - 1) / MOVE_HISTORY_LINE_HEIGHT;
+    if (last >= state->moveCount) {
+        last = state->moveCount - 1;
+    }
+    for (int i = first; i <= last; i++) {
+        MoveHistoryLine* line = getLine(view, renderer, font, state, i);
+        if (line->texture) {
+            SDL_Rect dst = {view->area.x, view->area.y + i * MOVE_HISTORY_LINE_HEIGHT - offset, line->w, line->h};
+            SDL_RenderCopy(renderer, line->texture, NULL, &dst);
+        }
+    }
+}
@@ -0,0 +1,46 @@
+// src/MoveHistoryView.h
+#ifndef MOVEHISTORYVIEW_H
+#define MOVEHISTORYVIEW_H
+
+#include <stdbool.h>
+#include <SDL2/SDL.h>
+#include "GameState.h"
+
+#define MOVE_HISTORY_LINE_HEIGHT 25
+#define MOVE_HISTORY_CACHED_LINES 48 // Line textures kept; more than ever fit in the list at once
+#define MOVE_HISTORY_GLIDE_MS 40.0   // Time constant of the scroll glide
+
+// One rendered line, "12. Nf3"
+typedef struct {
+    int index;                       // Move it shows, -1 when the slot is empty
+    char notation[sizeof(((Move*)0)->notation)];
+    SDL_Texture* texture;
+    int w, h;
+} MoveHistoryLine;
+
+// Scrolling list of the game's moves. Only the lines inside the area are looked at, each
+// rendered once into a texture slot of its own, so drawing costs the same at move 10 or 10000.
+typedef struct {
+    SDL_Rect area;                   // Lines are drawn here
+    double scrollOffset;             // Pixels scrolled past the top, as drawn
+    int targetOffset;                // Where the scroll glides to
+    MoveHistoryLine lines[MOVE_HISTORY_CACHED_LINES]; // Move i lives in slot i % MOVE_HISTORY_CACHED_LINES
+} MoveHistoryView;
+
+void initMoveHistoryView(MoveHistoryView* view, SDL_Rect area);
+void destroyMoveHistoryView(MoveHistoryView* view);
+
+// The area shrinks and grows with the panels below it
+void setMoveHistoryArea(MoveHistoryView* view, SDL_Rect area, int moveCount);
+
+// Glide by 'pixels' (negative is up), or to the newest move
+void scrollMoveHistory(MoveHistoryView* view, int pixels, int moveCount);
+void scrollMoveHistoryToEnd(MoveHistoryView* view, int moveCount);
+
+// Advance the glide; true when it moved and the list has to be drawn again
+bool animateMoveHistory(MoveHistoryView* view, double elapsedMs);
+
+// Draw the lines that show in the area; those cut by its edges overhang it, so clip to the area
+void drawMoveHistory(MoveHistoryView* view, SDL_Renderer* renderer, const GameState* state);
+
+#endif // MOVEHISTORYVIEW_H
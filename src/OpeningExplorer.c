@@ -0,0 +1,129 @@
+// src/OpeningExplorer.c
+#include "OpeningExplorer.h"
+#include <stdio.h>
+#include <string.h>
+
+// Look the position up and write the moves as SAN
+static void explorePosition(const OpeningTree* tree, unsigned char board[8][8], unsigned char color,
+                            Vector2f* lastDoublePawn, Vector2f kings[], ExplorerResult* result) {
+    memset(result, 0, sizeof(*result));
+    result->key = hashPosition(board, color, lastDoublePawn);
+
+    size_t count;
+    const OpeningEntry* entries = findOpeningMoves(tree, result->key, &count);
+    MoveGenContext gen;
+    initMoveGen(&gen, board, color, lastDoublePawn);
+    for (size_t i = 0; i < count; i++) {
+        result->totalGames += entries[i].games;
+
+        EngineMove move;
+        if (result->moveCount == EXPLORER_MAX_MOVES || !openingEntryMove(&entries[i], &gen, board, &move)) {
+            continue;
+        }
+        ExplorerMove* shown = &result->moves[result->moveCount++];
+        moveToSAN(board, move, color, lastDoublePawn, kings, shown->san);
+        shown->games = entries[i].games;
+        uint32_t wins = color ? entries[i].blackWins : entries[i].whiteWins;
+        shown->scorePercent = (int)((200ULL * wins + 100ULL * entries[i].draws + entries[i].games) / (2ULL * entries[i].games));
+    }
+}
+
+static int explorerThreadMain(void* data) {
+    OpeningExplorer* explorer = data;
+    unsigned char board[8][8];
+    unsigned char color;
+    Vector2f lastDoublePawn;
+    Vector2f kings[2];
+    ExplorerResult result;
+
+    SDL_LockMutex(explorer->lock);
+    while (!explorer->quit) {
+        if (!explorer->requestPending) {
+            SDL_CondWait(explorer->wake, explorer->lock);
+            continue;
+        }
+        memcpy(board, explorer->board, sizeof(board));
+        color = explorer->color;
+        lastDoublePawn = explorer->lastDoublePawn;
+        kings[0] = explorer->kings[0];
+        kings[1] = explorer->kings[1];
+        explorer->requestPending = false;
+        SDL_UnlockMutex(explorer->lock);
+
+        explorePosition(&explorer->tree, board, color, &lastDoublePawn, kings, &result);
+
+        SDL_LockMutex(explorer->lock);
+        explorer->result = result;
+    }
+    SDL_UnlockMutex(explorer->lock);
+    return 0;
+}
+
+bool initOpeningExplorer(OpeningExplorer* explorer, const char* treePath) {
+    memset(explorer, 0, sizeof(*explorer));
+    if (!openOpeningTree(&explorer->tree, treePath)) {
+        printf("No opening tree at %s; the explorer stays empty\n", treePath);
+        return false;
+    }
+
+    explorer->lock = SDL_CreateMutex();
+    explorer->wake = SDL_CreateCond();
+    if (explorer->lock && explorer->wake) {
+        explorer->thread = SDL_CreateThread(explorerThreadMain, "explorer", explorer);
+    }
+    if (!explorer->thread) {
+        fprintf(stderr, "Error: Could not start the opening explorer: %s\n", SDL_GetError());
+        destroyOpeningExplorer(explorer);
+        return false;
+    }
+    explorer->available = true;
+    printf("Opening tree loaded: %llu moves\n", (unsigned long long)explorer->tree.entryCount);
+    return true;
+}
+
+void destroyOpeningExplorer(OpeningExplorer* explorer) {
+    if (explorer->thread) {
+        SDL_LockMutex(explorer->lock);
+        explorer->quit = true;
+        SDL_CondSignal(explorer->wake);
+        SDL_UnlockMutex(explorer->lock);
+        SDL_WaitThread(explorer->thread, NULL);
+    }
+    if (explorer->wake) SDL_DestroyCond(explorer->wake);
+    if (explorer->lock) SDL_DestroyMutex(explorer->lock);
+    closeOpeningTree(&explorer->tree);
+    memset(explorer, 0, sizeof(*explorer));
+}
+
+void requestExplorerPosition(OpeningExplorer* explorer, const GameState* state) {
+    if (!explorer->available) {
+        return;
+    }
+    unsigned char color = state->blackTurn ? 1 : 0;
+    Vector2f lastDoublePawn = state->lastDoublePushPawn;
+    uint64_t key = hashPosition((unsigned char (*)[8])state->board, color, &lastDoublePawn);
+    if (key == explorer->requestedKey) {
+        return;
+    }
+    explorer->requestedKey = key;
+
+    SDL_LockMutex(explorer->lock);
+    memcpy(explorer->board, state->board, sizeof(explorer->board));
+    explorer->color = color;
+    explorer->lastDoublePawn = lastDoublePawn;
+    explorer->kings[0] = state->kingsPositions[0];
+    explorer->kings[1] = state->kingsPositions[1];
+    explorer->requestPending = true;
+    SDL_CondSignal(explorer->wake);
+    SDL_UnlockMutex(explorer->lock);
+}
+
+bool getExplorerResult(OpeningExplorer* explorer, ExplorerResult* result) {
+    if (!explorer->available) {
+        return false;
+    }
+    SDL_LockMutex(explorer->lock);
+    *result = explorer->result;
+    SDL_UnlockMutex(explorer->lock);
+    return result->key == explorer->requestedKey;
+}
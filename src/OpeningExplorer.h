@@ -0,0 +1,58 @@
+// src/OpeningExplorer.h
+#ifndef OPENINGEXPLORER_H
+#define OPENINGEXPLORER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <SDL2/SDL.h>
+#include "database.h"
+#include "GameState.h"
+
+#define OPENING_TREE_PATH "openings.tree" // In the res directory. Built with: gamedb tree <db> <out>
+#define EXPLORER_MAX_MOVES 10
+#define EXPLORER_PANEL_HEIGHT 300   // Bottom of the second sidebar, below the move history
+
+typedef struct {
+    char san[10];
+    uint32_t games;
+    int scorePercent;            // For the side to move: wins plus half the draws
+} ExplorerMove;
+
+typedef struct {
+    uint64_t key;                // Position the moves were looked up for
+    uint32_t totalGames;
+    ExplorerMove moves[EXPLORER_MAX_MOVES]; // Most played first
+    int moveCount;
+} ExplorerResult;
+
+// Looks positions up in a memory-mapped opening tree on a worker thread, so page faults
+// and SAN generation never hold up a frame. Zero-initialize before first use.
+typedef struct {
+    OpeningTree tree;
+    bool available;              // A tree was loaded and the worker is running
+    SDL_Thread* thread;
+    SDL_mutex* lock;
+    SDL_cond* wake;
+    uint64_t requestedKey;       // Render thread only: the last position handed over
+
+    // Guarded by lock
+    bool quit;
+    bool requestPending;
+    unsigned char board[8][8];
+    unsigned char color;
+    Vector2f lastDoublePawn;
+    Vector2f kings[2];
+    ExplorerResult result;
+} OpeningExplorer;
+
+// False when the tree can't be opened; the explorer then stays empty
+bool initOpeningExplorer(OpeningExplorer* explorer, const char* treePath);
+void destroyOpeningExplorer(OpeningExplorer* explorer);
+
+// Call every frame; only a new position wakes the worker
+void requestExplorerPosition(OpeningExplorer* explorer, const GameState* state);
+
+// Copy the moves for the position last requested; false while they are being looked up
+bool getExplorerResult(OpeningExplorer* explorer, ExplorerResult* result);
+
+#endif // OPENINGEXPLORER_H
@@ -22,19 +22,23 @@ Rook: remembers if it has move before (for castling)
 #define TYPE_MASK 0x7
 #define COLOR_MASK 0x10  //0 = white, 1 = black
 
-#define SELECTED_MASK 0x20
-#define MOVABLE_MASK 0x40
-#define RISKY_MOVE_MASK 0x80
+// A square holds nothing but these bits; selection and move highlights live in a BoardOverlay
+#define PIECE_MASK (TYPE_MASK | MODIFIER | COLOR_MASK)
 
 // Maximum number of pieces that can be captured
 #define MAX_CAPTURED 16
 
-void loadPieceTextures(SDL_Texture* textures[2][7], SDL_Renderer** renderer);
-
-SDL_Texture* getPieceTexture(SDL_Texture* textures[2][7], unsigned char piece);
+#define START_FEN "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1"
+#define FEN_LENGTH 100 // Longest FEN string, terminator included
 
 void placePieces(unsigned char board[8][8], char* startPosition);
 
+// Parse a standard FEN string (uppercase = white); castling rights become MODIFIER flags
+bool loadFEN(const char* fen, unsigned char board[8][8], bool* blackTurn, Vector2f* lastDoublePawn);
+
+// Write the position as a FEN string (room for FEN_LENGTH characters); the inverse of loadFEN
+void writeFEN(unsigned char board[8][8], bool blackTurn, Vector2f* lastDoublePawn, int halfmoveClock, int fullmoveNumber, char* fen);
+
 void exportPosition(unsigned char board[8][8], char **exportString);
 
 void findKings(unsigned char board[8][8], Vector2f kingsPositions[]);
@@ -45,16 +49,6 @@ bool isCheck(unsigned char board[8][8], Vector2f kingPosition);
 
 bool isSquareAttacked(unsigned char board[8][8], Vector2f position, unsigned char attackerColor);
 
-bool inBounds(int y);
-
 bool opposingColor(unsigned char piece, int color);
 
-void generateLongMoves(unsigned char board[8][8], int x, int y, int dx[], int dy[], int color, int directions);
-
-void generateAllPossibleMoves(unsigned char board[8][8], unsigned char color, Vector2f *lastDoublePawn);
-
-void clearPossibleBoard(unsigned char board[8][8]);
-
-void generatePossibleMoves(unsigned char board[8][8], int x, int y, Vector2f *lastDoublePawn);
-
 #endif
\ No newline at end of file
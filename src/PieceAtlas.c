@@ -0,0 +1,142 @@
+// src/PieceAtlas.c
+#include "PieceAtlas.h"
+#include <SDL2/SDL_image.h>
+#include <stdio.h>
+#include <string.h>
+#include "Piece.h"
+#include "Resources.h"
+
+// By piece type, PAWN to KING
+static const char* pieceNames[6] = {"Pawn", "Bishop", "Knight", "Rook", "Queen", "King"};
+static const char* colorNames[2] = {"white", "black"};
+
+// missing counts the sprites that failed to load; they stay transparent
+static SDL_Surface* buildSheet(int squareSize, int capturedSize, int* missing) {
+    *missing = 0;
+    int rowSizes[2] = {squareSize, capturedSize};
+    SDL_Surface* sheet = SDL_CreateRGBSurfaceWithFormat(0, 12 * squareSize, squareSize + capturedSize, 32, SDL_PIXELFORMAT_RGBA32);
+    if (!sheet) {
+        printf("Piece atlas creation failed: %s\n", SDL_GetError());
+        return NULL;
+    }
+
+    for (int color = 0; color < 2; color++) {
+        for (int type = PAWN; type <= KING; type++) {
+            char name[32];
+            char path[1100];
+            snprintf(name, sizeof(name), "%s_%s.png", pieceNames[type - 1], colorNames[color]);
+            resourcePath(name, path, sizeof(path));
+            Uint64 start = SDL_GetPerformanceCounter();
+            SDL_Surface* loaded = IMG_Load(path);
+            SDL_Surface* sprite = loaded ? SDL_ConvertSurfaceFormat(loaded, SDL_PIXELFORMAT_RGBA32, 0) : NULL;
+            if (loaded) SDL_FreeSurface(loaded);
+            if (!sprite) {
+                printf("Texture failed to load. Error: %s\n", SDL_GetError());
+                recordResourceTiming(name, start, false);
+                (*missing)++;
+                continue;
+            }
+
+            // Copy alpha as is; blending onto the empty sheet would darken the edges
+            SDL_SetSurfaceBlendMode(sprite, SDL_BLENDMODE_NONE);
+            int column = color * 6 + type - 1;
+            int rowY = 0;
+            for (int row = 0; row < 2; row++) {
+                SDL_Rect dst = {column * rowSizes[row], rowY, rowSizes[row], rowSizes[row]};
+                SDL_BlitScaled(sprite, NULL, sheet, &dst);
+                rowY += rowSizes[row];
+            }
+            SDL_FreeSurface(sprite);
+            recordResourceTiming(name, start, true);
+        }
+    }
+    return sheet;
+}
+
+SDL_Surface* buildPieceSheet(int squareSize, int capturedSize) {
+    int missing;
+    return buildSheet(squareSize, capturedSize, &missing);
+}
+
+bool createPieceAtlas(PieceAtlas* atlas, SDL_Renderer* renderer, SDL_Surface* sheet, int squareSize, int capturedSize) {
+    memset(atlas, 0, sizeof(*atlas));
+    atlas->rowSizes[0] = squareSize;
+    atlas->rowSizes[1] = capturedSize;
+    atlas->width = 12 * squareSize;
+    atlas->height = squareSize + capturedSize;
+    if (!sheet) {
+        return false;
+    }
+
+    atlas->texture = SDL_CreateTextureFromSurface(renderer, sheet);
+    SDL_FreeSurface(sheet);
+    if (!atlas->texture) {
+        printf("Piece atlas upload failed: %s\n", SDL_GetError());
+        return false;
+    }
+    SDL_SetTextureBlendMode(atlas->texture, SDL_BLENDMODE_BLEND);
+    return true;
+}
+
+bool loadPieceAtlas(PieceAtlas* atlas, SDL_Renderer* renderer, int squareSize, int capturedSize) {
+    int missing;
+    SDL_Surface* sheet = buildSheet(squareSize, capturedSize, &missing);
+    if (sheet && missing > 0) {
+        printf("Piece atlas incomplete: %d of 12 sprites missing\n", missing);
+        SDL_FreeSurface(sheet);
+        sheet = NULL;
+    }
+    return createPieceAtlas(atlas, renderer, sheet, squareSize, capturedSize);
+}
+
+void destroyPieceAtlas(PieceAtlas* atlas) {
+    if (atlas->texture) {
+        SDL_DestroyTexture(atlas->texture);
+        atlas->texture = NULL;
+    }
+}
+
+void clearPieceBatch(PieceBatch* batch) {
+    batch->count = 0;
+}
+
+void addPieceToBatch(PieceBatch* batch, const PieceAtlas* atlas, unsigned char piece, SDL_Rect dst) {
+    int type = piece & TYPE_MASK;
+    if (type == NONE || batch->count == MAX_BATCHED_PIECES) {
+        return;
+    }
+
+    // The smallest row that is still at least as large: sprites are only ever scaled down
+    int row = dst.w <= atlas->rowSizes[1] ? 1 : 0;
+    int size = atlas->rowSizes[row];
+    int column = ((piece & COLOR_MASK) ? 6 : 0) + type - 1;
+    float u0 = (float)(column * size) / atlas->width;
+    float u1 = (float)((column + 1) * size) / atlas->width;
+    float v0 = (float)(row ? atlas->rowSizes[0] : 0) / atlas->height;
+    float v1 = v0 + (float)size / atlas->height;
+
+    SDL_Vertex* vertex = &batch->vertices[batch->count * 4];
+    SDL_Color white = {255, 255, 255, 255};
+    vertex[0] = (SDL_Vertex){{(float)dst.x, (float)dst.y}, white, {u0, v0}};
+    vertex[1] = (SDL_Vertex){{(float)(dst.x + dst.w), (float)dst.y}, white, {u1, v0}};
+    vertex[2] = (SDL_Vertex){{(float)(dst.x + dst.w), (float)(dst.y + dst.h)}, white, {u1, v1}};
+    vertex[3] = (SDL_Vertex){{(float)dst.x, (float)(dst.y + dst.h)}, white, {u0, v1}};
+
+    // Two triangles per quad
+    int first = batch->count * 4;
+    int* index = &batch->indices[batch->count * 6];
+    index[0] = first;
+    index[1] = first + 1;
+    index[2] = first + 2;
+    index[3] = first;
+    index[4] = first + 2;
+    index[5] = first + 3;
+    batch->count++;
+}
+
+void drawPieceBatch(PieceBatch* batch, SDL_Renderer* renderer, const PieceAtlas* atlas) {
+    if (batch->count > 0 && atlas->texture) {
+        SDL_RenderGeometry(renderer, atlas->texture, batch->vertices, batch->count * 4, batch->indices, batch->count * 6);
+    }
+    batch->count = 0;
+}
@@ -0,0 +1,47 @@
+// src/PieceAtlas.h
+#ifndef PIECEATLAS_H
+#define PIECEATLAS_H
+
+#include <stdbool.h>
+#include <SDL2/SDL.h>
+
+#define CAPTURED_PIECE_SIZE 40       // Pieces in the captured boxes of the first sidebar
+#define MAX_BATCHED_PIECES 64        // 32 on the board and up to 30 captured fit in one batch
+
+// All twelve piece sprites in one texture, pre-scaled once at load time: one row at the
+// board's square size, one at the captured-piece size. Column = color * 6 + type - 1.
+typedef struct {
+    SDL_Texture* texture;
+    int width;
+    int height;
+    int rowSizes[2];             // Sprite size of each row, largest first
+} PieceAtlas;
+
+// Build the atlas from the per-piece PNGs in res/; false when it couldn't be created or
+// any sprite failed to load.
+bool loadPieceAtlas(PieceAtlas* atlas, SDL_Renderer* renderer, int squareSize, int capturedSize);
+
+// The two halves of loadPieceAtlas. The sheet is decoded and scaled in memory, so it can be
+// built on a loading thread; NULL when it couldn't be created, and a sprite that fails to load
+// stays transparent. The upload takes ownership of it and must happen on the renderer's thread.
+SDL_Surface* buildPieceSheet(int squareSize, int capturedSize);
+bool createPieceAtlas(PieceAtlas* atlas, SDL_Renderer* renderer, SDL_Surface* sheet, int squareSize, int capturedSize);
+void destroyPieceAtlas(PieceAtlas* atlas);
+
+// Pieces to draw with a single SDL_RenderGeometry call, so the atlas is bound once
+typedef struct {
+    SDL_Vertex vertices[MAX_BATCHED_PIECES * 4];
+    int indices[MAX_BATCHED_PIECES * 6];
+    int count;
+} PieceBatch;
+
+void clearPieceBatch(PieceBatch* batch);
+
+// Queue a piece into the destination rectangle, from the atlas row closest to its size.
+// Empty squares are skipped, as are pieces past MAX_BATCHED_PIECES.
+void addPieceToBatch(PieceBatch* batch, const PieceAtlas* atlas, unsigned char piece, SDL_Rect dst);
+
+// Draw everything queued and empty the batch
+void drawPieceBatch(PieceBatch* batch, SDL_Renderer* renderer, const PieceAtlas* atlas);
+
+#endif // PIECEATLAS_H
@@ -0,0 +1,121 @@
+// src/PositionAnalyzer.c
+#include "PositionAnalyzer.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Write the line as SAN, playing it out on a copy of the root position
+static void writePV(const SearchThread* search, const EngineMove* pv, int pvLength, char* text, size_t size) {
+    unsigned char board[8][8];
+    Vector2f kings[2] = {search->kings[0], search->kings[1]};
+    Vector2f lastDoublePawn = search->lastDoublePawn;
+    unsigned char color = search->color;
+    memcpy(board, search->board, sizeof(board));
+
+    size_t length = 0;
+    text[0] = '\0';
+    for (int i = 0; i < pvLength; i++) {
+        char san[16];
+        moveToSAN(board, pv[i], color, &lastDoublePawn, kings, san);
+        if (length + strlen(san) + 2 > size) break;
+        length += (size_t)snprintf(text + length, size - length, i ? " %s" : "%s", san);
+        engineMakeMove(board, pv[i], &lastDoublePawn, kings, 0);
+        color ^= 1;
+    }
+}
+
+// Runs on the search thread; the root position in the SearchThread is fixed while it searches
+static void onSearchProgress(const SearchResult* result, void* data) {
+    PositionAnalyzer* analyzer = data;
+    AnalysisInfo info;
+    info.key = analyzer->key;
+    info.depth = result->depth;
+    info.nodes = result->nodes;
+    info.nodesPerSecond = result->timeMs > 0 ? (int)(result->nodes * 1000 / result->timeMs) : 0;
+    info.lineCount = result->lineCount < ANALYSIS_MAX_LINES ? result->lineCount : ANALYSIS_MAX_LINES;
+    for (int i = 0; i < info.lineCount; i++) {
+        const SearchLine* line = &result->lines[i];
+        info.lines[i].score = analyzer->search.color ? -line->score : line->score;
+        writePV(&analyzer->search, line->pv, line->pvLength, info.lines[i].pv, sizeof(info.lines[i].pv));
+    }
+
+    SDL_LockMutex(analyzer->lock);
+    analyzer->info = info;
+    SDL_UnlockMutex(analyzer->lock);
+}
+
+bool initPositionAnalyzer(PositionAnalyzer* analyzer) {
+    memset(analyzer, 0, sizeof(*analyzer));
+    analyzer->lineCount = ANALYSIS_DEFAULT_LINES;
+    analyzer->lock = SDL_CreateMutex();
+    if (!analyzer->lock || !initTranspositionTable(&analyzer->tt, ANALYSIS_TT_SIZE_MB)) {
+        fprintf(stderr, "Error: Could not set up position analysis\n");
+        destroyPositionAnalyzer(analyzer);
+        return false;
+    }
+    return true;
+}
+
+void destroyPositionAnalyzer(PositionAnalyzer* analyzer) {
+    stopPositionAnalyzer(analyzer);
+    freeTranspositionTable(&analyzer->tt);
+    if (analyzer->lock) SDL_DestroyMutex(analyzer->lock);
+    memset(analyzer, 0, sizeof(*analyzer));
+}
+
+void stopPositionAnalyzer(PositionAnalyzer* analyzer) {
+    if (isSearchThreadRunning(&analyzer->search)) {
+        stopSearchThread(&analyzer->search);
+    }
+    analyzer->key = 0;
+}
+
+void setAnalysisLines(PositionAnalyzer* analyzer, int lines) {
+    if (lines < 1) lines = 1;
+    if (lines > ANALYSIS_MAX_LINES) lines = ANALYSIS_MAX_LINES;
+    if (lines != analyzer->lineCount) {
+        analyzer->lineCount = lines;
+        stopPositionAnalyzer(analyzer);
+    }
+}
+
+void updatePositionAnalyzer(PositionAnalyzer* analyzer, GameState* state) {
+    if (!analyzer->lock) {
+        return;
+    }
+    unsigned char color = state->blackTurn ? 1 : 0;
+    uint64_t key = hashPosition(state->board, color, &state->lastDoublePushPawn);
+    if (key == analyzer->key) {
+        // A search that ends on its own (a forced mate was found) leaves its last iteration on display
+        if (isSearchThreadFinished(&analyzer->search)) {
+            joinSearchThread(&analyzer->search);
+        }
+        return;
+    }
+
+    // The search polls its stop flag every few hundred nodes, so this returns within milliseconds
+    stopPositionAnalyzer(analyzer);
+    analyzer->key = key;
+    SearchLimits limits = {0, 0, NULL, &analyzer->tt, NULL, onSearchProgress, analyzer, analyzer->lineCount};
+    startSearchThread(&analyzer->search, state->board, color, &state->lastDoublePushPawn, state->kingsPositions,
+                      &state->positionHistory, limits);
+}
+
+bool getAnalysisInfo(PositionAnalyzer* analyzer, AnalysisInfo* info) {
+    if (!analyzer->lock || analyzer->key == 0) {
+        return false;
+    }
+    SDL_LockMutex(analyzer->lock);
+    *info = analyzer->info;
+    SDL_UnlockMutex(analyzer->lock);
+    return info->key == analyzer->key;
+}
+
+void formatAnalysisScore(int score, char* text, size_t size) {
+    if (abs(score) >= MATE_SCORE - MAX_PV_LENGTH) {
+        int moves = (MATE_SCORE - abs(score) + 1) / 2;
+        snprintf(text, size, "#%s%d", score < 0 ? "-" : "", moves);
+    } else {
+        snprintf(text, size, "%+.2f", score / 100.0);
+    }
+}
@@ -0,0 +1,61 @@
+// src/PositionAnalyzer.h
+#ifndef POSITIONANALYZER_H
+#define POSITIONANALYZER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <SDL2/SDL.h>
+#include "engine.h"
+#include "GameState.h"
+#include "SearchThread.h"
+
+#define ANALYSIS_TT_SIZE_MB 32
+#define ANALYSIS_PV_TEXT 96
+#define ANALYSIS_MAX_LINES 5         // What fits in the sidebar; at most MAX_MULTI_PV
+#define ANALYSIS_DEFAULT_LINES 3
+#define ANALYSIS_PANEL_HEIGHT(lines) (70 + (lines) * 25) // Second sidebar, above the opening explorer
+
+typedef struct {
+    int score;                   // Centipawns from white's point of view
+    char pv[ANALYSIS_PV_TEXT];   // In SAN, separated by spaces
+} AnalysisLine;
+
+typedef struct {
+    uint64_t key;                // Position the search is for
+    int depth;
+    long long nodes;
+    int nodesPerSecond;
+    AnalysisLine lines[ANALYSIS_MAX_LINES]; // Best first
+    int lineCount;
+} AnalysisInfo;
+
+// Infinite analysis for the analysis board: searches the current position on a worker thread
+// until the position changes, publishing every completed iteration. Zero-initialize before first use.
+typedef struct {
+    TranspositionTable tt;       // Kept between positions: after a move most of the new tree is known
+    SearchThread search;
+    uint64_t key;                // Position being analysed, set before its search starts
+    int lineCount;               // Lines to search, 1 to ANALYSIS_MAX_LINES
+    SDL_mutex* lock;
+    AnalysisInfo info;           // Guarded by lock
+} PositionAnalyzer;
+
+bool initPositionAnalyzer(PositionAnalyzer* analyzer);
+void destroyPositionAnalyzer(PositionAnalyzer* analyzer);
+
+// Call every frame while analysing; a new position cancels the running search and starts another
+void updatePositionAnalyzer(PositionAnalyzer* analyzer, GameState* state);
+
+// Cancel the search, e.g. when analysis is switched off
+void stopPositionAnalyzer(PositionAnalyzer* analyzer);
+
+// Change how many lines are searched; the search restarts on the next update
+void setAnalysisLines(PositionAnalyzer* analyzer, int lines);
+
+// Copy the deepest iteration for the position being analysed; false until the first one completes
+bool getAnalysisInfo(PositionAnalyzer* analyzer, AnalysisInfo* info);
+
+// "+0.35", "-1.20", or "#3" / "#-3" for forced mates (moves, not plies)
+void formatAnalysisScore(int score, char* text, size_t size);
+
+#endif // POSITIONANALYZER_H
@@ -0,0 +1,315 @@
+// src/Profiler.c
+#include "Profiler.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "FontManager.h"
+#include "TextCache.h"
+
+#define MAX_PHASE_DEPTH 8
+#define OVERLAY_LINES 10
+#define OVERLAY_LINE_HEIGHT 20
+#define OVERLAY_WIDTH 520
+
+// Trace thread ids
+#define TRACE_LOOP_THREAD 1
+#define TRACE_ENGINE_THREAD 2
+
+static const char* phaseNames[PHASE_COUNT] = {"input", "status", "engine", "render", "present"};
+
+typedef struct {
+    ProfilePhase phase;
+    Uint64 start;
+    Uint64 resumed;              // Start, or the end of the last phase nested in it
+} OpenPhase;
+
+typedef struct {
+    int depth;
+    long long nodes;
+    int timeMs;
+} EngineSearchStats;
+
+static bool profiling = false;
+static SDL_threadID profiledThread;
+static Uint64 frequency;
+static Uint64 traceOrigin;
+static FILE* trace = NULL;
+static bool traceHasEvents = false;
+
+// The frame being measured
+static bool inFrame = false;
+static Uint64 frameStart;
+static double framePhaseMs[PHASE_COUNT];
+static OpenPhase openPhases[MAX_PHASE_DEPTH];
+static int openCount = 0;
+
+// The last PROFILER_FRAMES presented frames, oldest overwritten first
+static double frameMs[PROFILER_FRAMES];
+static double phaseMs[PROFILER_FRAMES][PHASE_COUNT];
+static int frameCount = 0;
+
+// Every frame since the start, for printProfileSummary
+static double* allFrameMs = NULL;
+static int allFrameCapacity = 0;
+static int loopPasses = 0;
+static double totalPhaseMs[PHASE_COUNT];
+
+static EngineSearchStats engineSearches[PROFILER_ENGINE_MOVES];
+static int engineSearchCount = 0;
+
+static bool overlayVisible = false;
+static Uint32 overlayRefreshed = 0;
+static char overlayLines[OVERLAY_LINES][96];
+static int overlayLineCount = 0;
+
+static bool onProfiledThread(void) {
+    return profiling && SDL_ThreadID() == profiledThread;
+}
+
+static double millisecondsBetween(Uint64 start, Uint64 end) {
+    return 1000.0 * (end - start) / frequency;
+}
+
+static void writeTraceEvent(const char* name, int thread, Uint64 start, Uint64 end, const char* args) {
+    if (!trace) {
+        return;
+    }
+    if (start < traceOrigin) {
+        start = traceOrigin;
+    }
+    fprintf(trace, "%s{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.1f,\"dur\":%.1f%s%s}",
+            traceHasEvents ? ",\n" : "", name, thread,
+            1000.0 * millisecondsBetween(traceOrigin, start), 1000.0 * millisecondsBetween(start, end),
+            args ? ",\"args\":" : "", args ? args : "");
+    traceHasEvents = true;
+}
+
+static void writeThreadName(int thread, const char* name) {
+    fprintf(trace, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s\"}}",
+            traceHasEvents ? ",\n" : "", thread, name);
+    traceHasEvents = true;
+}
+
+void initProfiler(const char* tracePath) {
+    profiling = true;
+    profiledThread = SDL_ThreadID();
+    frequency = SDL_GetPerformanceFrequency();
+    traceOrigin = SDL_GetPerformanceCounter();
+
+    if (tracePath) {
+        trace = fopen(tracePath, "w");
+        if (!trace) {
+            fprintf(stderr, "Error: Could not open file %s for writing\n", tracePath);
+            return;
+        }
+        fprintf(trace, "[\n");
+        writeThreadName(TRACE_LOOP_THREAD, "game loop");
+        writeThreadName(TRACE_ENGINE_THREAD, "computer searches");
+        printf("Writing a trace to %s\n", tracePath);
+    }
+}
+
+void closeProfiler(void) {
+    if (trace) {
+        fprintf(trace, "\n]\n");
+        fclose(trace);
+        trace = NULL;
+    }
+    free(allFrameMs);
+    allFrameMs = NULL;
+    allFrameCapacity = 0;
+    profiling = false;
+}
+
+void beginProfileFrame(void) {
+    if (!onProfiledThread()) {
+        return;
+    }
+    inFrame = true;
+    frameStart = SDL_GetPerformanceCounter();
+    memset(framePhaseMs, 0, sizeof(framePhaseMs));
+}
+
+void endProfileFrame(bool presented) {
+    if (!onProfiledThread() || !inFrame) {
+        return;
+    }
+    inFrame = false;
+    Uint64 now = SDL_GetPerformanceCounter();
+    writeTraceEvent(presented ? "frame" : "idle frame", TRACE_LOOP_THREAD, frameStart, now, NULL);
+    loopPasses++;
+    for (int phase = 0; phase < PHASE_COUNT; phase++) {
+        totalPhaseMs[phase] += framePhaseMs[phase];
+    }
+    if (!presented) {
+        return;
+    }
+
+    double milliseconds = millisecondsBetween(frameStart, now);
+    if (frameCount == allFrameCapacity) {
+        int capacity = allFrameCapacity ? allFrameCapacity * 2 : 1024;
+        double* resized = realloc(allFrameMs, capacity * sizeof(double));
+        if (resized) {
+            allFrameMs = resized;
+            allFrameCapacity = capacity;
+        }
+    }
+    if (frameCount < allFrameCapacity) {
+        allFrameMs[frameCount] = milliseconds;
+    }
+
+    int slot = frameCount % PROFILER_FRAMES;
+    frameMs[slot] = milliseconds;
+    memcpy(phaseMs[slot], framePhaseMs, sizeof(framePhaseMs));
+    frameCount++;
+}
+
+void beginProfilePhase(ProfilePhase phase) {
+    if (!onProfiledThread() || openCount == MAX_PHASE_DEPTH) {
+        return;
+    }
+    Uint64 now = SDL_GetPerformanceCounter();
+
+    // The enclosing phase stops counting until this one ends
+    if (openCount > 0) {
+        OpenPhase* parent = &openPhases[openCount - 1];
+        framePhaseMs[parent->phase] += millisecondsBetween(parent->resumed, now);
+    }
+    openPhases[openCount++] = (OpenPhase){phase, now, now};
+}
+
+void endProfilePhase(ProfilePhase phase) {
+    if (!onProfiledThread() || openCount == 0 || openPhases[openCount - 1].phase != phase) {
+        return;
+    }
+    Uint64 now = SDL_GetPerformanceCounter();
+    OpenPhase* open = &openPhases[--openCount];
+    framePhaseMs[phase] += millisecondsBetween(open->resumed, now);
+    writeTraceEvent(phaseNames[phase], TRACE_LOOP_THREAD, open->start, now, NULL);
+    if (openCount > 0) {
+        openPhases[openCount - 1].resumed = now;
+    }
+}
+
+void recordEngineSearch(const SearchResult* result) {
+    if (!onProfiledThread()) {
+        return;
+    }
+    EngineSearchStats* stats = &engineSearches[engineSearchCount++ % PROFILER_ENGINE_MOVES];
+    stats->depth = result->depth;
+    stats->nodes = result->nodes;
+    stats->timeMs = result->timeMs;
+
+    // The search ran on its own thread; it is placed on the trace where it ended
+    char args[128];
+    Uint64 now = SDL_GetPerformanceCounter();
+    Uint64 duration = (Uint64)result->timeMs * frequency / 1000;
+    snprintf(args, sizeof(args), "{\"depth\":%d,\"nodes\":%lld,\"nps\":%lld}", result->depth, result->nodes,
+             result->timeMs > 0 ? result->nodes * 1000 / result->timeMs : 0);
+    writeTraceEvent("search", TRACE_ENGINE_THREAD, duration < now ? now - duration : 0, now, args);
+}
+
+void toggleProfilerOverlay(void) {
+    overlayVisible = !overlayVisible;
+    overlayRefreshed = 0;
+}
+
+bool isProfilerOverlayVisible(void) {
+    return overlayVisible;
+}
+
+bool isProfilerOverlayStale(void) {
+    return overlayVisible && (overlayRefreshed == 0 || SDL_GetTicks() - overlayRefreshed >= PROFILER_REFRESH_MS);
+}
+
+static int compareMilliseconds(const void* a, const void* b) {
+    double difference = *(const double*)a - *(const double*)b;
+    return (difference > 0) - (difference < 0);
+}
+
+void printProfileSummary(void) {
+    int count = frameCount < allFrameCapacity ? frameCount : allFrameCapacity;
+    printf("%d frames presented in %d loop passes\n", frameCount, loopPasses);
+    if (count > 0) {
+        double* sorted = malloc(count * sizeof(double));
+        if (sorted) {
+            memcpy(sorted, allFrameMs, count * sizeof(double));
+            qsort(sorted, count, sizeof(double), compareMilliseconds);
+            printf("Frame ms: p50 %.3f  p95 %.3f  p99 %.3f  max %.3f\n", sorted[(count - 1) / 2],
+                   sorted[(int)(0.95 * (count - 1))], sorted[(int)(0.99 * (count - 1))], sorted[count - 1]);
+            free(sorted);
+        }
+    }
+    for (int phase = 0; phase < PHASE_COUNT; phase++) {
+        printf("  %-8s %10.2f ms, %.4f ms per pass\n", phaseNames[phase], totalPhaseMs[phase],
+               loopPasses > 0 ? totalPhaseMs[phase] / loopPasses : 0.0);
+    }
+}
+
+// The numbers are only formatted every PROFILER_REFRESH_MS: readable, and the text cache
+// isn't flooded with strings that are never drawn again
+static void refreshOverlay(void) {
+    overlayLineCount = 0;
+    int count = frameCount < PROFILER_FRAMES ? frameCount : PROFILER_FRAMES;
+    if (count == 0) {
+        snprintf(overlayLines[overlayLineCount++], sizeof(overlayLines[0]), "No frames yet");
+    } else {
+        double sorted[PROFILER_FRAMES];
+        double averages[PHASE_COUNT] = {0};
+        memcpy(sorted, frameMs, count * sizeof(double));
+        qsort(sorted, count, sizeof(double), compareMilliseconds);
+        for (int i = 0; i < count; i++) {
+            for (int phase = 0; phase < PHASE_COUNT; phase++) {
+                averages[phase] += phaseMs[i][phase] / count;
+            }
+        }
+        snprintf(overlayLines[overlayLineCount++], sizeof(overlayLines[0]), "Frame ms (last %d)", count);
+        snprintf(overlayLines[overlayLineCount++], sizeof(overlayLines[0]), "p50 %.2f  p95 %.2f  p99 %.2f  max %.2f",
+                 sorted[(count - 1) / 2], sorted[(int)(0.95 * (count - 1))], sorted[(int)(0.99 * (count - 1))],
+                 sorted[count - 1]);
+        snprintf(overlayLines[overlayLineCount++], sizeof(overlayLines[0]), "input %.2f  status %.2f  engine %.2f",
+                 averages[PHASE_INPUT], averages[PHASE_STATUS], averages[PHASE_ENGINE]);
+        snprintf(overlayLines[overlayLineCount++], sizeof(overlayLines[0]), "render %.2f  present %.2f (average)",
+                 averages[PHASE_RENDER], averages[PHASE_PRESENT]);
+    }
+
+    TextCacheStats text = getTextCacheStats();
+    snprintf(overlayLines[overlayLineCount++], sizeof(overlayLines[0]), "Text cache %lld hits, %lld misses",
+             text.hits, text.misses);
+
+    if (engineSearchCount == 0) {
+        snprintf(overlayLines[overlayLineCount++], sizeof(overlayLines[0]), "No computer moves yet");
+    }
+    // Newest first
+    for (int i = 0; i < PROFILER_ENGINE_MOVES && i < engineSearchCount; i++) {
+        int index = engineSearchCount - 1 - i;
+        const EngineSearchStats* stats = &engineSearches[index % PROFILER_ENGINE_MOVES];
+        long long nps = stats->timeMs > 0 ? stats->nodes * 1000 / stats->timeMs : 0;
+        snprintf(overlayLines[overlayLineCount++], sizeof(overlayLines[0]), "#%d d%d %lld nodes %d ms %lld knps",
+                 index + 1, stats->depth, stats->nodes, stats->timeMs, nps / 1000);
+    }
+    overlayRefreshed = SDL_GetTicks();
+    if (overlayRefreshed == 0) {
+        overlayRefreshed = 1;
+    }
+}
+
+void drawProfilerOverlay(SDL_Renderer* renderer, int x, int y) {
+    if (!overlayVisible) {
+        return;
+    }
+    if (isProfilerOverlayStale()) {
+        refreshOverlay();
+    }
+
+    SDL_Rect background = {x, y, OVERLAY_WIDTH, overlayLineCount * OVERLAY_LINE_HEIGHT + 10};
+    SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 190);
+    SDL_RenderFillRect(renderer, &background);
+
+    TTF_Font* font = getFont(FONT_MONO, SMALL_FONT_SIZE);
+    SDL_Color color = {120, 255, 120, 255};
+    for (int i = 0; font && i < overlayLineCount; i++) {
+        drawCachedText(renderer, font, overlayLines[i], color, x + 8, y + 5 + i * OVERLAY_LINE_HEIGHT);
+    }
+}
@@ -0,0 +1,55 @@
+// src/Profiler.h
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <stdbool.h>
+#include <SDL2/SDL.h>
+#include "engine.h"
+
+#define PROFILER_FRAMES 240          // Frames behind the percentiles and phase averages
+#define PROFILER_ENGINE_MOVES 4      // Computer moves listed on the overlay
+#define PROFILER_REFRESH_MS 500      // The overlay's numbers change no faster than this
+
+// Where a frame's time goes. Phases nest: a game status update made while handling
+// input is counted as status, not as input.
+typedef enum {
+    PHASE_INPUT,                 // Events, clicks and the moves they make
+    PHASE_STATUS,                // updateGameStatus: check, mate, draws and evaluation
+    PHASE_ENGINE,                // Handing positions to and results from the background searches
+    PHASE_RENDER,                // Drawing into the static layer and the window
+    PHASE_PRESENT,               // SDL_RenderPresent
+    PHASE_COUNT
+} ProfilePhase;
+
+// Frame and engine timings of the game loop. Only the thread that called initProfiler is
+// measured; calls from any other thread are ignored, so shared code can be instrumented.
+// tracePath, when not NULL, receives every frame, phase and search as Chrome trace events
+// (open it in chrome://tracing or Perfetto).
+void initProfiler(const char* tracePath);
+void closeProfiler(void);
+
+// A frame runs from after the idle wait to the present. Frames that present nothing
+// still go to the trace, but not into the percentiles.
+void beginProfileFrame(void);
+void endProfileFrame(bool presented);
+
+void beginProfilePhase(ProfilePhase phase);
+void endProfilePhase(ProfilePhase phase);
+
+// A search that produced the computer's move
+void recordEngineSearch(const SearchResult* result);
+
+// Frame time percentiles and time per phase over the whole run, e.g. at the end of a replay
+void printProfileSummary(void);
+
+// Toggled with F3; hidden at the start
+void toggleProfilerOverlay(void);
+bool isProfilerOverlayVisible(void);
+
+// True when the overlay's numbers are older than PROFILER_REFRESH_MS, i.e. it needs a redraw
+bool isProfilerOverlayStale(void);
+
+// Draw the overlay with its top-left corner at (x, y)
+void drawProfilerOverlay(SDL_Renderer* renderer, int x, int y);
+
+#endif // PROFILER_H
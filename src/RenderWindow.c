@@ -5,6 +5,9 @@
 #include <stdio.h>
 
 #include "RenderWindow.h"
+#include "TextCache.h"
+#include "FontManager.h"
+#include "InputRecorder.h"
 #include "Piece.h"
 #include "app_globals.h"
 #include "util.h" // Include util.h to access global constants like boardWidth, sidebar1_width, etc.
@@ -12,8 +15,6 @@
 // Store the renderer as a static variable for access from other modules
 static SDL_Renderer* globalRenderer = NULL;
 
-TTF_Font *globalFont = NULL;
-
 // Renderer for external use
 SDL_Renderer* mainRenderer = NULL;
 
@@ -30,6 +31,10 @@ bool createWindow(const char* p_title, SDL_Window** window, SDL_Renderer** rende
     }
 
     *renderer = SDL_CreateRenderer(*window, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC);
+    if(*renderer == NULL) {
+        // No GPU renderer, e.g. on the dummy video driver of a headless replay
+        *renderer = SDL_CreateRenderer(*window, -1, SDL_RENDERER_SOFTWARE);
+    }
     if(*renderer == NULL) {
         printf("Renderer failed to init. Error: %s\n", SDL_GetError());
         return false;
@@ -53,17 +58,15 @@ SDL_Renderer* getMainRenderer() {
     return mainRenderer;
 }
 
-void drawBoard(SDL_Renderer* renderer, int squareSize, int boardOffset, SDL_Color color1, SDL_Color color2, SDL_Color colorClicked, SDL_Color colorPossible, SDL_Color colorRisky, unsigned char board[8][8]) {
+void drawBoard(SDL_Renderer* renderer, int squareSize, int boardOffset, SDL_Color color1, SDL_Color color2, SDL_Color colorClicked, SDL_Color colorPossible, SDL_Color colorRisky, const BoardOverlay* overlay) {
     // Board is now on the left side, no offset needed
     // The boardOffset parameter is still there but is usually 0 when drawing the main board
     for(int row = 0; row < 8; row++) {
         for(int col = 0; col < 8; col++) {
-
-            // printf("0x%X ", board[row][col]);
             SDL_Color currentColor = ((row + col) % 2 == 0) ? color1 : color2;
-            int isClicked = board[row][col] & (0x1 << 5);
-            int isPossible = board[row][col] & 0x40;
-            int isRisky = board[row][col] & 0x80;
+            int isClicked = overlay->selectedSquare == SQUARE(row, col);
+            int isPossible = (overlay->movable & SQUARE_BIT(SQUARE(row, col))) != 0;
+            int isRisky = (overlay->risky & SQUARE_BIT(SQUARE(row, col))) != 0;
 
             if(isClicked) {
                 currentColor = colorClicked;
@@ -82,9 +85,7 @@ void drawBoard(SDL_Renderer* renderer, int squareSize, int boardOffset, SDL_Colo
             SDL_RenderFillRect(renderer, &square);
 
         }
-        // putchar('\n');
     }
-    // putchar('\n');
 
     SDL_SetRenderDrawColor(renderer, 100, 100, 100, 255);
     SDL_Rect boardBorder = {boardOffset-1, -1, squareSize*8+2, squareSize*8+2};
@@ -117,20 +118,7 @@ void render(SDL_Rect textureAtlas, int posx, int posy, SDL_Texture* tex, SDL_Ren
 
 }
 
-void renderPiece(SDL_Rect pieceAtlas, int boardOffset, int squareSize, int line, int col, SDL_Texture* tex, SDL_Renderer** renderer) {
-    SDL_Rect src = pieceAtlas;
-
-    SDL_Rect dst;
-    // Board is now on the left side, no offset needed
-    dst.x = col*squareSize;
-    dst.y = line*squareSize;
-    dst.w = squareSize;
-    dst.h = squareSize;
-
-    SDL_RenderCopy(*renderer, tex, &src, &dst);
-}
-
-unsigned char showPromotionMenu(SDL_Renderer* renderer, SDL_Texture* pieceTextures[2][7], int x, int y, unsigned char color, int screenWidth_local, int screenHeight_local) {
+unsigned char showPromotionMenu(SDL_Renderer* renderer, const PieceAtlas* atlas, int x, int y, unsigned char color, int screenWidth_local, int screenHeight_local) {
     // Create a semi-transparent overlay
     SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
     SDL_SetRenderDrawColor(renderer, 0, 0, 0, 180); // Semi-transparent black
@@ -153,23 +141,17 @@ unsigned char showPromotionMenu(SDL_Renderer* renderer, SDL_Texture* pieceTextur
     SDL_RenderDrawRect(renderer, &menuRect);
 
     // Draw menu title
-    if (globalFont) {
-        SDL_Color textColor = {0, 0, 0, 255}; // Black
-        SDL_Surface* textSurface = TTF_RenderText_Solid(globalFont, "Promote pawn to:", textColor);
-        if (textSurface) {
-            SDL_Texture* textTexture = SDL_CreateTextureFromSurface(renderer, textSurface);
-            if (textTexture) {
-                SDL_Rect textRect = {
-                        menuX + (menuWidth - textSurface->w) / 2,
-                        menuY + 10,
-                        textSurface->w,
-                        textSurface->h
-                };
-                SDL_RenderCopy(renderer, textTexture, NULL, &textRect);
-                SDL_DestroyTexture(textTexture);
-            }
-            SDL_FreeSurface(textSurface);
-        }
+    int textWidth, textHeight;
+    SDL_Color textColor = {0, 0, 0, 255}; // Black
+    SDL_Texture* textTexture = getTextTexture(renderer, getFont(FONT_SANS_BOLD, UI_FONT_SIZE), "Promote pawn to:", textColor, &textWidth, &textHeight);
+    if (textTexture) {
+        SDL_Rect textRect = {
+                menuX + (menuWidth - textWidth) / 2,
+                menuY + 10,
+                textWidth,
+                textHeight
+        };
+        SDL_RenderCopy(renderer, textTexture, NULL, &textRect);
     }
 
     // Draw promotion options
@@ -185,10 +167,13 @@ unsigned char showPromotionMenu(SDL_Renderer* renderer, SDL_Texture* pieceTextur
     SDL_Rect knightRect = {startX + 3 * (pieceSize + spacing), pieceY, pieceSize, pieceSize};
 
     // Draw pieces
-    SDL_RenderCopy(renderer, pieceTextures[color >> 4][QUEEN], NULL, &queenRect);
-    SDL_RenderCopy(renderer, pieceTextures[color >> 4][ROOK], NULL, &rookRect);
-    SDL_RenderCopy(renderer, pieceTextures[color >> 4][BISHOP], NULL, &bishopRect);
-    SDL_RenderCopy(renderer, pieceTextures[color >> 4][KNIGHT], NULL, &knightRect);
+    static PieceBatch batch;
+    clearPieceBatch(&batch);
+    addPieceToBatch(&batch, atlas, QUEEN | color, queenRect);
+    addPieceToBatch(&batch, atlas, ROOK | color, rookRect);
+    addPieceToBatch(&batch, atlas, BISHOP | color, bishopRect);
+    addPieceToBatch(&batch, atlas, KNIGHT | color, knightRect);
+    drawPieceBatch(&batch, renderer, atlas);
 
     // Draw borders around options
     SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
@@ -206,7 +191,8 @@ unsigned char showPromotionMenu(SDL_Renderer* renderer, SDL_Texture* pieceTextur
     unsigned char selectedPiece = QUEEN | color;
 
     while (!selected) {
-        while (SDL_PollEvent(&event)) {
+        // Same input tick as the click that opened the menu, so a replay gets the choice back
+        while (pollInputEvent(&event)) {
             if (event.type == SDL_MOUSEBUTTONDOWN && event.button.button == SDL_BUTTON_LEFT) {
                 int mouseX = event.button.x;
                 int mouseY = event.button.y;
@@ -258,51 +244,24 @@ void cleanUp(SDL_Window* window) {
     SDL_DestroyWindow(window);
 }
 
-bool initFont(const char *fontPath, int fontSize) {
-    if (TTF_Init() == -1) {
-        printf("TTF_Init failed: %s\n", TTF_GetError());
-        return false;
-    }
-
-    globalFont = TTF_OpenFont(fontPath, fontSize);
-    if (!globalFont) {
-        printf("Failed to load font: %s\n", TTF_GetError());
-        return false;
-    }
-
-    return true;
-}
-
 void renderText(SDL_Renderer *renderer, const char *text, SDL_Color color, int x, int y) {
-    if (!globalFont) {
+    TTF_Font* font = getFont(FONT_SANS_BOLD, UI_FONT_SIZE);
+    if (!font) {
         printf("Font not initialized!\n");
         return;
     }
 
-    SDL_Surface *surface = TTF_RenderText_Blended(globalFont, text, color);
-    if (!surface) {
-        printf("Text render error: %s\n", TTF_GetError());
-        return;
-    }
-
-    SDL_Texture *texture = SDL_CreateTextureFromSurface(renderer, surface);
-
-    SDL_Rect dstRect = {x, y, surface->w, surface->h};
-    SDL_RenderCopy(renderer, texture, NULL, &dstRect);
-
-    SDL_FreeSurface(surface);
-    SDL_DestroyTexture(texture);
+    // Steady frames draw the same strings again: only new ones get rasterized
+    drawCachedText(renderer, font, text, color, x, y);
 }
 
-void renderCapturedPieces(SDL_Renderer *renderer, SDL_Texture* pieceTextures[2][7], GameState* state) {
-    // Constants for rendering captured pieces
-    const int capturedPieceSize = 40; // Smaller size for captured pieces
+void batchCapturedPieces(PieceBatch* batch, const PieceAtlas* atlas, GameState* state) {
+    // Constants for the captured pieces
+    const int capturedPieceSize = CAPTURED_PIECE_SIZE; // Smaller size for captured pieces
     const int padding = 5;
     const int piecesPerRow = 6; // Number of pieces to display per row in sidebar
 
-    SDL_Rect srcRect = {0, 0, 60, 60}; // Assuming piece textures are 60x60 within a larger atlas
-
-    // Render White's Captured Pieces (Black's pieces)
+    // White's Captured Pieces (Black's pieces)
     // This goes into the 'Captured by Black' box, which is currently a blue box at boardWidth, 100
     int startX_blackCaptured = boardWidth + padding;
     int startY_blackCaptured = 140 + padding; // Below the timer box
@@ -312,17 +271,12 @@ void renderCapturedPieces(SDL_Renderer *renderer, SDL_Texture* pieceTextures[2][
         // Captured pieces by White are Black's pieces (COLOR_MASK represents black if set)
         unsigned char pieceByte = pieceType | COLOR_MASK; // Combine type with black color mask
 
-        SDL_Texture *tex = getPieceTexture(pieceTextures, pieceByte);
-        if (tex) {
-            int currentX = startX_blackCaptured + (i % piecesPerRow) * (capturedPieceSize + padding);
-            int currentY = startY_blackCaptured + (i / piecesPerRow) * (capturedPieceSize + padding);
-
-            SDL_Rect destRect = {currentX, currentY, capturedPieceSize, capturedPieceSize};
-            SDL_RenderCopy(renderer, tex, &srcRect, &destRect);
-        }
+        int currentX = startX_blackCaptured + (i % piecesPerRow) * (capturedPieceSize + padding);
+        int currentY = startY_blackCaptured + (i / piecesPerRow) * (capturedPieceSize + padding);
+        addPieceToBatch(batch, atlas, pieceByte, (SDL_Rect){currentX, currentY, capturedPieceSize, capturedPieceSize});
     }
 
-    // Render Black's Captured Pieces (White's pieces)
+    // Black's Captured Pieces (White's pieces)
     // This goes into the 'Captured by White' box, which is currently a purple box at boardWidth + sidebar1_width, 250
     int startX_whiteCaptured = boardWidth + padding;
     int startY_whiteCaptured = 390 + padding; // Offset for white's captured box
@@ -332,21 +286,8 @@ void renderCapturedPieces(SDL_Renderer *renderer, SDL_Texture* pieceTextures[2][
         // Captured pieces by Black are White's pieces (0 for white color)
         unsigned char pieceByte = pieceType; // Combine type with white color (0 means white)
 
-        SDL_Texture *tex = getPieceTexture(pieceTextures, pieceByte);
-        if (tex) {
-            int currentX = startX_whiteCaptured + (i % piecesPerRow) * (capturedPieceSize + padding);
-            int currentY = startY_whiteCaptured + (i / piecesPerRow) * (capturedPieceSize + padding);
-
-            SDL_Rect destRect = {currentX, currentY, capturedPieceSize, capturedPieceSize};
-            SDL_RenderCopy(renderer, tex, &srcRect, &destRect);
-        }
+        int currentX = startX_whiteCaptured + (i % piecesPerRow) * (capturedPieceSize + padding);
+        int currentY = startY_whiteCaptured + (i / piecesPerRow) * (capturedPieceSize + padding);
+        addPieceToBatch(batch, atlas, pieceByte, (SDL_Rect){currentX, currentY, capturedPieceSize, capturedPieceSize});
     }
 }
-
-void destroyFont() {
-    if (globalFont) {
-        TTF_CloseFont(globalFont);
-        globalFont = NULL;
-    }
-    TTF_Quit();
-}
\ No newline at end of file
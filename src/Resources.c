@@ -0,0 +1,158 @@
+// src/Resources.c
+#include "Resources.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct {
+    char name[64];
+    double milliseconds;
+    bool loaded;
+} ResourceTiming;
+
+typedef struct {
+    char name[32];
+    SDL_ThreadFunction run;
+    void* data;
+    SDL_Thread* thread;
+    Uint64 start;
+    SDL_atomic_t done;
+} ResourceJob;
+
+static char resourceDirectory[1024];
+
+// Timings, guarded by timingLock
+static SDL_SpinLock timingLock;
+static ResourceTiming timings[MAX_RESOURCE_TIMINGS];
+static int timingCount = 0;
+
+static ResourceJob jobs[MAX_RESOURCE_JOBS];
+static int jobCount = 0;
+static int expectedAssets = 0;
+static SDL_atomic_t loadedAssets;
+
+static bool isResourceDirectory(const char* directory) {
+    char path[1100];
+    snprintf(path, sizeof(path), "%s%s", directory, RESOURCE_PROBE_FILE);
+    FILE* file = fopen(path, "rb");
+    if (file) fclose(file);
+    return file != NULL;
+}
+
+void initResourcePaths(void) {
+    char* basePath = SDL_GetBasePath();
+    const char* candidates[] = {"../res/", "res/"};
+    for (int i = 0; basePath && i < 2; i++) {
+        snprintf(resourceDirectory, sizeof(resourceDirectory), "%s%s", basePath, candidates[i]);
+        if (isResourceDirectory(resourceDirectory)) {
+            SDL_free(basePath);
+            return;
+        }
+    }
+    SDL_free(basePath);
+
+    // Started from the source tree, or the platform can't tell where the executable is
+    for (int i = 0; i < 2; i++) {
+        if (isResourceDirectory(candidates[i])) {
+            snprintf(resourceDirectory, sizeof(resourceDirectory), "%s", candidates[i]);
+            return;
+        }
+    }
+    snprintf(resourceDirectory, sizeof(resourceDirectory), "../res/");
+    printf("No res directory found beside the executable or the working directory\n");
+}
+
+void resourcePath(const char* relative, char* path, size_t size) {
+    if (!resourceDirectory[0]) {
+        initResourcePaths();
+    }
+    snprintf(path, size, "%s%s", resourceDirectory, relative);
+}
+
+void recordResourceTiming(const char* name, Uint64 startCounter, bool loaded) {
+    double milliseconds = 1000.0 * (SDL_GetPerformanceCounter() - startCounter) / SDL_GetPerformanceFrequency();
+    SDL_AtomicLock(&timingLock);
+    if (timingCount < MAX_RESOURCE_TIMINGS) {
+        ResourceTiming* timing = &timings[timingCount++];
+        snprintf(timing->name, sizeof(timing->name), "%s", name);
+        timing->milliseconds = milliseconds;
+        timing->loaded = loaded;
+    }
+    SDL_AtomicUnlock(&timingLock);
+    SDL_AtomicAdd(&loadedAssets, 1);
+}
+
+static int compareTimings(const void* a, const void* b) {
+    double difference = ((const ResourceTiming*)b)->milliseconds - ((const ResourceTiming*)a)->milliseconds;
+    return (difference > 0) - (difference < 0);
+}
+
+void printResourceTimings(void) {
+    SDL_AtomicLock(&timingLock);
+    qsort(timings, timingCount, sizeof(ResourceTiming), compareTimings);
+    double total = 0.0;
+    for (int i = 0; i < timingCount; i++) {
+        printf("  %7.2f ms  %s%s\n", timings[i].milliseconds, timings[i].name, timings[i].loaded ? "" : " (failed)");
+        total += timings[i].milliseconds;
+    }
+    printf("%d assets, %.1f ms of loading\n", timingCount, total);
+    SDL_AtomicUnlock(&timingLock);
+}
+
+static int runResourceJob(void* data) {
+    ResourceJob* job = data;
+    int result = job->run(job->data);
+    printf("Loaded %s in %.1f ms\n", job->name,
+           1000.0 * (SDL_GetPerformanceCounter() - job->start) / SDL_GetPerformanceFrequency());
+    SDL_AtomicSet(&job->done, 1);
+    return result;
+}
+
+int startResourceJob(const char* name, SDL_ThreadFunction run, void* data, int assets) {
+    expectedAssets += assets;
+    if (jobCount < MAX_RESOURCE_JOBS) {
+        ResourceJob* job = &jobs[jobCount];
+        snprintf(job->name, sizeof(job->name), "%s", name);
+        job->run = run;
+        job->data = data;
+        job->start = SDL_GetPerformanceCounter();
+        SDL_AtomicSet(&job->done, 0);
+        job->thread = SDL_CreateThread(runResourceJob, name, job);
+        if (job->thread) {
+            return jobCount++;
+        }
+        fprintf(stderr, "Error: Could not start loading %s: %s\n", name, SDL_GetError());
+    }
+    run(data);
+    return -1;
+}
+
+bool isResourceJobDone(int id) {
+    return id < 0 || id >= jobCount || SDL_AtomicGet(&jobs[id].done);
+}
+
+bool resourceJobsDone(void) {
+    for (int i = 0; i < jobCount; i++) {
+        if (!SDL_AtomicGet(&jobs[i].done)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+float resourceProgress(void) {
+    if (expectedAssets == 0) {
+        return 1.0f;
+    }
+    float progress = (float)SDL_AtomicGet(&loadedAssets) / expectedAssets;
+    return progress > 1.0f ? 1.0f : progress;
+}
+
+void waitForResourceJobs(void) {
+    for (int i = 0; i < jobCount; i++) {
+        if (jobs[i].thread) {
+            SDL_WaitThread(jobs[i].thread, NULL);
+            jobs[i].thread = NULL;
+        }
+    }
+}
@@ -0,0 +1,41 @@
+// src/Resources.h
+#ifndef RESOURCES_H
+#define RESOURCES_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <SDL2/SDL.h>
+
+#define RESOURCE_PROBE_FILE "Pawn_white.png" // Marks a directory as the res directory
+#define MAX_RESOURCE_TIMINGS 64      // Assets whose load time is kept for the report
+#define MAX_RESOURCE_JOBS 8
+
+// Find the res directory: beside the executable's directory (../res from src/ or a build
+// directory), inside it, or else relative to the working directory as before.
+// Call once, before any thread asks for a path.
+void initResourcePaths(void);
+
+// Full path of an asset given relative to res/, e.g. "sfx/capture.mp3"
+void resourcePath(const char* relative, char* path, size_t size);
+
+// Note how long an asset took since startCounter (an SDL_GetPerformanceCounter value) and
+// count it towards the loading progress; safe from any thread
+void recordResourceTiming(const char* name, Uint64 startCounter, bool loaded);
+
+// Every asset timed so far, slowest first
+void printResourceTimings(void);
+
+// Background loading. Each job runs on a thread of its own and is expected to record
+// 'assets' timings. Returns the job's id, or -1 when it ran on the calling thread instead.
+int startResourceJob(const char* name, SDL_ThreadFunction job, void* data, int assets);
+
+bool isResourceJobDone(int id);
+bool resourceJobsDone(void);
+
+// Fraction of the assets of all started jobs loaded so far
+float resourceProgress(void);
+
+// Wait for every job; what they produced may be used once this returns
+void waitForResourceJobs(void);
+
+#endif // RESOURCES_H
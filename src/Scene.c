@@ -0,0 +1,54 @@
+// src/Scene.c
+#include "Scene.h"
+#include <stdio.h>
+
+bool initScene(Scene* scene, SDL_Renderer* renderer, int width, int height) {
+    scene->staticLayer = NULL;
+    scene->dirty = SCENE_ALL;
+
+    if (!SDL_RenderTargetSupported(renderer)) {
+        printf("Render targets not supported, redrawing the whole window on every change\n");
+        return false;
+    }
+    scene->staticLayer = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, width, height);
+    if (!scene->staticLayer) {
+        printf("Static layer creation failed: %s\n", SDL_GetError());
+        return false;
+    }
+    return true;
+}
+
+void destroyScene(Scene* scene) {
+    if (scene->staticLayer) {
+        SDL_DestroyTexture(scene->staticLayer);
+        scene->staticLayer = NULL;
+    }
+}
+
+void invalidateScene(Scene* scene, Uint32 parts) {
+    scene->dirty |= parts;
+}
+
+void beginStaticRegion(Scene* scene, SDL_Renderer* renderer, const SDL_Rect* region) {
+    if (scene->staticLayer) {
+        SDL_SetRenderTarget(renderer, scene->staticLayer);
+    }
+    SDL_RenderSetClipRect(renderer, region);
+}
+
+void endStaticRegion(Scene* scene, SDL_Renderer* renderer) {
+    SDL_RenderSetClipRect(renderer, NULL);
+    if (scene->staticLayer) {
+        SDL_SetRenderTarget(renderer, NULL);
+    }
+}
+
+void drawStaticLayer(Scene* scene, SDL_Renderer* renderer) {
+    if (scene->staticLayer) {
+        SDL_RenderCopy(renderer, scene->staticLayer, NULL, NULL);
+    }
+}
+
+void markScenePresented(Scene* scene) {
+    scene->dirty = 0;
+}
@@ -0,0 +1,50 @@
+// src/Scene.h
+#ifndef SCENE_H
+#define SCENE_H
+
+#include <stdbool.h>
+#include <SDL2/SDL.h>
+
+// Parts of the window; each is redrawn only after something invalidates it
+enum {
+    SCENE_BOARD = 1 << 0,        // Squares and move highlights
+    SCENE_PIECES = 1 << 1,       // Pieces on the board and the captured ones beside it
+    SCENE_TIMERS = 1 << 2,
+    SCENE_HISTORY = 1 << 3,      // Move list
+    SCENE_EXPLORER = 1 << 4,
+    SCENE_EVALUATION = 1 << 5,   // Evaluation bar and game status line
+    SCENE_ANALYSIS = 1 << 6,
+    SCENE_OVERLAY = 1 << 7,      // Menu and filename prompt
+    SCENE_ALL = (1 << 8) - 1
+};
+
+// Everything a move can change
+#define SCENE_POSITION (SCENE_BOARD | SCENE_PIECES | SCENE_HISTORY | SCENE_EXPLORER | SCENE_EVALUATION | SCENE_ANALYSIS)
+
+// Parts kept in the static layer; the rest is drawn over it on every present
+#define SCENE_STATIC_PARTS (SCENE_BOARD | SCENE_PIECES | SCENE_HISTORY | SCENE_EXPLORER)
+
+// Retained rendering: the board and sidebars live in a window-sized render target that is only
+// redrawn region by region as they change, and nothing is presented while nothing is dirty.
+typedef struct {
+    SDL_Texture* staticLayer;    // NULL without render target support: static parts are then redrawn every present
+    Uint32 dirty;                // SCENE_* parts changed since the last present
+} Scene;
+
+// Everything starts dirty. Returns false when the static layer couldn't be created;
+// the scene still works, it just redraws more.
+bool initScene(Scene* scene, SDL_Renderer* renderer, int width, int height);
+void destroyScene(Scene* scene);
+
+void invalidateScene(Scene* scene, Uint32 parts);
+
+// Draw into the static layer, clipped to region, until endStaticRegion. Without a layer
+// this draws straight to the window, so the static parts must then follow the clear.
+void beginStaticRegion(Scene* scene, SDL_Renderer* renderer, const SDL_Rect* region);
+void endStaticRegion(Scene* scene, SDL_Renderer* renderer);
+
+// Copy the static layer to the window; the dynamic parts go on top, then present and markScenePresented
+void drawStaticLayer(Scene* scene, SDL_Renderer* renderer);
+void markScenePresented(Scene* scene);
+
+#endif // SCENE_H
@@ -0,0 +1,64 @@
+// src/SearchThread.c
+#include "SearchThread.h"
+#include <stdio.h>
+#include <string.h>
+
+static int searchThreadMain(void* data) {
+    SearchThread* search = data;
+    search->result = searchPosition(search->board, search->color, &search->lastDoublePawn, search->kings,
+                                    &search->history, &search->limits);
+    SDL_AtomicSet(&search->finished, 1);
+    return 0;
+}
+
+bool startSearchThread(SearchThread* search, unsigned char board[8][8], unsigned char color, Vector2f* lastDoublePawn,
+                       Vector2f kings[], const PositionHistory* history, SearchLimits limits) {
+    if (search->thread) {
+        fprintf(stderr, "Error: A search is already running\n");
+        return false;
+    }
+
+    memcpy(search->board, board, sizeof(search->board));
+    search->color = color;
+    search->lastDoublePawn = *lastDoublePawn;
+    search->kings[0] = kings[0];
+    search->kings[1] = kings[1];
+    if (history) {
+        search->history = *history;
+    } else {
+        search->history.count = 0;
+        search->history.halfmoveClock = 0;
+    }
+    search->limits = limits;
+    search->limits.stop = &search->stop;
+
+    SDL_AtomicSet(&search->stop, 0);
+    SDL_AtomicSet(&search->finished, 0);
+    search->thread = SDL_CreateThreadWithStackSize(searchThreadMain, "search", SEARCH_STACK_SIZE, search);
+    if (!search->thread) {
+        fprintf(stderr, "Error: Could not create search thread: %s\n", SDL_GetError());
+        return false;
+    }
+    return true;
+}
+
+bool isSearchThreadRunning(const SearchThread* search) {
+    return search->thread != NULL;
+}
+
+bool isSearchThreadFinished(SearchThread* search) {
+    return search->thread && SDL_AtomicGet(&search->finished);
+}
+
+SearchResult joinSearchThread(SearchThread* search) {
+    if (search->thread) {
+        SDL_WaitThread(search->thread, NULL);
+        search->thread = NULL;
+    }
+    return search->result;
+}
+
+SearchResult stopSearchThread(SearchThread* search) {
+    SDL_AtomicSet(&search->stop, 1);
+    return joinSearchThread(search);
+}
@@ -0,0 +1,42 @@
+// src/SearchThread.h
+#ifndef SEARCHTHREAD_H
+#define SEARCHTHREAD_H
+
+#include <stdbool.h>
+#include <SDL2/SDL.h>
+#include "engine.h"
+
+// One searchPosition call running on a worker thread.
+// Zero-initialize before first use; at most one search runs per SearchThread.
+typedef struct {
+    SDL_Thread* thread;         // NULL when idle
+    SDL_atomic_t stop;          // Handed to the search as SearchLimits.stop
+    SDL_atomic_t finished;
+
+    // Copied from the caller when the search starts
+    unsigned char board[8][8];
+    unsigned char color;
+    Vector2f lastDoublePawn;
+    Vector2f kings[2];
+    PositionHistory history;
+    SearchLimits limits;
+
+    SearchResult result;        // Valid after joinSearchThread
+} SearchThread;
+
+// Start searching a copy of the position; fails if a search is already running
+bool startSearchThread(SearchThread* search, unsigned char board[8][8], unsigned char color, Vector2f* lastDoublePawn,
+                       Vector2f kings[], const PositionHistory* history, SearchLimits limits);
+
+bool isSearchThreadRunning(const SearchThread* search);
+
+// True once the search has returned (joinSearchThread won't block)
+bool isSearchThreadFinished(SearchThread* search);
+
+// Wait for the search to return and release the thread
+SearchResult joinSearchThread(SearchThread* search);
+
+// Abort the search; returns the deepest completed iteration
+SearchResult stopSearchThread(SearchThread* search);
+
+#endif // SEARCHTHREAD_H
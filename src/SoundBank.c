@@ -0,0 +1,82 @@
+// src/SoundBank.c
+#include "SoundBank.h"
+#include <stdio.h>
+#include <string.h>
+#include <SDL2/SDL_mixer.h>
+#include "Resources.h"
+
+static const char* soundFiles[SOUND_EVENT_COUNT] = {
+    [SOUND_MOVE] = "move-self.mp3",
+    [SOUND_CAPTURE] = "capture.mp3",
+    [SOUND_CASTLE] = "castle.mp3",
+    [SOUND_CHECK] = "move-check.mp3",
+    [SOUND_PROMOTE] = "promote.mp3",
+    [SOUND_GAME_START] = "game-start.mp3",
+    [SOUND_GAME_END] = "notify.mp3",
+};
+
+static Mix_Chunk* sounds[SOUND_EVENT_COUNT];
+static bool audioOpen = false;
+
+AudioConfig defaultAudioConfig(void) {
+    return (AudioConfig){AUDIO_FREQUENCY, AUDIO_BUFFER_SAMPLES, SOUND_CHANNELS};
+}
+
+bool loadSounds(const AudioConfig* config) {
+    if (!(Mix_Init(MIX_INIT_MP3) & MIX_INIT_MP3)) {
+        printf("MP3 support failed to init: %s\n", Mix_GetError());
+    }
+    Uint64 start = SDL_GetPerformanceCounter();
+    if (Mix_OpenAudio(config->frequency, MIX_DEFAULT_FORMAT, 2, config->bufferSamples) < 0) {
+        printf("SDL_mixer failed: %s\n", Mix_GetError());
+        recordResourceTiming("audio device", start, false);
+        return false;
+    }
+    recordResourceTiming("audio device", start, true);
+    audioOpen = true;
+    Mix_AllocateChannels(config->channels);
+
+    // Decoded to the device's format once, here
+    for (int i = 0; i < SOUND_EVENT_COUNT; i++) {
+        char name[64];
+        char path[1100];
+        snprintf(name, sizeof(name), SOUND_DIRECTORY "%s", soundFiles[i]);
+        resourcePath(name, path, sizeof(path));
+        start = SDL_GetPerformanceCounter();
+        sounds[i] = Mix_LoadWAV(path);
+        if (!sounds[i]) {
+            printf("Failed to load sound %s: %s\n", path, Mix_GetError());
+        }
+        recordResourceTiming(name, start, sounds[i] != NULL);
+    }
+    return true;
+}
+
+void playSound(SoundEvent event) {
+    if (audioOpen && (unsigned)event < SOUND_EVENT_COUNT && sounds[event]) {
+        Mix_PlayChannel(-1, sounds[event], 0);
+    }
+}
+
+SoundEvent moveSoundEvent(const char* san, bool gameOver) {
+    if (gameOver) return SOUND_GAME_END;
+    if (strpbrk(san, "+#")) return SOUND_CHECK;
+    if (strchr(san, '=')) return SOUND_PROMOTE;
+    if (strncmp(san, "O-O", 3) == 0) return SOUND_CASTLE;
+    if (strchr(san, 'x')) return SOUND_CAPTURE;
+    return SOUND_MOVE;
+}
+
+void closeSounds(void) {
+    if (!audioOpen) {
+        return;
+    }
+    Mix_HaltChannel(-1);
+    for (int i = 0; i < SOUND_EVENT_COUNT; i++) {
+        if (sounds[i]) Mix_FreeChunk(sounds[i]);
+        sounds[i] = NULL;
+    }
+    Mix_CloseAudio();
+    Mix_Quit();
+    audioOpen = false;
+}
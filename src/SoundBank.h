@@ -0,0 +1,53 @@
+// src/SoundBank.h
+#ifndef SOUNDBANK_H
+#define SOUNDBANK_H
+
+#include <stdbool.h>
+
+#define SOUND_DIRECTORY "sfx/"        // Inside the res directory
+
+// Mixer setup. A small buffer keeps the delay from a move to its sound under a frame:
+// 512 samples at 44.1 kHz is 12 ms, where SDL_mixer's usual 2048 is 46 ms.
+#define AUDIO_FREQUENCY 44100
+#define AUDIO_BUFFER_SAMPLES 512
+#define SOUND_CHANNELS 8             // Sounds that can overlap
+
+typedef enum {
+    SOUND_MOVE,
+    SOUND_CAPTURE,
+    SOUND_CASTLE,
+    SOUND_CHECK,
+    SOUND_PROMOTE,
+    SOUND_GAME_START,
+    SOUND_GAME_END,
+    SOUND_EVENT_COUNT
+} SoundEvent;
+
+typedef struct {
+    int frequency;
+    int bufferSamples;               // Per channel; a power of two
+    int channels;                    // Mixing channels, not speakers
+} AudioConfig;
+
+// AUDIO_FREQUENCY, AUDIO_BUFFER_SAMPLES and SOUND_CHANNELS
+AudioConfig defaultAudioConfig(void);
+
+// Open the mixer and decode every effect into memory, so playing one never touches the disk
+// or the MP3 decoder. Returns false when no audio device opens; the game then plays silently.
+// A clip that fails to load only silences its event. It may run on a loading thread; nothing
+// may be played until it has returned.
+bool loadSounds(const AudioConfig* config);
+
+#define LOADED_SOUND_ASSETS (SOUND_EVENT_COUNT + 1) // Timings loadSounds records: the device, then each clip
+
+// Start the event's sound on a free channel; does nothing without audio
+void playSound(SoundEvent event);
+
+// The sound a move makes, from its SAN: the game end sound when it ended the game,
+// otherwise check, promotion, castling, capture or a plain move, in that order
+SoundEvent moveSoundEvent(const char* san, bool gameOver);
+
+// Free the effects and close the mixer
+void closeSounds(void);
+
+#endif // SOUNDBANK_H
@@ -0,0 +1,187 @@
+// src/TextCache.c
+#include "TextCache.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#define BUCKET_COUNT 512             // Power of two, twice the capacity
+#define NO_ENTRY (-1)
+
+typedef struct {
+    TTF_Font* font;
+    SDL_Color color;
+    char text[TEXT_CACHE_MAX_LENGTH];
+    uint32_t hash;
+    SDL_Texture* texture;
+    int width;
+    int height;
+    int nextInBucket;
+    int newer;                       // Neighbours in the order of use
+    int older;
+} TextCacheEntry;
+
+// One cache for the one renderer the game draws with
+static TextCacheEntry entries[TEXT_CACHE_CAPACITY];
+static int buckets[BUCKET_COUNT];
+static int entryCount = 0;
+static int newest = NO_ENTRY;
+static int oldest = NO_ENTRY;
+static bool bucketsReady = false;
+static SDL_Texture* uncachedTexture = NULL; // The last string too long to cache
+static TextCacheStats stats;
+
+// FNV-1a over the font, the color and the text
+static uint32_t hashKey(TTF_Font* font, SDL_Color color, const char* text) {
+    uint32_t hash = 2166136261u;
+    uintptr_t fontBits = (uintptr_t)font;
+    for (size_t i = 0; i < sizeof(fontBits); i++) {
+        hash = (hash ^ (uint8_t)(fontBits >> (8 * i))) * 16777619u;
+    }
+    uint8_t channels[4] = {color.r, color.g, color.b, color.a};
+    for (int i = 0; i < 4; i++) {
+        hash = (hash ^ channels[i]) * 16777619u;
+    }
+    for (const char* c = text; *c; c++) {
+        hash = (hash ^ (uint8_t)*c) * 16777619u;
+    }
+    return hash;
+}
+
+static void unlinkUse(int index) {
+    TextCacheEntry* entry = &entries[index];
+    if (entry->newer != NO_ENTRY) entries[entry->newer].older = entry->older;
+    else newest = entry->older;
+    if (entry->older != NO_ENTRY) entries[entry->older].newer = entry->newer;
+    else oldest = entry->newer;
+}
+
+static void linkNewest(int index) {
+    entries[index].newer = NO_ENTRY;
+    entries[index].older = newest;
+    if (newest != NO_ENTRY) entries[newest].newer = index;
+    newest = index;
+    if (oldest == NO_ENTRY) oldest = index;
+}
+
+static void removeFromBucket(int index) {
+    int* link = &buckets[entries[index].hash & (BUCKET_COUNT - 1)];
+    while (*link != index) {
+        link = &entries[*link].nextInBucket;
+    }
+    *link = entries[index].nextInBucket;
+}
+
+static SDL_Texture* rasterize(SDL_Renderer* renderer, TTF_Font* font, const char* text, SDL_Color color, int* w, int* h) {
+    SDL_Surface* surface = TTF_RenderText_Blended(font, text, color);
+    if (!surface) {
+        printf("Text render error: %s\n", TTF_GetError());
+        return NULL;
+    }
+    SDL_Texture* texture = SDL_CreateTextureFromSurface(renderer, surface);
+    *w = surface->w;
+    *h = surface->h;
+    SDL_FreeSurface(surface);
+    return texture;
+}
+
+SDL_Texture* getTextTexture(SDL_Renderer* renderer, TTF_Font* font, const char* text, SDL_Color color, int* w, int* h) {
+    if (!font || !text || text[0] == '\0') {
+        return NULL;
+    }
+    int width, height;
+
+    if (strlen(text) >= TEXT_CACHE_MAX_LENGTH) {
+        stats.misses++;
+        if (uncachedTexture) SDL_DestroyTexture(uncachedTexture);
+        uncachedTexture = rasterize(renderer, font, text, color, &width, &height);
+        if (uncachedTexture) {
+            if (w) *w = width;
+            if (h) *h = height;
+        }
+        return uncachedTexture;
+    }
+
+    if (!bucketsReady) {
+        for (int i = 0; i < BUCKET_COUNT; i++) buckets[i] = NO_ENTRY;
+        bucketsReady = true;
+    }
+
+    uint32_t hash = hashKey(font, color, text);
+    for (int i = buckets[hash & (BUCKET_COUNT - 1)]; i != NO_ENTRY; i = entries[i].nextInBucket) {
+        TextCacheEntry* entry = &entries[i];
+        if (entry->hash == hash && entry->font == font && entry->color.r == color.r && entry->color.g == color.g &&
+            entry->color.b == color.b && entry->color.a == color.a && strcmp(entry->text, text) == 0) {
+            stats.hits++;
+            unlinkUse(i);
+            linkNewest(i);
+            if (w) *w = entry->width;
+            if (h) *h = entry->height;
+            return entry->texture;
+        }
+    }
+
+    stats.misses++;
+    SDL_Texture* texture = rasterize(renderer, font, text, color, &width, &height);
+    if (!texture) {
+        return NULL;
+    }
+
+    // Take a free slot, or the least recently used one
+    int index;
+    if (entryCount < TEXT_CACHE_CAPACITY) {
+        index = entryCount++;
+    } else {
+        index = oldest;
+        unlinkUse(index);
+        removeFromBucket(index);
+        SDL_DestroyTexture(entries[index].texture);
+        stats.evictions++;
+    }
+
+    TextCacheEntry* entry = &entries[index];
+    entry->font = font;
+    entry->color = color;
+    strcpy(entry->text, text);
+    entry->hash = hash;
+    entry->texture = texture;
+    entry->width = width;
+    entry->height = height;
+    entry->nextInBucket = buckets[hash & (BUCKET_COUNT - 1)];
+    buckets[hash & (BUCKET_COUNT - 1)] = index;
+    linkNewest(index);
+
+    if (w) *w = width;
+    if (h) *h = height;
+    return texture;
+}
+
+bool drawCachedText(SDL_Renderer* renderer, TTF_Font* font, const char* text, SDL_Color color, int x, int y) {
+    int w, h;
+    SDL_Texture* texture = getTextTexture(renderer, font, text, color, &w, &h);
+    if (!texture) {
+        return false;
+    }
+    SDL_Rect dstRect = {x, y, w, h};
+    SDL_RenderCopy(renderer, texture, NULL, &dstRect);
+    return true;
+}
+
+void clearTextCache(void) {
+    for (int i = 0; i < entryCount; i++) {
+        SDL_DestroyTexture(entries[i].texture);
+    }
+    if (uncachedTexture) {
+        SDL_DestroyTexture(uncachedTexture);
+        uncachedTexture = NULL;
+    }
+    entryCount = 0;
+    newest = NO_ENTRY;
+    oldest = NO_ENTRY;
+    bucketsReady = false;
+}
+
+TextCacheStats getTextCacheStats(void) {
+    TextCacheStats current = stats;
+    current.count = entryCount;
+    return current;
+}
@@ -0,0 +1,32 @@
+// src/TextCache.h
+#ifndef TEXTCACHE_H
+#define TEXTCACHE_H
+
+#include <stdbool.h>
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_ttf.h>
+
+#define TEXT_CACHE_CAPACITY 256      // Textures kept; more than any one frame draws
+#define TEXT_CACHE_MAX_LENGTH 96     // Longer strings are rasterized every time
+
+typedef struct {
+    long long hits;
+    long long misses;                // Each one a rasterization and a texture upload
+    int evictions;
+    int count;                       // Textures held now
+} TextCacheStats;
+
+// Texture of 'text' in 'font' and 'color', rendered once and then reused, least recently used
+// dropped first. The cache owns it; it stays valid until the next call. w and h may be NULL.
+// Fonts used here must stay open until clearTextCache, since entries are keyed by the font pointer.
+SDL_Texture* getTextTexture(SDL_Renderer* renderer, TTF_Font* font, const char* text, SDL_Color color, int* w, int* h);
+
+// Draw text with its top-left corner at (x, y); returns false when nothing could be drawn
+bool drawCachedText(SDL_Renderer* renderer, TTF_Font* font, const char* text, SDL_Color color, int x, int y);
+
+// Destroy every texture; call before closing a font or destroying the renderer
+void clearTextCache(void);
+
+TextCacheStats getTextCacheStats(void);
+
+#endif // TEXTCACHE_H
@@ -4,10 +4,6 @@
 
 #include <SDL2/SDL.h> // For SDL_bool
 
-// --- Constants ---
-#define MAX_MOVES 1024       // Maximum number of moves to store in history
-#define MAX_HISTORY_STATES 200 // Max game states for undo/redo
-
 // Enum for the overall screen state of the application
 typedef enum {
     GAME_STATE_PLAYING,
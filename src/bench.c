@@ -0,0 +1,121 @@
+// src/bench.c
+// Microbenchmark of slider attack lookups: magic bitboards, PEXT (when the CPU has BMI2)
+// and the old ray-by-ray walk, on the same random occupancies.
+//
+// Usage: bench [-n millions of lookups]
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <SDL2/SDL.h>
+
+#include "bitboard.h"
+
+#define OCCUPANCY_COUNT 4096
+
+static Bitboard occupancies[OCCUPANCY_COUNT];
+static int squares[OCCUPANCY_COUNT];
+
+// Ray walk over a bitboard, as the mailbox code did it
+static Bitboard rayAttacks(int square, Bitboard occupied, bool diagonal) {
+    static const int directions[2][4][2] = {
+        {{-1, 0}, {1, 0}, {0, -1}, {0, 1}},
+        {{-1, -1}, {-1, 1}, {1, -1}, {1, 1}}
+    };
+    Bitboard attacks = 0;
+    for (int d = 0; d < 4; d++) {
+        int row = SQUARE_ROW(square) + directions[diagonal][d][0];
+        int col = SQUARE_COL(square) + directions[diagonal][d][1];
+        while (row >= 0 && row < 8 && col >= 0 && col < 8) {
+            attacks |= SQUARE_BIT(SQUARE(row, col));
+            if (occupied & SQUARE_BIT(SQUARE(row, col))) break;
+            row += directions[diagonal][d][0];
+            col += directions[diagonal][d][1];
+        }
+    }
+    return attacks;
+}
+
+static uint64_t nextRandom(uint64_t* state) {
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    return *state;
+}
+
+// Lookups per second for one method; each iteration does a bishop and a rook lookup
+static double timeLookups(long long lookups, bool useRayWalk, Bitboard* checksum) {
+    Bitboard sum = 0;
+    Uint64 start = SDL_GetPerformanceCounter();
+    for (long long i = 0; i < lookups / 2; i++) {
+        int index = (int)(i & (OCCUPANCY_COUNT - 1));
+        if (useRayWalk) {
+            sum ^= rayAttacks(squares[index], occupancies[index], true);
+            sum ^= rayAttacks(squares[index], occupancies[index], false);
+        } else {
+            sum ^= bishopAttacks(squares[index], occupancies[index]);
+            sum ^= rookAttacks(squares[index], occupancies[index]);
+        }
+    }
+    double seconds = (double)(SDL_GetPerformanceCounter() - start) / SDL_GetPerformanceFrequency();
+    *checksum = sum;
+    return lookups / seconds;
+}
+
+// The tables must agree with the ray walk everywhere
+static bool verifyTables() {
+    for (int i = 0; i < OCCUPANCY_COUNT; i++) {
+        if (bishopAttacks(squares[i], occupancies[i]) != rayAttacks(squares[i], occupancies[i], true) ||
+            rookAttacks(squares[i], occupancies[i]) != rayAttacks(squares[i], occupancies[i], false)) {
+            fprintf(stderr, "Error: Attack table mismatch on square %d\n", squares[i]);
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    long long lookups = 100 * 1000000LL;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+            lookups = atoll(argv[++i]) * 1000000LL;
+        } else {
+            printf("Usage: %s [-n millions of lookups]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    // Boards with roughly a game's worth of pieces
+    uint64_t seed = 0x1234567887654321ULL;
+    for (int i = 0; i < OCCUPANCY_COUNT; i++) {
+        occupancies[i] = nextRandom(&seed) & nextRandom(&seed);
+        squares[i] = (int)(nextRandom(&seed) & 63);
+    }
+
+    Bitboard checksum;
+    SliderLookup methods[2] = {SLIDER_LOOKUP_MAGIC, SLIDER_LOOKUP_PEXT};
+    double magicRate = 0.0;
+
+    for (int m = 0; m < 2; m++) {
+        Uint64 start = SDL_GetPerformanceCounter();
+        SliderLookup used = initBitboards(methods[m]);
+        double initMs = 1000.0 * (SDL_GetPerformanceCounter() - start) / SDL_GetPerformanceFrequency();
+        if (used != methods[m]) {
+            printf("%-6s not available on this CPU\n", sliderLookupName(methods[m]));
+            continue;
+        }
+        if (!verifyTables()) {
+            return 1;
+        }
+
+        double rate = timeLookups(lookups, false, &checksum);
+        if (m == 0) magicRate = rate;
+        printf("%-6s %8.1f M lookups/s (init %.1f ms, checksum %016llx)\n", sliderLookupName(used), rate / 1e6, initMs,
+               (unsigned long long)checksum);
+    }
+
+    double rayRate = timeLookups(lookups / 10, true, &checksum);
+    printf("%-6s %8.1f M lookups/s (checksum %016llx)\n", "rays", rayRate / 1e6, (unsigned long long)checksum);
+    printf("magic is %.1fx the ray walk\n", magicRate / rayRate);
+    printf("auto picks %s\n", sliderLookupName(initBitboards(SLIDER_LOOKUP_AUTO)));
+    return 0;
+}
@@ -0,0 +1,374 @@
+// src/bitboard.c
+// Attack tables for bitboard move generation. Slider attacks are looked up either with
+// magic multiplication or, on CPUs with fast BMI2, with the PEXT instruction.
+#include "bitboard.h"
+#include <stdio.h>
+#include <string.h>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define HAVE_PEXT 1
+#include <cpuid.h>
+#include <immintrin.h>
+#endif
+
+Bitboard knightAttackTable[64];
+Bitboard kingAttackTable[64];
+Bitboard pawnAttackTable[2][64];
+Bitboard betweenTable[64][64];
+Bitboard lineTable[64][64];
+
+// Lookup data for one slider on one square
+typedef struct {
+    Bitboard mask;             // Squares whose occupancy matters (board edges excluded)
+    Bitboard magic;
+    int shift;
+    Bitboard* attacks;         // 1 << popCount(mask) entries
+} SliderEntry;
+
+static SliderEntry bishopEntries[64];
+static SliderEntry rookEntries[64];
+static Bitboard bishopTable[5248];
+static Bitboard rookTable[102400];
+static bool usePext = false;
+
+// Magics for this square numbering (row 0 = rank 8), found once with findMagic below
+static const Bitboard bishopMagics[64] = {
+    0x48081010008a2a80ULL, 0x000948110c0b2081ULL, 0x0944140400500000ULL, 0x4984104a00000101ULL,
+    0x4004030818283008ULL, 0x0206012462000121ULL, 0x1a02013008040001ULL, 0x0001008044200440ULL,
+    0x0000312208080880ULL, 0x0220021002009900ULL, 0x8080880801082000ULL, 0x000c11040080102aULL,
+    0x1402440421000210ULL, 0x0010120802080a81ULL, 0x0080084202104028ULL, 0x1100002082082082ULL,
+    0x0008403429080820ULL, 0x8104868204040412ULL, 0x6424084043060030ULL, 0x1108000420401000ULL,
+    0x9004101202020240ULL, 0x0032400608200412ULL, 0x0001009610822080ULL, 0x0008403429080820ULL,
+    0x0008068340104200ULL, 0x0010102858090121ULL, 0x81004c0018080313ULL, 0x4048080004820002ULL,
+    0x000900401c004049ULL, 0x0009420121c1101cULL, 0x4828504005040211ULL, 0x4828504005040211ULL,
+    0x0041041381202000ULL, 0x01008c1005601680ULL, 0x01d010900002040aULL, 0x4040020080080080ULL,
+    0x4801080200802200ULL, 0x4801080200802200ULL, 0x0010046108108080ULL, 0x90409090810a0220ULL,
+    0x8004020242201020ULL, 0x8004020242201020ULL, 0x0202010028020480ULL, 0x0000041144000801ULL,
+    0x00002000a4021080ULL, 0x0504090045040200ULL, 0x8182041102094400ULL, 0x0550008100480101ULL,
+    0xc002080404040400ULL, 0x0382004108292000ULL, 0x12000100a8040020ULL, 0xa005020442088020ULL,
+    0x2000001102020300ULL, 0x000021e0420c8808ULL, 0x3060200484888400ULL, 0x01280101021a0802ULL,
+    0x1030820110010500ULL, 0x0080012608025800ULL, 0x0002810084008800ULL, 0x800080000c208800ULL,
+    0xa408002140028204ULL, 0x0010006020322084ULL, 0x0210401044110050ULL, 0x40106000a1160020ULL
+};
+
+static const Bitboard rookMagics[64] = {
+    0x0480046281400010ULL, 0x80c0200010004000ULL, 0x8780200008300180ULL, 0x8880060800100080ULL,
+    0x2100030010080084ULL, 0x0100040001000802ULL, 0x0200040800810200ULL, 0x0580008002407100ULL,
+    0x1000800080400020ULL, 0x0080401000402001ULL, 0x800c802002100880ULL, 0x800a002200884010ULL,
+    0x2046002008108600ULL, 0x0222009002000804ULL, 0x100b000421001200ULL, 0x0240800100004080ULL,
+    0x4540008020408006ULL, 0x8010054020084002ULL, 0x7d10010100200040ULL, 0x1408008010000882ULL,
+    0x4408010005000810ULL, 0x001e008004000280ULL, 0x0230040001080210ULL, 0x0000020004004081ULL,
+    0x0100400080208001ULL, 0x1000842300400100ULL, 0x1060100080200082ULL, 0x3219004b00100020ULL,
+    0x9010080080800400ULL, 0x8440020080800400ULL, 0x6008010080800200ULL, 0x4123008200010044ULL,
+    0x0280002001400240ULL, 0x0220100040400020ULL, 0x0060801003802008ULL, 0x0008100080800800ULL,
+    0x0105000801001004ULL, 0x100b000803000400ULL, 0x0000024814001021ULL, 0x00408000c2802100ULL,
+    0x4c40004020808002ULL, 0x4410500420024000ULL, 0x00c0100020008080ULL, 0x0000100008008080ULL,
+    0x8002000804220011ULL, 0x0802000804010100ULL, 0x0243100201040008ULL, 0x0000009100420014ULL,
+    0x1000400280022480ULL, 0x0020200040100040ULL, 0x00a000100800c140ULL, 0x0410001408008080ULL,
+    0x0000080004008080ULL, 0x0100020004008080ULL, 0x0303000200040300ULL, 0x1480006104008200ULL,
+    0x00008002204a1101ULL, 0x1040090010224081ULL, 0x4300c0200011000dULL, 0x8002041001002009ULL,
+    0x2005000800020411ULL, 0x110a008408100102ULL, 0x0006000108008402ULL, 0x0200002900884402ULL
+};
+
+static const int bishopDirections[4][2] = {{-1, -1}, {-1, 1}, {1, -1}, {1, 1}};
+static const int rookDirections[4][2] = {{-1, 0}, {1, 0}, {0, -1}, {0, 1}};
+
+static Bitboard bishopAttacksMagic(int square, Bitboard occupied) {
+    const SliderEntry* entry = &bishopEntries[square];
+    return entry->attacks[((occupied & entry->mask) * entry->magic) >> entry->shift];
+}
+
+static Bitboard rookAttacksMagic(int square, Bitboard occupied) {
+    const SliderEntry* entry = &rookEntries[square];
+    return entry->attacks[((occupied & entry->mask) * entry->magic) >> entry->shift];
+}
+
+#ifdef HAVE_PEXT
+__attribute__((target("bmi2")))
+static Bitboard bishopAttacksPext(int square, Bitboard occupied) {
+    const SliderEntry* entry = &bishopEntries[square];
+    return entry->attacks[_pext_u64(occupied, entry->mask)];
+}
+
+__attribute__((target("bmi2")))
+static Bitboard rookAttacksPext(int square, Bitboard occupied) {
+    const SliderEntry* entry = &rookEntries[square];
+    return entry->attacks[_pext_u64(occupied, entry->mask)];
+}
+
+__attribute__((target("bmi2")))
+static unsigned int pextIndex(Bitboard occupied, Bitboard mask) {
+    return (unsigned int)_pext_u64(occupied, mask);
+}
+
+static bool cpuHasBmi2() {
+    unsigned int eax, ebx, ecx, edx;
+    if (__get_cpuid_max(0, NULL) < 7) {
+        return false;
+    }
+    __cpuid_count(7, 0, eax, ebx, ecx, edx);
+    return (ebx & (1u << 8)) != 0;
+}
+
+// AMD before Zen 3 (family 19h) implements PEXT in slow microcode
+static bool cpuHasFastPext() {
+    if (!cpuHasBmi2()) {
+        return false;
+    }
+    unsigned int eax = 0, ebx = 0, ecx = 0, edx = 0;
+    __get_cpuid(0, &eax, &ebx, &ecx, &edx);
+    bool amd = (ebx == 0x68747541); // "Auth"enticAMD
+
+    __get_cpuid(1, &eax, &ebx, &ecx, &edx);
+    int family = ((eax >> 8) & 0xF) + ((eax >> 20) & 0xFF);
+    return !(amd && family < 0x19);
+}
+#endif
+
+// Chosen once by initBitboards
+Bitboard (*bishopAttacks)(int square, Bitboard occupied) = bishopAttacksMagic;
+Bitboard (*rookAttacks)(int square, Bitboard occupied) = rookAttacksMagic;
+
+Bitboard queenAttacks(int square, Bitboard occupied) {
+    return bishopAttacks(square, occupied) | rookAttacks(square, occupied);
+}
+
+// Slow reference: walk each ray until it hits a piece (used to fill the tables)
+static Bitboard slidingAttacks(int square, Bitboard occupied, const int directions[4][2]) {
+    Bitboard attacks = 0;
+    for (int d = 0; d < 4; d++) {
+        int row = SQUARE_ROW(square) + directions[d][0];
+        int col = SQUARE_COL(square) + directions[d][1];
+        while (row >= 0 && row < 8 && col >= 0 && col < 8) {
+            attacks |= SQUARE_BIT(SQUARE(row, col));
+            if (occupied & SQUARE_BIT(SQUARE(row, col))) {
+                break;
+            }
+            row += directions[d][0];
+            col += directions[d][1];
+        }
+    }
+    return attacks;
+}
+
+// Squares on the rays, minus the last square of each ray (its occupancy never changes the attacks)
+static Bitboard relevantOccupancy(int square, const int directions[4][2]) {
+    Bitboard mask = 0;
+    for (int d = 0; d < 4; d++) {
+        int row = SQUARE_ROW(square) + directions[d][0];
+        int col = SQUARE_COL(square) + directions[d][1];
+        while (row + directions[d][0] >= 0 && row + directions[d][0] < 8 &&
+               col + directions[d][1] >= 0 && col + directions[d][1] < 8) {
+            mask |= SQUARE_BIT(SQUARE(row, col));
+            row += directions[d][0];
+            col += directions[d][1];
+        }
+    }
+    return mask;
+}
+
+// xorshift64*; fixed seeds so startup always finds the same magics
+static uint64_t nextRandom(uint64_t* state) {
+    *state ^= *state >> 12;
+    *state ^= *state << 25;
+    *state ^= *state >> 27;
+    return *state * 2685821657736338717ULL;
+}
+
+// Fill the square's table through the magic; fails on a destructive collision
+static bool tryMagic(SliderEntry* entry, Bitboard magic, const Bitboard* occupancies, const Bitboard* attacks, int count) {
+    static int usedBy[4096];
+    static int attempt = 0;
+
+    attempt++;
+    for (int i = 0; i < count; i++) {
+        unsigned int index = (unsigned int)(((occupancies[i] & entry->mask) * magic) >> entry->shift);
+        if (usedBy[index] != attempt) {
+            usedBy[index] = attempt;
+            entry->attacks[index] = attacks[i];
+        } else if (entry->attacks[index] != attacks[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Try sparse random numbers until one works
+static Bitboard findMagic(SliderEntry* entry, const Bitboard* occupancies, const Bitboard* attacks, int count, uint64_t* seed) {
+    for (;;) {
+        Bitboard magic = nextRandom(seed) & nextRandom(seed) & nextRandom(seed);
+        if (popCount((entry->mask * magic) >> 56) >= 6 && tryMagic(entry, magic, occupancies, attacks, count)) {
+            return magic;
+        }
+    }
+}
+
+static void initSliders(SliderEntry* entries, Bitboard* table, const int directions[4][2], const Bitboard* bakedMagics) {
+    // Each square's search starts from its rank's seed (rank 1 first)
+    static const uint64_t seeds[8] = {728, 10316, 55013, 32803, 12281, 15100, 16645, 255};
+    static Bitboard occupancies[4096];
+    static Bitboard attacks[4096];
+    Bitboard* next = table;
+
+    for (int square = 0; square < 64; square++) {
+        SliderEntry* entry = &entries[square];
+        entry->mask = relevantOccupancy(square, directions);
+        entry->shift = 64 - popCount(entry->mask);
+        entry->attacks = next;
+
+        // Every subset of the mask (carry-rippler enumeration)
+        int count = 0;
+        Bitboard subset = 0;
+        do {
+            occupancies[count] = subset;
+            attacks[count] = slidingAttacks(square, subset, directions);
+            count++;
+            subset = (subset - entry->mask) & entry->mask;
+        } while (subset);
+
+#ifdef HAVE_PEXT
+        if (usePext) {
+            entry->magic = 0;
+            for (int i = 0; i < count; i++) {
+                entry->attacks[pextIndex(occupancies[i], entry->mask)] = attacks[i];
+            }
+            next += count;
+            continue;
+        }
+#endif
+        // The baked-in magic only fails if the board layout changes; search for a new one then
+        entry->magic = bakedMagics[square];
+        if (!tryMagic(entry, entry->magic, occupancies, attacks, count)) {
+            uint64_t seed = seeds[7 - SQUARE_ROW(square)];
+            entry->magic = findMagic(entry, occupancies, attacks, count, &seed);
+        }
+        next += count;
+    }
+}
+
+static void initLeapers() {
+    static const int knightSteps[8][2] = {{-2, -1}, {-2, 1}, {-1, -2}, {-1, 2}, {1, -2}, {1, 2}, {2, -1}, {2, 1}};
+    static const int kingSteps[8][2] = {{-1, -1}, {-1, 0}, {-1, 1}, {0, -1}, {0, 1}, {1, -1}, {1, 0}, {1, 1}};
+
+    for (int square = 0; square < 64; square++) {
+        int row = SQUARE_ROW(square), col = SQUARE_COL(square);
+        knightAttackTable[square] = 0;
+        kingAttackTable[square] = 0;
+        pawnAttackTable[0][square] = 0;
+        pawnAttackTable[1][square] = 0;
+
+        for (int i = 0; i < 8; i++) {
+            int r = row + knightSteps[i][0], c = col + knightSteps[i][1];
+            if (r >= 0 && r < 8 && c >= 0 && c < 8) knightAttackTable[square] |= SQUARE_BIT(SQUARE(r, c));
+            r = row + kingSteps[i][0];
+            c = col + kingSteps[i][1];
+            if (r >= 0 && r < 8 && c >= 0 && c < 8) kingAttackTable[square] |= SQUARE_BIT(SQUARE(r, c));
+        }
+
+        // White pawns move towards row 0, black pawns towards row 7
+        for (int side = -1; side <= 1; side += 2) {
+            int c = col + side;
+            if (c < 0 || c > 7) continue;
+            if (row > 0) pawnAttackTable[0][square] |= SQUARE_BIT(SQUARE(row - 1, c));
+            if (row < 7) pawnAttackTable[1][square] |= SQUARE_BIT(SQUARE(row + 1, c));
+        }
+    }
+}
+
+// Needs the slider lookups
+static void initLines() {
+    for (int a = 0; a < 64; a++) {
+        for (int b = 0; b < 64; b++) {
+            betweenTable[a][b] = 0;
+            lineTable[a][b] = 0;
+            if (a == b) continue;
+
+            if (bishopAttacks(a, 0) & SQUARE_BIT(b)) {
+                betweenTable[a][b] = bishopAttacks(a, SQUARE_BIT(b)) & bishopAttacks(b, SQUARE_BIT(a));
+                lineTable[a][b] = (bishopAttacks(a, 0) & bishopAttacks(b, 0)) | SQUARE_BIT(a) | SQUARE_BIT(b);
+            } else if (rookAttacks(a, 0) & SQUARE_BIT(b)) {
+                betweenTable[a][b] = rookAttacks(a, SQUARE_BIT(b)) & rookAttacks(b, SQUARE_BIT(a));
+                lineTable[a][b] = (rookAttacks(a, 0) & rookAttacks(b, 0)) | SQUARE_BIT(a) | SQUARE_BIT(b);
+            }
+        }
+    }
+}
+
+SliderLookup initBitboards(SliderLookup method) {
+    usePext = false;
+#ifdef HAVE_PEXT
+    if (method == SLIDER_LOOKUP_AUTO) {
+        usePext = cpuHasFastPext();
+    } else if (method == SLIDER_LOOKUP_PEXT) {
+        usePext = cpuHasBmi2(); // Slow PEXT still works when asked for explicitly
+    }
+#endif
+
+    initLeapers();
+    initSliders(bishopEntries, bishopTable, bishopDirections, bishopMagics);
+    initSliders(rookEntries, rookTable, rookDirections, rookMagics);
+
+    bishopAttacks = bishopAttacksMagic;
+    rookAttacks = rookAttacksMagic;
+#ifdef HAVE_PEXT
+    if (usePext) {
+        bishopAttacks = bishopAttacksPext;
+        rookAttacks = rookAttacksPext;
+    }
+#endif
+    initLines();
+    return usePext ? SLIDER_LOOKUP_PEXT : SLIDER_LOOKUP_MAGIC;
+}
+
+const char* sliderLookupName(SliderLookup method) {
+    switch (method) {
+        case SLIDER_LOOKUP_PEXT: return "PEXT";
+        case SLIDER_LOOKUP_MAGIC: return "magic";
+        default: return "auto";
+    }
+}
+
+void loadBitboards(unsigned char board[8][8], BoardBitboards* bb) {
+    memset(bb, 0, sizeof(*bb));
+    for (int square = 0; square < 64; square++) {
+        unsigned char piece = board[SQUARE_ROW(square)][SQUARE_COL(square)];
+        if ((piece & TYPE_MASK) == NONE) continue;
+        int color = (piece & COLOR_MASK) >> 4;
+        bb->pieces[color][piece & TYPE_MASK] |= SQUARE_BIT(square);
+        bb->colors[color] |= SQUARE_BIT(square);
+    }
+    bb->occupied = bb->colors[0] | bb->colors[1];
+}
+
+Bitboard attackersTo(const BoardBitboards* bb, int square, Bitboard occupied) {
+    Bitboard diagonal = bb->pieces[0][BISHOP] | bb->pieces[1][BISHOP] | bb->pieces[0][QUEEN] | bb->pieces[1][QUEEN];
+    Bitboard straight = bb->pieces[0][ROOK] | bb->pieces[1][ROOK] | bb->pieces[0][QUEEN] | bb->pieces[1][QUEEN];
+
+    // A white pawn attacks the square if a black pawn standing there would attack it, and vice versa
+    return (pawnAttackTable[1][square] & bb->pieces[0][PAWN]) |
+           (pawnAttackTable[0][square] & bb->pieces[1][PAWN]) |
+           (knightAttackTable[square] & (bb->pieces[0][KNIGHT] | bb->pieces[1][KNIGHT])) |
+           (kingAttackTable[square] & (bb->pieces[0][KING] | bb->pieces[1][KING])) |
+           (bishopAttacks(square, occupied) & diagonal) |
+           (rookAttacks(square, occupied) & straight);
+}
+
+bool isSquareAttackedBB(const BoardBitboards* bb, int square, unsigned char attackerColor) {
+    const Bitboard* attacker = bb->pieces[attackerColor];
+    if ((pawnAttackTable[attackerColor ^ 1][square] & attacker[PAWN]) ||
+        (knightAttackTable[square] & attacker[KNIGHT]) ||
+        (kingAttackTable[square] & attacker[KING])) {
+        return true;
+    }
+    return (bishopAttacks(square, bb->occupied) & (attacker[BISHOP] | attacker[QUEEN])) ||
+           (rookAttacks(square, bb->occupied) & (attacker[ROOK] | attacker[QUEEN]));
+}
+
+Bitboard attackersOfColor(const BoardBitboards* bb, int square, unsigned char attackerColor, Bitboard occupied) {
+    const Bitboard* attacker = bb->pieces[attackerColor];
+    return (pawnAttackTable[attackerColor ^ 1][square] & attacker[PAWN]) |
+           (knightAttackTable[square] & attacker[KNIGHT]) |
+           (kingAttackTable[square] & attacker[KING]) |
+           (bishopAttacks(square, occupied) & (attacker[BISHOP] | attacker[QUEEN])) |
+           (rookAttacks(square, occupied) & (attacker[ROOK] | attacker[QUEEN]));
+}
@@ -0,0 +1,72 @@
+// src/bitboard.h
+#ifndef BITBOARD_H
+#define BITBOARD_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "Piece.h"
+
+// Bit n of a bitboard is square n = row * 8 + col, matching board[row][col] (row 0 = rank 8)
+typedef uint64_t Bitboard;
+
+#define SQUARE(row, col) ((row) * 8 + (col))
+#define SQUARE_ROW(square) ((square) >> 3)
+#define SQUARE_COL(square) ((square) & 7)
+#define SQUARE_BIT(square) (1ULL << (square))
+
+// How slider attacks are looked up
+typedef enum {
+    SLIDER_LOOKUP_AUTO,        // PEXT when the CPU has BMI2, magic multiplication otherwise
+    SLIDER_LOOKUP_MAGIC,
+    SLIDER_LOOKUP_PEXT
+} SliderLookup;
+
+// The mailbox board as bitboards, built once per position
+typedef struct {
+    Bitboard pieces[2][7];     // [color][piece type]
+    Bitboard colors[2];
+    Bitboard occupied;
+} BoardBitboards;
+
+extern Bitboard knightAttackTable[64];
+extern Bitboard kingAttackTable[64];
+extern Bitboard pawnAttackTable[2][64]; // Squares a pawn of that color on the square attacks
+extern Bitboard betweenTable[64][64];   // Squares strictly between two squares on a line, else empty
+extern Bitboard lineTable[64][64];      // The whole line through two squares on a line, else empty
+
+// Build the attack tables; returns the method actually in use (PEXT falls back to magic without BMI2)
+SliderLookup initBitboards(SliderLookup method);
+const char* sliderLookupName(SliderLookup method);
+
+// Point at the magic or PEXT lookup, whichever initBitboards picked
+extern Bitboard (*bishopAttacks)(int square, Bitboard occupied);
+extern Bitboard (*rookAttacks)(int square, Bitboard occupied);
+Bitboard queenAttacks(int square, Bitboard occupied);
+
+void loadBitboards(unsigned char board[8][8], BoardBitboards* bb);
+
+// Pieces of either color attacking the square
+Bitboard attackersTo(const BoardBitboards* bb, int square, Bitboard occupied);
+
+bool isSquareAttackedBB(const BoardBitboards* bb, int square, unsigned char attackerColor);
+
+// Pieces of one color attacking the square with the given occupancy
+Bitboard attackersOfColor(const BoardBitboards* bb, int square, unsigned char attackerColor, Bitboard occupied);
+
+static inline int popCount(Bitboard b) {
+    return __builtin_popcountll(b);
+}
+
+// Index of the lowest set bit (b must not be empty)
+static inline int lowestSquare(Bitboard b) {
+    return __builtin_ctzll(b);
+}
+
+// Remove and return the lowest set bit's square
+static inline int popLowestSquare(Bitboard* b) {
+    int square = __builtin_ctzll(*b);
+    *b &= *b - 1;
+    return square;
+}
+
+#endif // BITBOARD_H
@@ -0,0 +1,835 @@
+// src/database.c
+#include "database.h"
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#define GAMES_MAGIC "CHESSDB"
+#define INDEX_MAGIC "CHESSIDX"
+#define TREE_MAGIC "CHESSOPN"
+#define GAMES_HEADER_SIZE 16         // Magic, version, reserved
+#define GAME_HEADER_SIZE 5           // Plies (16 bits), bytes of moves (16 bits), result
+#define MAX_MOVE_BITS 11             // 4 for the piece (16 at most), 5 for the target (27 at most), 2 for the promotion
+#define MAX_GAME_BYTES ((DATABASE_MAX_PLIES * MAX_MOVE_BITS + 7) / 8)
+#define WRITE_CHUNK 4096             // Postings written at a time while merging
+
+// Header of <name>.idx, followed by uint64_t offsets[gameCount] and DatabasePosting postings[postingCount]
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t gameCount;
+    uint64_t postingCount;
+    uint64_t gamesSize;          // Size of the games file the index was built for
+} IndexHeader;
+
+// Header of an opening tree, followed by OpeningEntry entries[entryCount]
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t maxPlies;
+    uint64_t entryCount;
+    uint64_t reserved;
+} TreeHeader;
+
+// One move of one game, while a tree is being built
+typedef struct {
+    uint64_t key;
+    uint16_t move;
+    uint8_t result;
+} OpeningSample;
+
+/*==========
+Memory-mapped files
+==========*/
+static bool mapFile(MappedFile* mapped, const char* path) {
+    memset(mapped, 0, sizeof(*mapped));
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) return false;
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size)) {
+        CloseHandle(file);
+        return false;
+    }
+    mapped->size = (size_t)size.QuadPart;
+    if (mapped->size == 0) {
+        mapped->file = file;
+        return true;
+    }
+
+    HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (!mapping) {
+        CloseHandle(file);
+        return false;
+    }
+    mapped->data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!mapped->data) {
+        CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+    mapped->file = file;
+    mapped->mapping = mapping;
+#else
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return false;
+    struct stat info;
+    if (fstat(fd, &info) != 0) {
+        close(fd);
+        return false;
+    }
+    mapped->size = (size_t)info.st_size;
+    if (mapped->size > 0) {
+        void* data = mmap(NULL, mapped->size, PROT_READ, MAP_SHARED, fd, 0);
+        if (data == MAP_FAILED) {
+            close(fd);
+            return false;
+        }
+        mapped->data = data;
+    }
+    // The mapping stays valid without the descriptor
+    close(fd);
+#endif
+    return true;
+}
+
+static void unmapFile(MappedFile* mapped) {
+#ifdef _WIN32
+    if (mapped->data) UnmapViewOfFile(mapped->data);
+    if (mapped->mapping) CloseHandle(mapped->mapping);
+    if (mapped->file) CloseHandle(mapped->file);
+#else
+    if (mapped->data) munmap((void*)mapped->data, mapped->size);
+#endif
+    memset(mapped, 0, sizeof(*mapped));
+}
+
+/*==========
+Byte and bit streams
+==========*/
+static void putU16(unsigned char* bytes, unsigned value) {
+    bytes[0] = (unsigned char)(value & 0xff);
+    bytes[1] = (unsigned char)(value >> 8);
+}
+
+static unsigned getU16(const unsigned char* bytes) {
+    return bytes[0] | (bytes[1] << 8);
+}
+
+static void writeBits(unsigned char* bytes, size_t* bit, unsigned value, int count) {
+    for (int i = 0; i < count; i++, (*bit)++) {
+        if (value & (1u << i)) {
+            bytes[*bit >> 3] |= (unsigned char)(1u << (*bit & 7));
+        }
+    }
+}
+
+// -1 when the read would run past the end
+static int readBits(const unsigned char* bytes, size_t byteCount, size_t* bit, int count) {
+    if (*bit + count > byteCount * 8) return -1;
+    int value = 0;
+    for (int i = 0; i < count; i++, (*bit)++) {
+        if (bytes[*bit >> 3] & (1u << (*bit & 7))) {
+            value |= 1 << i;
+        }
+    }
+    return value;
+}
+
+// Bits needed to tell 'choices' options apart
+static int bitsFor(int choices) {
+    int bits = 0;
+    while ((1 << bits) < choices) bits++;
+    return bits;
+}
+
+// Square of the n-th (from 0) set bit
+static int nthSquare(Bitboard b, int n) {
+    while (n-- > 0) b &= b - 1;
+    return lowestSquare(b);
+}
+
+/*==========
+Replaying games: moves are coded against the legal moves, so both sides walk the game
+==========*/
+typedef struct {
+    unsigned char board[8][8];
+    Vector2f kings[2];
+    Vector2f lastDoublePawn;
+    unsigned char color;
+    MoveGenContext gen;
+    Bitboard movers;             // Pieces of the side to move with a legal move
+    Bitboard destinations[64];
+} Replay;
+
+void loadStartPosition(unsigned char board[8][8], Vector2f kings[2], Vector2f* lastDoublePawn) {
+    bool blackTurn;
+    loadFEN(START_FEN, board, &blackTurn, lastDoublePawn);
+    findKings(board, kings);
+}
+
+static void findMovers(Replay* replay) {
+    initMoveGen(&replay->gen, replay->board, replay->color, &replay->lastDoublePawn);
+    replay->movers = 0;
+    Bitboard own = replay->gen.bb.colors[replay->color];
+    while (own) {
+        int square = popLowestSquare(&own);
+        replay->destinations[square] = legalDestinations(&replay->gen, replay->board, square);
+        if (replay->destinations[square]) {
+            replay->movers |= SQUARE_BIT(square);
+        }
+    }
+}
+
+static void startReplay(Replay* replay) {
+    loadStartPosition(replay->board, replay->kings, &replay->lastDoublePawn);
+    replay->color = 0;
+    findMovers(replay);
+}
+
+static uint64_t replayKey(Replay* replay) {
+    return hashPosition(replay->board, replay->color, &replay->lastDoublePawn);
+}
+
+static EngineMove playReplayMove(Replay* replay, int from, int to, unsigned char promotionType) {
+    EngineMove move = createEngineMove(&replay->gen, replay->board, from, to, promotionType);
+    engineMakeMove(replay->board, move, &replay->lastDoublePawn, replay->kings, 0);
+    replay->color ^= 1;
+    findMovers(replay);
+    return move;
+}
+
+// Decode one game record; recordSize gets the bytes it takes. Returns the plies, -1 if corrupt.
+static int decodeGame(const unsigned char* data, size_t available, size_t* recordSize, EngineMove* moves,
+                      DatabaseResult* result) {
+    if (available < GAME_HEADER_SIZE) return -1;
+    int plyCount = (int)getU16(data);
+    size_t byteCount = getU16(data + 2);
+    if (plyCount > DATABASE_MAX_PLIES || data[4] > DB_RESULT_DRAW || available < GAME_HEADER_SIZE + byteCount) {
+        return -1;
+    }
+    *result = (DatabaseResult)data[4];
+    *recordSize = GAME_HEADER_SIZE + byteCount;
+
+    const unsigned char* bits = data + GAME_HEADER_SIZE;
+    size_t bit = 0;
+    Replay replay;
+    startReplay(&replay);
+    for (int ply = 0; ply < plyCount; ply++) {
+        int moverCount = popCount(replay.movers);
+        int pieceIndex = readBits(bits, byteCount, &bit, bitsFor(moverCount));
+        if (pieceIndex < 0 || pieceIndex >= moverCount) return -1;
+        int from = nthSquare(replay.movers, pieceIndex);
+
+        int targetCount = popCount(replay.destinations[from]);
+        int targetIndex = readBits(bits, byteCount, &bit, bitsFor(targetCount));
+        if (targetIndex < 0 || targetIndex >= targetCount) return -1;
+        int to = nthSquare(replay.destinations[from], targetIndex);
+
+        unsigned char promotionType = NONE;
+        bool isPawn = (replay.board[SQUARE_ROW(from)][SQUARE_COL(from)] & TYPE_MASK) == PAWN;
+        if (isPawn && (SQUARE_ROW(to) == 0 || SQUARE_ROW(to) == 7)) {
+            int promotion = readBits(bits, byteCount, &bit, 2);
+            if (promotion < 0) return -1;
+            promotionType = (unsigned char)(BISHOP + promotion);
+        }
+        moves[ply] = playReplayMove(&replay, from, to, promotionType);
+    }
+    return plyCount;
+}
+
+/*==========
+Reading
+==========*/
+static bool checkGamesHeader(const MappedFile* games, const char* path) {
+    if (games->size < GAMES_HEADER_SIZE || memcmp(games->data, GAMES_MAGIC, 8) != 0) {
+        fprintf(stderr, "Error: %s is not a game database\n", path);
+        return false;
+    }
+    if (games->data[8] != DATABASE_VERSION) {
+        fprintf(stderr, "Error: %s has unsupported version %d\n", path, games->data[8]);
+        return false;
+    }
+    return true;
+}
+
+static char* indexPath(const char* path) {
+    char* result = malloc(strlen(path) + 5);
+    if (result) {
+        strcpy(result, path);
+        strcat(result, ".idx");
+    }
+    return result;
+}
+
+// The index fits the games file as it is now
+static bool isIndexCurrent(const MappedFile* index, const MappedFile* games) {
+    if (index->size < sizeof(IndexHeader)) return false;
+    IndexHeader header;
+    memcpy(&header, index->data, sizeof(header));
+    return memcmp(header.magic, INDEX_MAGIC, 8) == 0 && header.version == DATABASE_VERSION &&
+           header.gamesSize == games->size &&
+           index->size == sizeof(IndexHeader) + header.gameCount * sizeof(uint64_t) +
+                              header.postingCount * sizeof(DatabasePosting);
+}
+
+bool openGameDatabase(GameDatabase* db, const char* path) {
+    memset(db, 0, sizeof(*db));
+    if (!mapFile(&db->games, path)) {
+        fprintf(stderr, "Error: Cannot open database %s\n", path);
+        return false;
+    }
+    if (!checkGamesHeader(&db->games, path)) {
+        unmapFile(&db->games);
+        return false;
+    }
+
+    char* idxPath = indexPath(path);
+    bool mapped = idxPath && mapFile(&db->index, idxPath);
+    free(idxPath);
+    if (!mapped || !isIndexCurrent(&db->index, &db->games)) {
+        fprintf(stderr, "Error: The index of %s is missing or out of date; rebuild it with gamedb index\n", path);
+        closeGameDatabase(db);
+        return false;
+    }
+
+    IndexHeader header;
+    memcpy(&header, db->index.data, sizeof(header));
+    db->gameCount = header.gameCount;
+    db->gameOffsets = (const uint64_t*)(db->index.data + sizeof(IndexHeader));
+    db->postings = (const DatabasePosting*)(db->gameOffsets + header.gameCount);
+    db->postingCount = header.postingCount;
+    return true;
+}
+
+void closeGameDatabase(GameDatabase* db) {
+    unmapFile(&db->games);
+    unmapFile(&db->index);
+    memset(db, 0, sizeof(*db));
+}
+
+const DatabasePosting* findPosition(const GameDatabase* db, uint64_t key, size_t* count) {
+    // First posting with this key
+    uint64_t low = 0, high = db->postingCount;
+    while (low < high) {
+        uint64_t middle = low + (high - low) / 2;
+        if (db->postings[middle].key < key) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+
+    uint64_t end = low;
+    while (end < db->postingCount && db->postings[end].key == key) {
+        end++;
+    }
+    *count = (size_t)(end - low);
+    return *count ? &db->postings[low] : NULL;
+}
+
+int readDatabaseGame(const GameDatabase* db, uint32_t game, EngineMove* moves, DatabaseResult* result) {
+    if (game >= db->gameCount || db->gameOffsets[game] >= db->games.size) {
+        return -1;
+    }
+    size_t recordSize;
+    uint64_t offset = db->gameOffsets[game];
+    return decodeGame(db->games.data + offset, db->games.size - offset, &recordSize, moves, result);
+}
+
+/*==========
+Writing
+==========*/
+static bool addPosting(DatabaseWriter* writer, uint64_t key, uint32_t game, int ply) {
+    if (writer->newPostingCount == writer->newPostingCapacity) {
+        size_t capacity = writer->newPostingCapacity ? writer->newPostingCapacity * 2 : 65536;
+        DatabasePosting* postings = realloc(writer->newPostings, capacity * sizeof(DatabasePosting));
+        if (!postings) {
+            fprintf(stderr, "Error: Out of memory indexing games\n");
+            return false;
+        }
+        writer->newPostings = postings;
+        writer->newPostingCapacity = capacity;
+    }
+    DatabasePosting posting = {key, game, (uint16_t)ply, 0};
+    writer->newPostings[writer->newPostingCount++] = posting;
+    return true;
+}
+
+static bool addGameOffset(DatabaseWriter* writer, uint64_t offset) {
+    uint32_t added = writer->gameCount - writer->firstNewGame;
+    // Grow in powers of two
+    if ((added & (added - 1)) == 0) {
+        uint64_t* offsets = realloc(writer->newOffsets, (added ? added * 2 : 1024) * sizeof(uint64_t));
+        if (!offsets) {
+            fprintf(stderr, "Error: Out of memory indexing games\n");
+            return false;
+        }
+        writer->newOffsets = offsets;
+    }
+    writer->newOffsets[added] = offset;
+    writer->gameCount++;
+    return true;
+}
+
+// Walk the game, collecting its positions and, when bits is not NULL, encoding its moves
+static bool indexGame(DatabaseWriter* writer, const EngineMove* moves, int plyCount, unsigned char* bits,
+                      size_t* bitCount) {
+    uint32_t game = writer->gameCount;
+    size_t firstPosting = writer->newPostingCount;
+    Replay replay;
+    startReplay(&replay);
+    if (!addPosting(writer, replayKey(&replay), game, 0)) return false;
+
+    for (int ply = 0; ply < plyCount; ply++) {
+        int from = SQUARE(moves[ply].from.x, moves[ply].from.y);
+        int to = SQUARE(moves[ply].to.x, moves[ply].to.y);
+        if (!(replay.movers & SQUARE_BIT(from)) || !(replay.destinations[from] & SQUARE_BIT(to))) {
+            writer->newPostingCount = firstPosting;
+            return false;
+        }
+        unsigned char promotionType = NONE;
+        bool isPawn = (replay.board[SQUARE_ROW(from)][SQUARE_COL(from)] & TYPE_MASK) == PAWN;
+        bool promotes = isPawn && (SQUARE_ROW(to) == 0 || SQUARE_ROW(to) == 7);
+        if (promotes) {
+            promotionType = moves[ply].isPromotion ? (moves[ply].promotionPiece & TYPE_MASK) : QUEEN;
+            if (promotionType < BISHOP || promotionType > QUEEN) {
+                writer->newPostingCount = firstPosting;
+                return false;
+            }
+        }
+
+        if (bits) {
+            writeBits(bits, bitCount, (unsigned)popCount(replay.movers & (SQUARE_BIT(from) - 1)),
+                      bitsFor(popCount(replay.movers)));
+            writeBits(bits, bitCount, (unsigned)popCount(replay.destinations[from] & (SQUARE_BIT(to) - 1)),
+                      bitsFor(popCount(replay.destinations[from])));
+            if (promotes) {
+                writeBits(bits, bitCount, promotionType - BISHOP, 2);
+            }
+        }
+
+        playReplayMove(&replay, from, to, promotionType);
+        if (!addPosting(writer, replayKey(&replay), game, ply + 1)) return false;
+    }
+    return true;
+}
+
+static bool writeGamesHeader(FILE* file) {
+    unsigned char header[GAMES_HEADER_SIZE] = {0};
+    memcpy(header, GAMES_MAGIC, 8);
+    header[8] = DATABASE_VERSION;
+    return fwrite(header, 1, sizeof(header), file) == sizeof(header);
+}
+
+// Index every game in the file from scratch (the index was missing or stale)
+static bool reindexGames(DatabaseWriter* writer, const MappedFile* games) {
+    EngineMove* moves = malloc(DATABASE_MAX_PLIES * sizeof(EngineMove));
+    if (!moves) return false;
+
+    uint64_t offset = GAMES_HEADER_SIZE;
+    while (offset < games->size) {
+        size_t recordSize;
+        DatabaseResult result;
+        int plyCount = decodeGame(games->data + offset, games->size - offset, &recordSize, moves, &result);
+        if (plyCount < 0 || !indexGame(writer, moves, plyCount, NULL, NULL) || !addGameOffset(writer, offset)) {
+            fprintf(stderr, "Error: Game %u of %s is corrupt\n", writer->gameCount, writer->path);
+            free(moves);
+            return false;
+        }
+        offset += recordSize;
+    }
+    free(moves);
+    return true;
+}
+
+bool openDatabaseWriter(DatabaseWriter* writer, const char* path) {
+    memset(writer, 0, sizeof(*writer));
+    writer->path = malloc(strlen(path) + 1);
+    writer->buffer = malloc(MAX_GAME_BYTES);
+    if (!writer->path || !writer->buffer) {
+        fprintf(stderr, "Error: Out of memory opening %s\n", path);
+        closeDatabaseWriter(writer);
+        return false;
+    }
+    strcpy(writer->path, path);
+
+    MappedFile games;
+    if (!mapFile(&games, path) || games.size == 0) {
+        // A new database
+        FILE* file = fopen(path, "wb");
+        if (!file || !writeGamesHeader(file)) {
+            fprintf(stderr, "Error: Cannot create database %s\n", path);
+            if (file) fclose(file);
+            closeDatabaseWriter(writer);
+            return false;
+        }
+        fclose(file);
+        writer->fileSize = GAMES_HEADER_SIZE;
+    } else {
+        if (!checkGamesHeader(&games, path)) {
+            unmapFile(&games);
+            closeDatabaseWriter(writer);
+            return false;
+        }
+        writer->fileSize = games.size;
+
+        MappedFile index = {0};
+        char* idxPath = indexPath(path);
+        bool current = idxPath && mapFile(&index, idxPath) && isIndexCurrent(&index, &games);
+        free(idxPath);
+        if (current) {
+            IndexHeader header;
+            memcpy(&header, index.data, sizeof(header));
+            writer->gameCount = writer->firstNewGame = header.gameCount;
+        } else {
+            printf("Rebuilding the index of %s\n", path);
+            if (!reindexGames(writer, &games)) {
+                unmapFile(&index);
+                unmapFile(&games);
+                closeDatabaseWriter(writer);
+                return false;
+            }
+        }
+        unmapFile(&index);
+    }
+    unmapFile(&games);
+
+    writer->file = fopen(path, "ab");
+    if (!writer->file) {
+        fprintf(stderr, "Error: Cannot open database %s for writing\n", path);
+        closeDatabaseWriter(writer);
+        return false;
+    }
+    return true;
+}
+
+bool addDatabaseGame(DatabaseWriter* writer, const EngineMove* moves, int plyCount, DatabaseResult result) {
+    if (plyCount > DATABASE_MAX_PLIES) {
+        return false;
+    }
+    size_t bitCount = 0;
+    memset(writer->buffer, 0, MAX_GAME_BYTES);
+    if (!indexGame(writer, moves, plyCount, writer->buffer, &bitCount)) {
+        return false;
+    }
+
+    unsigned char header[GAME_HEADER_SIZE];
+    size_t byteCount = (bitCount + 7) / 8;
+    putU16(header, (unsigned)plyCount);
+    putU16(header + 2, (unsigned)byteCount);
+    header[4] = (unsigned char)result;
+    if (fwrite(header, 1, sizeof(header), writer->file) != sizeof(header) ||
+        fwrite(writer->buffer, 1, byteCount, writer->file) != byteCount) {
+        fprintf(stderr, "Error: Cannot write to %s\n", writer->path);
+        return false;
+    }
+    if (!addGameOffset(writer, writer->fileSize)) {
+        return false;
+    }
+    writer->fileSize += sizeof(header) + byteCount;
+    return true;
+}
+
+static int comparePostings(const void* a, const void* b) {
+    const DatabasePosting* x = a;
+    const DatabasePosting* y = b;
+    if (x->key != y->key) return x->key < y->key ? -1 : 1;
+    if (x->game != y->game) return x->game < y->game ? -1 : 1;
+    return (int)x->ply - (int)y->ply;
+}
+
+// Sort the new postings and keep the first occurrence of each position in each game
+static size_t sortNewPostings(DatabaseWriter* writer) {
+    qsort(writer->newPostings, writer->newPostingCount, sizeof(DatabasePosting), comparePostings);
+    size_t count = 0;
+    for (size_t i = 0; i < writer->newPostingCount; i++) {
+        if (count > 0 && writer->newPostings[count - 1].key == writer->newPostings[i].key &&
+            writer->newPostings[count - 1].game == writer->newPostings[i].game) {
+            continue;
+        }
+        writer->newPostings[count++] = writer->newPostings[i];
+    }
+    return count;
+}
+
+// Write the index to a new file: old offsets and postings merged with the new ones
+static bool writeIndex(DatabaseWriter* writer, const MappedFile* oldIndex, FILE* file) {
+    IndexHeader oldHeader = {{0}, 0, 0, 0, 0};
+    const uint64_t* oldOffsets = NULL;
+    const DatabasePosting* oldPostings = NULL;
+    if (oldIndex->data) {
+        memcpy(&oldHeader, oldIndex->data, sizeof(oldHeader));
+        oldOffsets = (const uint64_t*)(oldIndex->data + sizeof(IndexHeader));
+        oldPostings = (const DatabasePosting*)(oldOffsets + oldHeader.gameCount);
+    }
+    size_t newCount = sortNewPostings(writer);
+
+    IndexHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, INDEX_MAGIC, 8);
+    header.version = DATABASE_VERSION;
+    header.gameCount = writer->gameCount;
+    header.postingCount = oldHeader.postingCount + newCount;
+    header.gamesSize = writer->fileSize;
+    if (fwrite(&header, sizeof(header), 1, file) != 1 ||
+        fwrite(oldOffsets, sizeof(uint64_t), oldHeader.gameCount, file) != oldHeader.gameCount ||
+        fwrite(writer->newOffsets, sizeof(uint64_t), writer->gameCount - writer->firstNewGame, file) !=
+            writer->gameCount - writer->firstNewGame) {
+        return false;
+    }
+
+    // Old games all come before new ones, so ties on the key go to the old posting
+    DatabasePosting chunk[WRITE_CHUNK];
+    int chunkCount = 0;
+    uint64_t i = 0;
+    size_t j = 0;
+    while (i < oldHeader.postingCount || j < newCount) {
+        if (j == newCount || (i < oldHeader.postingCount && oldPostings[i].key <= writer->newPostings[j].key)) {
+            chunk[chunkCount++] = oldPostings[i++];
+        } else {
+            chunk[chunkCount++] = writer->newPostings[j++];
+        }
+        if (chunkCount == WRITE_CHUNK) {
+            if (fwrite(chunk, sizeof(DatabasePosting), chunkCount, file) != (size_t)chunkCount) return false;
+            chunkCount = 0;
+        }
+    }
+    return fwrite(chunk, sizeof(DatabasePosting), chunkCount, file) == (size_t)chunkCount;
+}
+
+bool closeDatabaseWriter(DatabaseWriter* writer) {
+    bool ok = true;
+    if (writer->file) {
+        ok = fclose(writer->file) == 0;
+        writer->file = NULL;
+
+        char* idxPath = indexPath(writer->path);
+        char* tmpPath = idxPath ? malloc(strlen(idxPath) + 5) : NULL;
+        if (!tmpPath) {
+            ok = false;
+        } else {
+            strcpy(tmpPath, idxPath);
+            strcat(tmpPath, ".tmp");
+
+            MappedFile oldIndex = {0};
+            if (writer->firstNewGame > 0 && !mapFile(&oldIndex, idxPath)) {
+                ok = false;
+            }
+            FILE* file = ok ? fopen(tmpPath, "wb") : NULL;
+            if (!file) {
+                ok = false;
+            } else {
+                ok = writeIndex(writer, &oldIndex, file);
+                ok = fclose(file) == 0 && ok;
+            }
+            unmapFile(&oldIndex);
+
+            if (ok) {
+#ifdef _WIN32
+                remove(idxPath);
+#endif
+                ok = rename(tmpPath, idxPath) == 0;
+            }
+            if (!ok) {
+                fprintf(stderr, "Error: Cannot write the index %s\n", idxPath);
+                remove(tmpPath);
+            }
+        }
+        free(tmpPath);
+        free(idxPath);
+    }
+
+    free(writer->path);
+    free(writer->newOffsets);
+    free(writer->newPostings);
+    free(writer->buffer);
+    memset(writer, 0, sizeof(*writer));
+    return ok;
+}
+
+/*==========
+Opening trees
+==========*/
+static int compareSamples(const void* a, const void* b) {
+    const OpeningSample* x = a;
+    const OpeningSample* y = b;
+    if (x->key != y->key) return x->key < y->key ? -1 : 1;
+    return (int)x->move - (int)y->move;
+}
+
+static int compareEntriesByGames(const void* a, const void* b) {
+    const OpeningEntry* x = a;
+    const OpeningEntry* y = b;
+    if (x->games != y->games) return x->games > y->games ? -1 : 1;
+    return (int)x->move - (int)y->move;
+}
+
+static uint16_t packMove(EngineMove move) {
+    unsigned promotion = move.isPromotion ? (move.promotionPiece & TYPE_MASK) : NONE;
+    return (uint16_t)(SQUARE(move.from.x, move.from.y) | (SQUARE(move.to.x, move.to.y) << 6) | (promotion << 12));
+}
+
+// Sort the samples, count each position's moves and write them out, most played first
+static bool writeOpeningEntries(OpeningSample* samples, size_t sampleCount, FILE* file, uint64_t* entryCount) {
+    qsort(samples, sampleCount, sizeof(OpeningSample), compareSamples);
+
+    OpeningEntry entries[MAX_MOVES_PER_POSITION];
+    size_t i = 0;
+    *entryCount = 0;
+    while (i < sampleCount) {
+        int count = 0;
+        uint64_t key = samples[i].key;
+        for (; i < sampleCount && samples[i].key == key; i++) {
+            if (count == 0 || entries[count - 1].move != samples[i].move) {
+                if (count == MAX_MOVES_PER_POSITION) continue;
+                memset(&entries[count], 0, sizeof(OpeningEntry));
+                entries[count].key = key;
+                entries[count].move = samples[i].move;
+                count++;
+            }
+            OpeningEntry* entry = &entries[count - 1];
+            entry->games++;
+            if (samples[i].result == DB_RESULT_WHITE_WINS) entry->whiteWins++;
+            if (samples[i].result == DB_RESULT_DRAW) entry->draws++;
+            if (samples[i].result == DB_RESULT_BLACK_WINS) entry->blackWins++;
+        }
+        qsort(entries, count, sizeof(OpeningEntry), compareEntriesByGames);
+        if (fwrite(entries, sizeof(OpeningEntry), count, file) != (size_t)count) return false;
+        *entryCount += count;
+    }
+    return true;
+}
+
+bool buildOpeningTree(const GameDatabase* db, const char* path, int maxPlies) {
+    size_t capacity = 65536, sampleCount = 0;
+    OpeningSample* samples = malloc(capacity * sizeof(OpeningSample));
+    EngineMove* moves = malloc(DATABASE_MAX_PLIES * sizeof(EngineMove));
+    if (!samples || !moves) {
+        fprintf(stderr, "Error: Out of memory building the opening tree\n");
+        free(samples);
+        free(moves);
+        return false;
+    }
+
+    for (uint32_t game = 0; game < db->gameCount; game++) {
+        DatabaseResult result;
+        int plyCount = readDatabaseGame(db, game, moves, &result);
+        if (plyCount < 0) {
+            fprintf(stderr, "Error: Game %u is corrupt, left out of the tree\n", game);
+            continue;
+        }
+        if (plyCount > maxPlies) plyCount = maxPlies;
+
+        unsigned char board[8][8];
+        Vector2f kings[2];
+        Vector2f lastDoublePawn;
+        loadStartPosition(board, kings, &lastDoublePawn);
+        for (int ply = 0; ply < plyCount; ply++) {
+            if (sampleCount == capacity) {
+                OpeningSample* grown = realloc(samples, capacity * 2 * sizeof(OpeningSample));
+                if (!grown) {
+                    fprintf(stderr, "Error: Out of memory building the opening tree\n");
+                    free(samples);
+                    free(moves);
+                    return false;
+                }
+                samples = grown;
+                capacity *= 2;
+            }
+            OpeningSample sample = {hashPosition(board, ply & 1, &lastDoublePawn), packMove(moves[ply]), (uint8_t)result};
+            samples[sampleCount++] = sample;
+            engineMakeMove(board, moves[ply], &lastDoublePawn, kings, 0);
+        }
+    }
+    free(moves);
+
+    FILE* file = fopen(path, "wb");
+    TreeHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, TREE_MAGIC, 8);
+    header.version = DATABASE_VERSION;
+    header.maxPlies = (uint32_t)maxPlies;
+    // The header is written again once the entry count is known
+    bool ok = file && fwrite(&header, sizeof(header), 1, file) == 1 &&
+              writeOpeningEntries(samples, sampleCount, file, &header.entryCount) &&
+              fseek(file, 0, SEEK_SET) == 0 && fwrite(&header, sizeof(header), 1, file) == 1;
+    if (file && fclose(file) != 0) ok = false;
+    if (!ok) {
+        fprintf(stderr, "Error: Cannot write the opening tree %s\n", path);
+    }
+    free(samples);
+    return ok;
+}
+
+bool openOpeningTree(OpeningTree* tree, const char* path) {
+    memset(tree, 0, sizeof(*tree));
+    if (!mapFile(&tree->file, path)) {
+        return false;
+    }
+    TreeHeader header;
+    if (tree->file.size < sizeof(header)) {
+        fprintf(stderr, "Error: %s is not an opening tree\n", path);
+        closeOpeningTree(tree);
+        return false;
+    }
+    memcpy(&header, tree->file.data, sizeof(header));
+    if (memcmp(header.magic, TREE_MAGIC, 8) != 0 || header.version != DATABASE_VERSION ||
+        tree->file.size != sizeof(header) + header.entryCount * sizeof(OpeningEntry)) {
+        fprintf(stderr, "Error: %s is not an opening tree of this version\n", path);
+        closeOpeningTree(tree);
+        return false;
+    }
+    tree->entries = (const OpeningEntry*)(tree->file.data + sizeof(header));
+    tree->entryCount = header.entryCount;
+    tree->maxPlies = (int)header.maxPlies;
+    return true;
+}
+
+void closeOpeningTree(OpeningTree* tree) {
+    unmapFile(&tree->file);
+    memset(tree, 0, sizeof(*tree));
+}
+
+const OpeningEntry* findOpeningMoves(const OpeningTree* tree, uint64_t key, size_t* count) {
+    uint64_t low = 0, high = tree->entryCount;
+    while (low < high) {
+        uint64_t middle = low + (high - low) / 2;
+        if (tree->entries[middle].key < key) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+
+    uint64_t end = low;
+    while (end < tree->entryCount && tree->entries[end].key == key) {
+        end++;
+    }
+    *count = (size_t)(end - low);
+    return *count ? &tree->entries[low] : NULL;
+}
+
+bool openingEntryMove(const OpeningEntry* entry, const MoveGenContext* gen, unsigned char board[8][8], EngineMove* move) {
+    int from = entry->move & 63;
+    int to = (entry->move >> 6) & 63;
+    unsigned char promotionType = (unsigned char)(entry->move >> 12);
+    if (!(legalDestinations(gen, board, from) & SQUARE_BIT(to))) {
+        return false;
+    }
+    bool isPawn = (board[SQUARE_ROW(from)][SQUARE_COL(from)] & TYPE_MASK) == PAWN;
+    bool promotes = isPawn && (SQUARE_ROW(to) == 0 || SQUARE_ROW(to) == 7);
+    if (promotes != (promotionType != NONE)) {
+        return false;
+    }
+    *move = createEngineMove(gen, board, from, to, promotionType);
+    return true;
+}
@@ -0,0 +1,132 @@
+// src/database.h
+#ifndef DATABASE_H
+#define DATABASE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdint.h>
+#include "engine.h"
+
+// A game database is two files:
+//   <name>      the games, appended one after another (little-endian, portable)
+//   <name>.idx  game offsets and the position index, rebuilt after every import
+//               (native byte order; it can always be rebuilt from the games)
+// Both are memory-mapped for reading. Games always start from the standard position.
+//
+// A move is stored as its rank among the legal moves: the index of the moving piece
+// among the pieces that can move, the index of the target among that piece's targets,
+// and two bits for the piece when it promotes. Each index takes just enough bits for
+// the choices in that position, so a move is 5-6 bits on average.
+//
+// The position index holds one posting per distinct position in each game, sorted
+// by Zobrist key; the games reaching a position are a binary search away. The keys
+// come from hashPosition, so a database must be rebuilt if the Zobrist seed changes.
+
+#define DATABASE_VERSION 1
+#define DATABASE_MAX_PLIES 4096  // Longest game accepted
+#define OPENING_TREE_PLIES 30    // Default depth of an opening tree
+
+typedef enum {
+    DB_RESULT_UNKNOWN,           // "*"
+    DB_RESULT_WHITE_WINS,
+    DB_RESULT_BLACK_WINS,
+    DB_RESULT_DRAW
+} DatabaseResult;
+
+// One position of one game
+typedef struct {
+    uint64_t key;                // hashPosition of the position
+    uint32_t game;
+    uint16_t ply;                // Plies played to reach it (its first occurrence in the game)
+    uint16_t reserved;
+} DatabasePosting;
+
+// A read-only memory-mapped file
+typedef struct {
+    const unsigned char* data;
+    size_t size;
+#ifdef _WIN32
+    void* file;
+    void* mapping;
+#endif
+} MappedFile;
+
+typedef struct {
+    MappedFile games;
+    MappedFile index;
+    uint32_t gameCount;
+    const uint64_t* gameOffsets;        // Into games, one per game
+    const DatabasePosting* postings;
+    uint64_t postingCount;
+} GameDatabase;
+
+// What was played from one position: one entry per move, keyed like the postings.
+// An opening tree file is a header and these entries, sorted by key and then by games (most first).
+typedef struct {
+    uint64_t key;
+    uint16_t move;               // from | to << 6 | promotion piece type << 12 (squares are row * 8 + col)
+    uint16_t reserved;
+    uint32_t games;
+    uint32_t whiteWins;
+    uint32_t draws;
+    uint32_t blackWins;
+    uint32_t reserved2;
+} OpeningEntry;
+
+typedef struct {
+    MappedFile file;
+    const OpeningEntry* entries;
+    uint64_t entryCount;
+    int maxPlies;                // Positions deeper into the games than this aren't in the tree
+} OpeningTree;
+
+// Appends games; the index is brought up to date by closeDatabaseWriter
+typedef struct {
+    char* path;
+    FILE* file;
+    uint64_t fileSize;
+    uint32_t gameCount;                 // Games in the file, including the ones added
+    uint32_t firstNewGame;
+    uint64_t* newOffsets;               // Offsets of the games added
+    DatabasePosting* newPostings;       // Their positions, unsorted
+    size_t newPostingCount;
+    size_t newPostingCapacity;
+    unsigned char* buffer;              // Bits of the game being encoded
+} DatabaseWriter;
+
+// Open a database for queries; false (with a message) when missing, corrupt or not indexed
+bool openGameDatabase(GameDatabase* db, const char* path);
+void closeGameDatabase(GameDatabase* db);
+
+// Postings for the position (all games reaching it), ordered by game; NULL when there are none
+const DatabasePosting* findPosition(const GameDatabase* db, uint64_t key, size_t* count);
+
+// Decode a game into moves (room for DATABASE_MAX_PLIES). Returns the number of plies, -1 if corrupt.
+int readDatabaseGame(const GameDatabase* db, uint32_t game, EngineMove* moves, DatabaseResult* result);
+
+// Create the database if needed and get ready to append to it
+bool openDatabaseWriter(DatabaseWriter* writer, const char* path);
+
+// Append a game played from the standard starting position; false when a move is illegal
+bool addDatabaseGame(DatabaseWriter* writer, const EngineMove* moves, int plyCount, DatabaseResult result);
+
+// Merge the new games into the index and close the files
+bool closeDatabaseWriter(DatabaseWriter* writer);
+
+// Count the moves played from every position in the first maxPlies plies of each game
+bool buildOpeningTree(const GameDatabase* db, const char* path, int maxPlies);
+
+bool openOpeningTree(OpeningTree* tree, const char* path);
+void closeOpeningTree(OpeningTree* tree);
+
+// Entries for the position, most played first; NULL when the position isn't in the tree
+const OpeningEntry* findOpeningMoves(const OpeningTree* tree, uint64_t key, size_t* count);
+
+// The move of an entry in the position it was found for; false when it isn't legal there (a key collision)
+bool openingEntryMove(const OpeningEntry* entry, const MoveGenContext* gen, unsigned char board[8][8], EngineMove* move);
+
+// The position games in the database start from
+void loadStartPosition(unsigned char board[8][8], Vector2f kings[2], Vector2f* lastDoublePawn);
+
+#endif // DATABASE_H
@@ -0,0 +1,283 @@
+// src/diagram.c
+// Headless board diagrams: renders FEN positions to PNG files with the game's own board and
+// piece drawing, on software renderers over plain surfaces, so no display is needed.
+// One worker per core, each with its own surface, renderer and piece atlas.
+//
+// Usage: diagram <fens.txt> [-out dir] [-concurrency N] [-captured]
+//
+// The input holds one FEN per line; blank lines and lines starting with # are skipped.
+// Position n (counting from 1) is written to <dir>/<n>.png, zero padded to five digits.
+// -captured adds the game's first sidebar with the pieces missing from each side.
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_image.h>
+
+#include "RenderWindow.h"
+#include "PieceAtlas.h"
+#include "Resources.h"
+#include "GameState.h"
+#include "Piece.h"
+#include "util.h"
+
+#define MAX_POSITIONS 100000
+#define MAX_THREADS 64
+#define PROGRESS_INTERVAL 1000 // Report every this many images
+
+// The game's board colors
+static const SDL_Color lightColor = {240, 240, 240, 255};
+static const SDL_Color darkColor = {119, 149, 86, 255};
+static const SDL_Color sidebarColor = {120, 120, 120, 255};
+
+// Everything shared between the worker threads
+typedef struct {
+    char (*fens)[FEN_LENGTH];
+    int positionCount;
+    const char* outDirectory;
+    bool drawCaptured;
+    int width, height;
+    SDL_atomic_t nextPosition;
+
+    // Results, guarded by lock
+    SDL_mutex* lock;
+    int imagesDone;
+    int failures;
+    Uint64 start;
+} DiagramRun;
+
+static double secondsSince(Uint64 start) {
+    return (double)(SDL_GetPerformanceCounter() - start) / SDL_GetPerformanceFrequency();
+}
+
+static int loadPositions(const char* path, DiagramRun* run) {
+    FILE* file = fopen(path, "r");
+    if (!file) {
+        fprintf(stderr, "Error: Could not open file %s for reading\n", path);
+        return -1;
+    }
+
+    char line[256];
+    int count = 0;
+    while (fgets(line, sizeof(line), file)) {
+        line[strcspn(line, "\r\n")] = '\0';
+        if (line[0] == '\0' || line[0] == '#') continue;
+        if (count == MAX_POSITIONS) {
+            fprintf(stderr, "Warning: More than %d positions in %s, the rest are ignored\n", MAX_POSITIONS, path);
+            break;
+        }
+        strncpy(run->fens[count], line, FEN_LENGTH - 1);
+        run->fens[count][FEN_LENGTH - 1] = '\0';
+        count++;
+    }
+    fclose(file);
+    return count;
+}
+
+// What each side has lost from the starting set, as the game would have recorded it;
+// promoted pieces just make the count come out lower
+static void findCapturedPieces(unsigned char board[8][8], GameState* state) {
+    static const int startingCounts[7] = {0, 8, 2, 2, 2, 1, 1};
+    int counts[2][7] = {{0}};
+    for (int row = 0; row < 8; row++) {
+        for (int col = 0; col < 8; col++) {
+            unsigned char piece = board[row][col];
+            if (piece & TYPE_MASK) {
+                counts[(piece & COLOR_MASK) ? 1 : 0][piece & TYPE_MASK]++;
+            }
+        }
+    }
+
+    state->numWhiteCapturedPieces = 0;
+    state->numBlackCapturedPieces = 0;
+    for (int type = QUEEN; type >= PAWN; type--) {
+        for (int n = counts[1][type]; n < startingCounts[type] && state->numWhiteCapturedPieces < MAX_CAPTURED; n++) {
+            state->whiteCapturedPieces[state->numWhiteCapturedPieces++] = type;
+        }
+        for (int n = counts[0][type]; n < startingCounts[type] && state->numBlackCapturedPieces < MAX_CAPTURED; n++) {
+            state->blackCapturedPieces[state->numBlackCapturedPieces++] = type;
+        }
+    }
+}
+
+static void drawDiagram(SDL_Renderer* renderer, const PieceAtlas* atlas, PieceBatch* batch, GameState* state, bool drawCaptured) {
+    static const BoardOverlay noOverlay = {-1, 0, 0};
+    clearPieceBatch(batch);
+
+    drawBoard(renderer, squareSize, 0, lightColor, darkColor, lightColor, lightColor, lightColor, &noOverlay);
+    for (int row = 0; row < 8; row++) {
+        for (int col = 0; col < 8; col++) {
+            SDL_Rect square = {col * squareSize, row * squareSize, squareSize, squareSize};
+            addPieceToBatch(batch, atlas, state->board[row][col], square);
+        }
+    }
+
+    if (drawCaptured) {
+        SDL_Rect sidebar = {boardWidth, 0, sidebar1_width, boardWidth};
+        SDL_SetRenderDrawColor(renderer, sidebarColor.r, sidebarColor.g, sidebarColor.b, sidebarColor.a);
+        SDL_RenderFillRect(renderer, &sidebar);
+        findCapturedPieces(state->board, state);
+        batchCapturedPieces(batch, atlas, state);
+    }
+
+    drawPieceBatch(batch, renderer, atlas);
+}
+
+static int diagramWorker(void* data) {
+    DiagramRun* run = data;
+    SDL_Surface* surface = SDL_CreateRGBSurfaceWithFormat(0, run->width, run->height, 32, SDL_PIXELFORMAT_RGBA32);
+    SDL_Renderer* renderer = surface ? SDL_CreateSoftwareRenderer(surface) : NULL;
+    if (!renderer) {
+        fprintf(stderr, "Error: Software renderer failed to init: %s\n", SDL_GetError());
+        SDL_FreeSurface(surface);
+        return 1;
+    }
+
+    // Textures belong to one renderer, so every worker builds its own atlas
+    PieceAtlas atlas;
+    PieceBatch* batch = malloc(sizeof(PieceBatch));
+    GameState* state = calloc(1, sizeof(GameState));
+    bool ready = batch && state;
+    if (!ready) {
+        fprintf(stderr, "Error: Out of memory\n");
+    } else if (!(ready = loadPieceAtlas(&atlas, renderer, squareSize, CAPTURED_PIECE_SIZE))) {
+        fprintf(stderr, "Error: Could not load the piece sprites\n");
+        destroyPieceAtlas(&atlas);
+    }
+    if (!ready) {
+        free(batch);
+        free(state);
+        SDL_DestroyRenderer(renderer);
+        SDL_FreeSurface(surface);
+        return 1;
+    }
+
+    while (true) {
+        int index = SDL_AtomicAdd(&run->nextPosition, 1);
+        if (index >= run->positionCount) break;
+
+        char path[512];
+        snprintf(path, sizeof(path), "%s/%05d.png", run->outDirectory, index + 1);
+        bool saved = false;
+        if (!loadFEN(run->fens[index], state->board, &state->blackTurn, &state->lastDoublePushPawn)) {
+            fprintf(stderr, "Error: Invalid FEN on position %d: %s\n", index + 1, run->fens[index]);
+        } else {
+            drawDiagram(renderer, &atlas, batch, state, run->drawCaptured);
+            SDL_RenderPresent(renderer);
+            saved = IMG_SavePNG(surface, path) == 0;
+            if (!saved) {
+                fprintf(stderr, "Error: Could not write %s: %s\n", path, IMG_GetError());
+            }
+        }
+
+        SDL_LockMutex(run->lock);
+        if (saved) {
+            run->imagesDone++;
+            if (run->imagesDone % PROGRESS_INTERVAL == 0) {
+                printf("%d/%d images, %.1f images/s\n", run->imagesDone, run->positionCount,
+                       run->imagesDone / secondsSince(run->start));
+            }
+        } else {
+            run->failures++;
+        }
+        SDL_UnlockMutex(run->lock);
+    }
+
+    free(state);
+    free(batch);
+    destroyPieceAtlas(&atlas);
+    SDL_DestroyRenderer(renderer);
+    SDL_FreeSurface(surface);
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    static DiagramRun run;
+    const char* inputPath = NULL;
+    int concurrency = SDL_GetCPUCount();
+
+    run.outDirectory = ".";
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-out") == 0 && i + 1 < argc) {
+            run.outDirectory = argv[++i];
+        } else if (strcmp(argv[i], "-concurrency") == 0 && i + 1 < argc) {
+            concurrency = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-captured") == 0) {
+            run.drawCaptured = true;
+        } else {
+            inputPath = argv[i];
+        }
+    }
+
+    if (!inputPath) {
+        printf("Usage: %s <fens.txt> [-out dir] [-concurrency N] [-captured]\n", argv[0]);
+        return 1;
+    }
+    run.fens = malloc(sizeof(*run.fens) * MAX_POSITIONS);
+    if (!run.fens) {
+        fprintf(stderr, "Error: Out of memory\n");
+        return 1;
+    }
+    run.positionCount = loadPositions(inputPath, &run);
+    if (run.positionCount < 0) {
+        free(run.fens);
+        return 1;
+    }
+    if (concurrency < 1) concurrency = 1;
+    if (concurrency > MAX_THREADS) concurrency = MAX_THREADS;
+
+    // Software renderers need no video subsystem, only the PNG loader
+    if (SDL_Init(0) != 0 || !(IMG_Init(IMG_INIT_PNG) & IMG_INIT_PNG)) {
+        fprintf(stderr, "Error: SDL failed to init: %s\n", SDL_GetError());
+        free(run.fens);
+        return 1;
+    }
+
+    // Workers ask for sprite paths at the same time, so find the res directory up front
+    initResourcePaths();
+
+    run.width = boardWidth + (run.drawCaptured ? sidebar1_width : 0);
+    run.height = boardWidth;
+    run.lock = SDL_CreateMutex();
+    printf("%d positions, %dx%d, %d threads\n", run.positionCount, run.width, run.height, concurrency);
+
+    run.start = SDL_GetPerformanceCounter();
+    SDL_Thread* threads[MAX_THREADS];
+    for (int t = 0; t < concurrency; t++) {
+        threads[t] = SDL_CreateThread(diagramWorker, "diagram-worker", &run);
+        if (!threads[t]) {
+            fprintf(stderr, "Error: Could not create worker thread: %s\n", SDL_GetError());
+        }
+    }
+    // A worker that fails leaves its share to the others; the run fails with it all the same
+    int failedWorkers = 0;
+    for (int t = 0; t < concurrency; t++) {
+        int status = 1;
+        if (threads[t]) {
+            SDL_WaitThread(threads[t], &status);
+        }
+        if (status != 0) {
+            failedWorkers++;
+        }
+    }
+
+    double seconds = secondsSince(run.start);
+    printf("Rendered %d images in %.2f s: %.1f images/s", run.imagesDone, seconds,
+           seconds > 0 ? run.imagesDone / seconds : 0.0);
+    if (run.failures > 0) {
+        printf(", %d failed", run.failures);
+    }
+    printf("\n");
+    if (failedWorkers == concurrency) {
+        fprintf(stderr, "Error: No worker could start; nothing was rendered\n");
+    } else if (failedWorkers > 0) {
+        fprintf(stderr, "Error: %d of %d workers failed to start\n", failedWorkers, concurrency);
+    }
+
+    SDL_DestroyMutex(run.lock);
+    free(run.fens);
+    IMG_Quit();
+    SDL_Quit();
+    return run.failures > 0 || failedWorkers > 0 ? 1 : 0;
+}
@@ -3,163 +3,129 @@
 #include <stdbool.h>
 #include <string.h>
 #include <limits.h>
+#include <ctype.h>
+#include <stddef.h>
+#include <SDL2/SDL.h>
 
 #include "engine.h"
 #include "Piece.h"
+#include "bitboard.h"
 
 // Function to initialize the engine
+static void initZobrist();
+
 void initializeEngine() {
-    printf("Chess engine initialized\n");
-    // Any initialization code can go here
-    // For now, this is just a placeholder
+    initZobrist();
+    SliderLookup lookup = initBitboards(SLIDER_LOOKUP_AUTO);
+    printf("Chess engine initialized (%s slider attacks)\n", sliderLookupName(lookup));
 }
 
 /*==========
-Positional evaluation for white (flipped for black)
+Evaluation weights (values come from the generated eval_params.h)
+Piece-square tables are for white (flipped for black)
 ==========*/
-// Pawn position values - middlegame
-const int pawnTableMG[8][8] = {
-    { 0,  0,  0,  0,  0,  0,  0,  0},
-    {50, 50, 50, 50, 50, 50, 50, 50},
-    {10, 10, 20, 30, 30, 20, 10, 10},
-    { 5,  5, 10, 25, 25, 10,  5,  5},
-    { 0,  0,  0, 20, 20,  0,  0,  0},
-    { 5, -5,-10,  0,  0,-10, -5,  5},
-    { 5, 10, 10,-20,-20, 10, 10,  5},
-    { 0,  0,  0,  0,  0,  0,  0,  0}
-};
-
-// Pawn position values - endgame
-const int pawnTableEG[8][8] = {
-    { 0,  0,  0,  0,  0,  0,  0,  0},
-    {80, 80, 80, 80, 80, 80, 80, 80},
-    {50, 50, 50, 50, 50, 50, 50, 50},
-    {30, 30, 30, 30, 30, 30, 30, 30},
-    {20, 20, 20, 20, 20, 20, 20, 20},
-    {10, 10, 10, 10, 10, 10, 10, 10},
-    {10, 10, 10, 10, 10, 10, 10, 10},
-    { 0,  0,  0,  0,  0,  0,  0,  0}
-};
-
-// Knight position values - middlegame
-const int knightTableMG[8][8] = {
-    {-50,-40,-30,-30,-30,-30,-40,-50},
-    {-40,-20,  0,  0,  0,  0,-20,-40},
-    {-30,  0, 10, 15, 15, 10,  0,-30},
-    {-30,  5, 15, 20, 20, 15,  5,-30},
-    {-30,  0, 15, 20, 20, 15,  0,-30},
-    {-30,  5, 10, 15, 15, 10,  5,-30},
-    {-40,-20,  0,  5,  5,  0,-20,-40},
-    {-50,-40,-30,-30,-30,-30,-40,-50}
-};
-
-// Knight position values - endgame
-const int knightTableEG[8][8] = {
-    {-50,-40,-30,-30,-30,-30,-40,-50},
-    {-40,-20,  0,  0,  0,  0,-20,-40},
-    {-30,  0, 10, 15, 15, 10,  0,-30},
-    {-30,  5, 15, 20, 20, 15,  5,-30},
-    {-30,  0, 15, 20, 20, 15,  0,-30},
-    {-30,  5, 10, 15, 15, 10,  5,-30},
-    {-40,-20,  0,  5,  5,  0,-20,-40},
-    {-50,-40,-30,-30,-30,-30,-40,-50}
+EvalParams evalParams = {
+    .pieceValue = {0, PAWN_VALUE, BISHOP_VALUE, KNIGHT_VALUE, ROOK_VALUE, QUEEN_VALUE, KING_VALUE},
+    .pstMG = {
+        {{0}},
+        PAWN_TABLE_MG,
+        BISHOP_TABLE_MG,
+        KNIGHT_TABLE_MG,
+        ROOK_TABLE_MG,
+        QUEEN_TABLE_MG,
+        KING_TABLE_MG
+    },
+    .pstEG = {
+        {{0}},
+        PAWN_TABLE_EG,
+        BISHOP_TABLE_EG,
+        KNIGHT_TABLE_EG,
+        ROOK_TABLE_EG,
+        QUEEN_TABLE_EG,
+        KING_TABLE_EG
+    },
+    .mobilityWeight = MOBILITY_WEIGHT,
+    .kingCenterPenalty = KING_CENTER_PENALTY,
+    .kingPawnShieldBonus = KING_PAWN_SHIELD_BONUS,
+    .kingInCheckPenalty = KING_IN_CHECK_PENALTY,
+    .passedPawnBonus = PASSED_PAWN_BONUS,
+    .passedPawnRankBonus = PASSED_PAWN_RANK_BONUS,
+    .doubledPawnPenalty = DOUBLED_PAWN_PENALTY,
+    .isolatedPawnPenalty = ISOLATED_PAWN_PENALTY
 };
 
-// Bishop position values - middlegame
-const int bishopTableMG[8][8] = {
-    {-20,-10,-10,-10,-10,-10,-10,-20},
-    {-10,  0,  0,  0,  0,  0,  0,-10},
-    {-10,  0, 10, 10, 10, 10,  0,-10},
-    {-10,  5,  5, 10, 10,  5,  5,-10},
-    {-10,  0,  5, 10, 10,  5,  0,-10},
-    {-10,  5,  5,  5,  5,  5,  5,-10},
-    {-10,  0,  5,  0,  0,  5,  0,-10},
-    {-20,-10,-10,-10,-10,-10,-10,-20}
-};
+// Index of a field inside EvalParams when viewed as a flat int array
+#define PARAM_INDEX(field) ((int)(offsetof(EvalParams, field) / sizeof(int)))
 
-// Bishop position values - endgame
-const int bishopTableEG[8][8] = {
-    {-20,-10,-10,-10,-10,-10,-10,-20},
-    {-10,  0,  0,  0,  0,  0,  0,-10},
-    {-10,  0, 10, 10, 10, 10,  0,-10},
-    {-10,  5,  5, 10, 10,  5,  5,-10},
-    {-10,  0,  5, 10, 10,  5,  0,-10},
-    {-10,  5,  5,  5,  5,  5,  5,-10},
-    {-10,  0,  5,  0,  0,  5,  0,-10},
-    {-20,-10,-10,-10,-10,-10,-10,-20}
-};
-
-// Rook position values - middlegame
-const int rookTableMG[8][8] = {
-    { 0,  0,  0,  0,  0,  0,  0,  0},
-    { 5, 10, 10, 10, 10, 10, 10,  5},
-    {-5,  0,  0,  0,  0,  0,  0, -5},
-    {-5,  0,  0,  0,  0,  0,  0, -5},
-    {-5,  0,  0,  0,  0,  0,  0, -5},
-    {-5,  0,  0,  0,  0,  0,  0, -5},
-    {-5,  0,  0,  0,  0,  0,  0, -5},
-    { 0,  0,  0,  5,  5,  0,  0,  0}
-};
-
-// Rook position values - endgame
-const int rookTableEG[8][8] = {
-    { 0,  0,  0,  0,  0,  0,  0,  0},
-    { 5, 10, 10, 10, 10, 10, 10,  5},
-    {-5,  0,  0,  0,  0,  0,  0, -5},
-    {-5,  0,  0,  0,  0,  0,  0, -5},
-    {-5,  0,  0,  0,  0,  0,  0, -5},
-    {-5,  0,  0,  0,  0,  0,  0, -5},
-    {-5,  0,  0,  0,  0,  0,  0, -5},
-    { 0,  0,  0,  5,  5,  0,  0,  0}
-};
+// Record 'amount' as the coefficient of a parameter (no-op outside the tuner)
+static void traceAdd(EvalTrace* trace, int index, float amount) {
+    if (trace) {
+        trace->coef[index] += amount;
+    }
+}
 
-// Queen position values - middlegame
-const int queenTableMG[8][8] = {
-    {-20,-10,-10, -5, -5,-10,-10,-20},
-    {-10,  0,  0,  0,  0,  0,  0,-10},
-    {-10,  0,  5,  5,  5,  5,  0,-10},
-    { -5,  0,  5,  5,  5,  5,  0, -5},
-    {  0,  0,  5,  5,  5,  5,  0, -5},
-    {-10,  5,  5,  5,  5,  5,  0,-10},
-    {-10,  0,  5,  0,  0,  0,  0,-10},
-    {-20,-10,-10, -5, -5,-10,-10,-20}
-};
+// Read weights from a file in the eval_params.h format written by the tuner,
+// so tuned candidates can be compared without rebuilding. Unlisted weights keep their value.
+bool loadEvalParams(const char* path, EvalParams* params) {
+    FILE* file = fopen(path, "r");
+    if (!file) {
+        fprintf(stderr, "Error: Could not open file %s for reading\n", path);
+        return false;
+    }
 
-// Queen position values - endgame
-const int queenTableEG[8][8] = {
-    {-20,-10,-10, -5, -5,-10,-10,-20},
-    {-10,  0,  0,  0,  0,  0,  0,-10},
-    {-10,  0,  5,  5,  5,  5,  0,-10},
-    { -5,  0,  5,  5,  5,  5,  0, -5},
-    {  0,  0,  5,  5,  5,  5,  0, -5},
-    {-10,  5,  5,  5,  5,  5,  0,-10},
-    {-10,  0,  5,  0,  0,  0,  0,-10},
-    {-20,-10,-10, -5, -5,-10,-10,-20}
-};
+    struct { const char* name; int* value; } scalars[] = {
+        {"PAWN_VALUE", &params->pieceValue[PAWN]},
+        {"BISHOP_VALUE", &params->pieceValue[BISHOP]},
+        {"KNIGHT_VALUE", &params->pieceValue[KNIGHT]},
+        {"ROOK_VALUE", &params->pieceValue[ROOK]},
+        {"QUEEN_VALUE", &params->pieceValue[QUEEN]},
+        {"MOBILITY_WEIGHT", &params->mobilityWeight},
+        {"KING_CENTER_PENALTY", &params->kingCenterPenalty},
+        {"KING_PAWN_SHIELD_BONUS", &params->kingPawnShieldBonus},
+        {"KING_IN_CHECK_PENALTY", &params->kingInCheckPenalty},
+        {"PASSED_PAWN_BONUS", &params->passedPawnBonus},
+        {"PASSED_PAWN_RANK_BONUS", &params->passedPawnRankBonus},
+        {"DOUBLED_PAWN_PENALTY", &params->doubledPawnPenalty},
+        {"ISOLATED_PAWN_PENALTY", &params->isolatedPawnPenalty}
+    };
+    const char* tableNames[7] = {"", "PAWN", "BISHOP", "KNIGHT", "ROOK", "QUEEN", "KING"};
+
+    char line[256], name[64];
+    int (*table)[8] = NULL; // Table whose rows are being read
+    int tableRow = 0;
+
+    while (fgets(line, sizeof(line), file)) {
+        if (table) {
+            int* row = table[tableRow];
+            if (sscanf(line, " {%d,%d,%d,%d,%d,%d,%d,%d}", &row[0], &row[1], &row[2], &row[3],
+                       &row[4], &row[5], &row[6], &row[7]) == 8 && ++tableRow == 8) {
+                table = NULL;
+            }
+            continue;
+        }
 
-// King middle game position values
-const int kingTableMG[8][8] = {
-    {-30,-40,-40,-50,-50,-40,-40,-30},
-    {-30,-40,-40,-50,-50,-40,-40,-30},
-    {-30,-40,-40,-50,-50,-40,-40,-30},
-    {-30,-40,-40,-50,-50,-40,-40,-30},
-    {-20,-30,-30,-40,-40,-30,-30,-20},
-    {-10,-20,-20,-20,-20,-20,-20,-10},
-    { 20, 20,  0,  0,  0,  0, 20, 20},
-    { 20, 30, 10,  0,  0, 10, 30, 20}
-};
+        int value;
+        if (sscanf(line, "#define %63s %d", name, &value) == 2) {
+            for (size_t i = 0; i < sizeof(scalars) / sizeof(scalars[0]); i++) {
+                if (strcmp(name, scalars[i].name) == 0) {
+                    *scalars[i].value = value;
+                }
+            }
+        } else if (sscanf(line, "#define %63s {", name) == 1) {
+            for (int piece = PAWN; piece <= KING; piece++) {
+                char expected[32];
+                snprintf(expected, sizeof(expected), "%s_TABLE_MG", tableNames[piece]);
+                if (strcmp(name, expected) == 0) table = params->pstMG[piece];
+                snprintf(expected, sizeof(expected), "%s_TABLE_EG", tableNames[piece]);
+                if (strcmp(name, expected) == 0) table = params->pstEG[piece];
+            }
+            tableRow = 0;
+        }
+    }
 
-// King end game position values
-const int kingTableEG[8][8] = {
-    {-50,-40,-30,-20,-20,-30,-40,-50},
-    {-30,-20,-10,  0,  0,-10,-20,-30},
-    {-30,-10, 20, 30, 30, 20,-10,-30},
-    {-30,-10, 30, 40, 40, 30,-10,-30},
-    {-30,-10, 30, 40, 40, 30,-10,-30},
-    {-30,-10, 20, 30, 30, 20,-10,-30},
-    {-30,-30,  0,  0,  0,  0,-30,-30},
-    {-50,-30,-30,-30,-30,-30,-30,-50}
-};
+    fclose(file);
+    return true;
+}
 
 // Helper Functions
 void copyBoard(unsigned char src[8][8], unsigned char dst[8][8]) {
@@ -203,356 +169,262 @@ int getPhase(unsigned char board[8][8]) {
 
 // Check if a square is attacked by a piece of the given color
 bool isSquareAttacked(unsigned char board[8][8], Vector2f position, unsigned char attackerColor) {
-    // Check for pawn attacks
-    int pawnDir = (attackerColor == 0) ? 1 : -1;
-    
-    // Check diagonal pawn captures
-    if (position.x + pawnDir >= 0 && position.x + pawnDir < 8) {
-        if (position.y - 1 >= 0) {
-            unsigned char piece = board[position.x + pawnDir][position.y - 1];
-            if ((piece & TYPE_MASK) == PAWN && ((piece & COLOR_MASK) >> 4) == attackerColor) {
-                return true;
-            }
+    BoardBitboards bb;
+    loadBitboards(board, &bb);
+    return isSquareAttackedBB(&bb, SQUARE(position.x, position.y), attackerColor);
+}
+
+// Check if the king is in check
+bool isKingInCheck(unsigned char board[8][8], Vector2f kingPosition, unsigned char color) {
+    return isCheck(board, kingPosition); // Use the isCheck function from Piece.c
+}
+
+#define PROMOTION_ROWS 0xff000000000000ffULL
+
+void initMoveGen(MoveGenContext* gen, unsigned char board[8][8], unsigned char color, Vector2f* lastDoublePawn) {
+    loadBitboards(board, &gen->bb);
+    gen->color = color;
+    gen->checkers = 0;
+    gen->pinned = 0;
+    gen->checkMask = ~0ULL;
+    gen->enPassantSquare = -1;
+    gen->enPassantVictim = -1;
+
+    // En passant onto an empty square behind the pawn that just moved two squares
+    // (lastDoublePawn holds the column in x and the row in y)
+    if (lastDoublePawn && lastDoublePawn->x >= 0) {
+        int row = (int)lastDoublePawn->y + ((color == 0) ? -1 : 1);
+        if (row >= 0 && row < 8 && board[row][(int)lastDoublePawn->x] == NONE) {
+            gen->enPassantSquare = SQUARE(row, (int)lastDoublePawn->x);
+            gen->enPassantVictim = SQUARE((int)lastDoublePawn->y, (int)lastDoublePawn->x);
         }
-        
-        if (position.y + 1 < 8) {
-            unsigned char piece = board[position.x + pawnDir][position.y + 1];
-            if ((piece & TYPE_MASK) == PAWN && ((piece & COLOR_MASK) >> 4) == attackerColor) {
-                return true;
-            }
+    }
+
+    Bitboard king = gen->bb.pieces[color][KING];
+    if (!king) {
+        gen->kingSquare = -1;
+        return;
+    }
+    int kingSquare = gen->kingSquare = lowestSquare(king);
+    unsigned char enemy = color ^ 1;
+    const Bitboard* attacker = gen->bb.pieces[enemy];
+
+    gen->checkers = attackersOfColor(&gen->bb, kingSquare, enemy, gen->bb.occupied);
+    if (popCount(gen->checkers) > 1) {
+        gen->checkMask = 0;
+    } else if (gen->checkers) {
+        gen->checkMask = gen->checkers | betweenTable[kingSquare][lowestSquare(gen->checkers)];
+    }
+
+    // A slider lined up with our king behind exactly one of our pieces pins it
+    Bitboard snipers = (bishopAttacks(kingSquare, 0) & (attacker[BISHOP] | attacker[QUEEN])) |
+                       (rookAttacks(kingSquare, 0) & (attacker[ROOK] | attacker[QUEEN]));
+    while (snipers) {
+        Bitboard between = betweenTable[kingSquare][popLowestSquare(&snipers)] & gen->bb.occupied;
+        if (popCount(between) == 1) {
+            gen->pinned |= between & gen->bb.colors[color];
         }
     }
-    
-    // Check knight attacks
-    int knightMoves[8][2] = {
-        {-2, -1}, {-2, 1}, {-1, -2}, {-1, 2},
-        {1, -2}, {1, 2}, {2, -1}, {2, 1}
-    };
-    
-    for (int i = 0; i < 8; i++) {
-        int nx = position.x + knightMoves[i][0];
-        int ny = position.y + knightMoves[i][1];
-        
-        if (nx >= 0 && nx < 8 && ny >= 0 && ny < 8) {
-            unsigned char piece = board[nx][ny];
-            if ((piece & TYPE_MASK) == KNIGHT && ((piece & COLOR_MASK) >> 4) == attackerColor) {
-                return true;
-            }
+}
+
+// En passant removes two pieces from one line, which the pin mask can't see; test it directly
+static bool isEnPassantLegal(const MoveGenContext* gen, int from) {
+    if (gen->kingSquare < 0) return true;
+    Bitboard victim = SQUARE_BIT(gen->enPassantVictim);
+    Bitboard occupied = (gen->bb.occupied ^ SQUARE_BIT(from) ^ victim) | SQUARE_BIT(gen->enPassantSquare);
+    return (attackersOfColor(&gen->bb, gen->kingSquare, gen->color ^ 1, occupied) & ~victim) == 0;
+}
+
+static Bitboard kingDestinations(const MoveGenContext* gen, unsigned char board[8][8], int square) {
+    unsigned char color = gen->color;
+    unsigned char enemy = color ^ 1;
+    Bitboard destinations = 0;
+
+    // The king can't hide behind itself from a slider
+    Bitboard occupied = gen->bb.occupied ^ SQUARE_BIT(square);
+    Bitboard targets = kingAttackTable[square] & ~gen->bb.colors[color];
+    while (targets) {
+        int target = popLowestSquare(&targets);
+        if (!attackersOfColor(&gen->bb, target, enemy, occupied)) {
+            destinations |= SQUARE_BIT(target);
         }
     }
-    
-    // Check diagonal attacks (bishop, queen)
-    int diagonalDirs[4][2] = {{-1, -1}, {-1, 1}, {1, -1}, {1, 1}};
-    
-    for (int i = 0; i < 4; i++) {
-        int dx = diagonalDirs[i][0];
-        int dy = diagonalDirs[i][1];
-        int x = position.x + dx;
-        int y = position.y + dy;
-        
-        while (x >= 0 && x < 8 && y >= 0 && y < 8) {
-            unsigned char piece = board[x][y];
-            if (piece != NONE) {
-                if (((piece & TYPE_MASK) == BISHOP || (piece & TYPE_MASK) == QUEEN) && 
-                    ((piece & COLOR_MASK) >> 4) == attackerColor) {
-                    return true;
-                }
-                break;
-            }
-            x += dx;
-            y += dy;
+
+    // Castling: king and rook still carry MODIFIER (never moved), the squares between
+    // are empty and the king is not in check and doesn't pass through check
+    int i = SQUARE_ROW(square), j = SQUARE_COL(square);
+    if ((board[i][j] & MODIFIER) && j == 4 && !gen->checkers) {
+        // Kingside (short castle)
+        if ((board[i][7] & TYPE_MASK) == ROOK && ((board[i][7] & COLOR_MASK) >> 4) == color &&
+            (board[i][7] & MODIFIER) != 0 &&
+            board[i][5] == NONE && board[i][6] == NONE &&
+            !isSquareAttackedBB(&gen->bb, SQUARE(i, 5), enemy) &&
+            !isSquareAttackedBB(&gen->bb, SQUARE(i, 6), enemy)) {
+            destinations |= SQUARE_BIT(SQUARE(i, 6));
+        }
+        // Queenside (long castle)
+        if ((board[i][0] & TYPE_MASK) == ROOK && ((board[i][0] & COLOR_MASK) >> 4) == color &&
+            (board[i][0] & MODIFIER) != 0 &&
+            board[i][1] == NONE && board[i][2] == NONE && board[i][3] == NONE &&
+            !isSquareAttackedBB(&gen->bb, SQUARE(i, 3), enemy) &&
+            !isSquareAttackedBB(&gen->bb, SQUARE(i, 2), enemy)) {
+            destinations |= SQUARE_BIT(SQUARE(i, 2));
         }
     }
-    
-    // Check horizontal/vertical attacks (rook, queen)
-    int straightDirs[4][2] = {{-1, 0}, {1, 0}, {0, -1}, {0, 1}};
-    
-    for (int i = 0; i < 4; i++) {
-        int dx = straightDirs[i][0];
-        int dy = straightDirs[i][1];
-        int x = position.x + dx;
-        int y = position.y + dy;
-        
-        while (x >= 0 && x < 8 && y >= 0 && y < 8) {
-            unsigned char piece = board[x][y];
-            if (piece != NONE) {
-                if (((piece & TYPE_MASK) == ROOK || (piece & TYPE_MASK) == QUEEN) && 
-                    ((piece & COLOR_MASK) >> 4) == attackerColor) {
-                    return true;
+    return destinations;
+}
+
+Bitboard legalDestinations(const MoveGenContext* gen, unsigned char board[8][8], int square) {
+    unsigned char piece = board[SQUARE_ROW(square)][SQUARE_COL(square)];
+    unsigned char color = gen->color;
+    if ((piece & TYPE_MASK) == NONE || ((piece & COLOR_MASK) >> 4) != color) {
+        return 0;
+    }
+
+    const BoardBitboards* bb = &gen->bb;
+    Bitboard destinations = 0;
+    Bitboard enPassant = 0;
+
+    switch (piece & TYPE_MASK) {
+        case KING:
+            return kingDestinations(gen, board, square);
+        case PAWN: {
+            // White pawns move towards row 0
+            int direction = (color == 0) ? -8 : 8;
+            int startRow = (color == 0) ? 6 : 1;
+            int single = square + direction;
+            if (single >= 0 && single < 64 && !(bb->occupied & SQUARE_BIT(single))) {
+                destinations |= SQUARE_BIT(single);
+                if (SQUARE_ROW(square) == startRow && !(bb->occupied & SQUARE_BIT(single + direction))) {
+                    destinations |= SQUARE_BIT(single + direction);
                 }
-                break;
             }
-            x += dx;
-            y += dy;
-        }
-    }
-    
-    // Check king attacks
-    int kingMoves[8][2] = {
-        {-1, -1}, {-1, 0}, {-1, 1}, {0, -1},
-        {0, 1}, {1, -1}, {1, 0}, {1, 1}
-    };
-    
-    for (int i = 0; i < 8; i++) {
-        int nx = position.x + kingMoves[i][0];
-        int ny = position.y + kingMoves[i][1];
-        
-        if (nx >= 0 && nx < 8 && ny >= 0 && ny < 8) {
-            unsigned char piece = board[nx][ny];
-            if ((piece & TYPE_MASK) == KING && ((piece & COLOR_MASK) >> 4) == attackerColor) {
-                return true;
+            destinations |= pawnAttackTable[color][square] & bb->colors[color ^ 1];
+            if (gen->enPassantSquare >= 0 && (pawnAttackTable[color][square] & SQUARE_BIT(gen->enPassantSquare)) &&
+                isEnPassantLegal(gen, square)) {
+                enPassant = SQUARE_BIT(gen->enPassantSquare);
             }
+            break;
         }
+        case KNIGHT:
+            destinations = knightAttackTable[square] & ~bb->colors[color];
+            break;
+        case BISHOP:
+            destinations = bishopAttacks(square, bb->occupied) & ~bb->colors[color];
+            break;
+        case ROOK:
+            destinations = rookAttacks(square, bb->occupied) & ~bb->colors[color];
+            break;
+        case QUEEN:
+            destinations = queenAttacks(square, bb->occupied) & ~bb->colors[color];
+            break;
     }
-    
-    return false;
+
+    destinations &= gen->checkMask;
+    if (gen->pinned & SQUARE_BIT(square)) {
+        destinations &= lineTable[gen->kingSquare][square];
+    }
+    // Already checked in full, including when it takes the checking pawn
+    return destinations | enPassant;
 }
 
-// Check if the king is in check
-bool isKingInCheck(unsigned char board[8][8], Vector2f kingPosition, unsigned char color) {
-    return isCheck(board, kingPosition); // Use the isCheck function from Piece.c
+EngineMove createEngineMove(const MoveGenContext* gen, unsigned char board[8][8], int from, int to, unsigned char promotionPiece) {
+    int i = SQUARE_ROW(from), j = SQUARE_COL(from);
+    int x = SQUARE_ROW(to), y = SQUARE_COL(to);
+    unsigned char piece = board[i][j];
+    bool isPawn = (piece & TYPE_MASK) == PAWN;
+    unsigned char captured = board[x][y];
+    if (isPawn && to == gen->enPassantSquare) {
+        captured = board[SQUARE_ROW(gen->enPassantVictim)][SQUARE_COL(gen->enPassantVictim)];
+    }
+
+    bool isPromotion = isPawn && (x == 0 || x == 7);
+    EngineMove move = {{i, j}, {x, y}, captured, isPromotion, isPromotion ? (promotionPiece | (gen->color << 4)) : 0,
+                       (piece & MODIFIER) != 0, 0};
+    return move;
 }
 
-// Generate pseudo-legal moves (without checking if they leave king in check)
-void generatePseudoLegalMoves(unsigned char board[8][8], unsigned char color, MoveList* list, Vector2f* lastDoublePawn) {
-    list->count = 0;
-    
-    // Generate all possible moves for the given color
-    for (int i = 0; i < 8; i++) {
-        for (int j = 0; j < 8; j++) {
-            unsigned char piece = board[i][j];
-            if (piece == NONE || ((piece & COLOR_MASK) >> 4) != color) {
-                continue;
+// Append the moves of the piece on 'from' to each target, one per promotion piece where that applies
+static void addMoves(const MoveGenContext* gen, unsigned char board[8][8], int from, Bitboard targets, MoveList* list) {
+    bool isPawn = (board[SQUARE_ROW(from)][SQUARE_COL(from)] & TYPE_MASK) == PAWN;
+
+    while (targets) {
+        int to = popLowestSquare(&targets);
+        if (isPawn && (SQUARE_ROW(to) == 0 || SQUARE_ROW(to) == 7)) {
+            unsigned char promotionPieces[4] = {BISHOP, KNIGHT, ROOK, QUEEN};
+            for (int p = 0; p < 4; p++) {
+                list->moves[list->count++] = createEngineMove(gen, board, from, to, promotionPieces[p]);
             }
+        } else {
+            list->moves[list->count++] = createEngineMove(gen, board, from, to, NONE);
+        }
+    }
+}
 
-            // Check if the piece has a modifier flag (e.g., has moved before)
-            bool hasModifier = (piece & MODIFIER) != 0;
-            unsigned char pieceType = piece & TYPE_MASK;
-
-            // Generate moves based on piece type
-            switch (pieceType) {
-                case PAWN: {
-                    // Pawn movement direction depends on color
-                    int direction = (color == 0) ? -1 : 1;
-
-                    // Forward move (1 square)
-                    int newRow = i + direction;
-                    if (newRow >= 0 && newRow < 8 && board[newRow][j] == NONE) {
-                        // Check for promotion
-                        if (newRow == 0 || newRow == 7) {
-                            unsigned char promotionPieces[4] = {BISHOP, KNIGHT, ROOK, QUEEN};
-                            for (int p = 0; p < 4; p++) {
-                                EngineMove move = {{i, j}, {newRow, j}, NONE, true, promotionPieces[p] | (color << 4), hasModifier, 0};
-                                list->moves[list->count++] = move;
-                            }
-                        } else {
-                            // Regular move
-                            EngineMove move = {{i, j}, {newRow, j}, NONE, false, 0, hasModifier, 0};
-                            list->moves[list->count++] = move;
-                        }
+void generateStagedMoves(const MoveGenContext* gen, unsigned char board[8][8], GenStage stage, MoveList* list) {
+    list->count = 0;
+    Bitboard enemies = gen->bb.colors[gen->color ^ 1];
+    Bitboard pawns = gen->bb.pieces[gen->color][PAWN];
+    Bitboard pieces = gen->bb.colors[gen->color];
 
-                        // Forward move (2 squares) - only from starting position
-                        if ((color == 0 && i == 6) || (color == 1 && i == 1)) {
-                            int doubleRow = i + 2 * direction;
-                            if (board[doubleRow][j] == NONE && board[i + direction][j] == NONE) {
-                                EngineMove move = {{i, j}, {doubleRow, j}, NONE, false, 0, hasModifier, 0};
-                                list->moves[list->count++] = move;
-                            }
-                        }
-                    }
+    // Only the king can move in double check
+    if (gen->checkMask == 0 && gen->kingSquare >= 0) {
+        pieces = SQUARE_BIT(gen->kingSquare);
+    }
 
-                    // Diagonal captures
-                    for (int offset = -1; offset <= 1; offset += 2) {
-                        int newCol = j + offset;
-                        if (newRow >= 0 && newRow < 8 && newCol >= 0 && newCol < 8) {
-                            unsigned char targetPiece = board[newRow][newCol];
-                            
-                            // Normal capture
-                            if (targetPiece != NONE && ((targetPiece & COLOR_MASK) >> 4) != color) {
-                                // Check for promotion after capture
-                                if (newRow == 0 || newRow == 7) {
-                                    unsigned char promotionPieces[4] = {BISHOP, KNIGHT, ROOK, QUEEN};
-                                    for (int p = 0; p < 4; p++) {
-                                        EngineMove move = {{i, j}, {newRow, newCol}, targetPiece, true, promotionPieces[p] | (color << 4), hasModifier, 0};
-                                        list->moves[list->count++] = move;
-                                    }
-                                } else {
-                                    EngineMove move = {{i, j}, {newRow, newCol}, targetPiece, false, 0, hasModifier, 0};
-                                    list->moves[list->count++] = move;
-                                }
-                            }
-                            // En passant capture
-                            else if (targetPiece == NONE && lastDoublePawn && lastDoublePawn->x == i && lastDoublePawn->y == newCol) {
-                                EngineMove move = {{i, j}, {newRow, newCol}, board[i][newCol], false, 0, hasModifier, 0};
-                                list->moves[list->count++] = move;
-                            }
-                        }
-                    }
-                    break;
-                }
-                case KNIGHT: {
-                    int knightMoves[8][2] = {
-                        {-2, -1}, {-2, 1}, {-1, -2}, {-1, 2},
-                        {1, -2}, {1, 2}, {2, -1}, {2, 1}
-                    };
-                    
-                    for (int k = 0; k < 8; k++) {
-                        int nx = i + knightMoves[k][0];
-                        int ny = j + knightMoves[k][1];
-                        
-                        if (nx >= 0 && nx < 8 && ny >= 0 && ny < 8) {
-                            unsigned char targetPiece = board[nx][ny];
-                            if (targetPiece == NONE || ((targetPiece & COLOR_MASK) >> 4) != color) {
-                                EngineMove move = {{i, j}, {nx, ny}, targetPiece, false, 0, hasModifier, 0};
-                                list->moves[list->count++] = move;
-                            }
-                        }
-                    }
-                    break;
-                }
-                case BISHOP: {
-                    int directions[4][2] = {{-1, -1}, {-1, 1}, {1, -1}, {1, 1}};
-                    
-                    for (int d = 0; d < 4; d++) {
-                        for (int step = 1; step < 8; step++) {
-                            int x = i + directions[d][0] * step;
-                            int y = j + directions[d][1] * step;
-                            
-                            if (x < 0 || x >= 8 || y < 0 || y >= 8) {
-                                break;  // Out of bounds
-                            }
-                            
-                            unsigned char targetPiece = board[x][y];
-                            if (targetPiece == NONE) {
-                                EngineMove move = {{i, j}, {x, y}, targetPiece, false, 0, hasModifier, 0};
-                                list->moves[list->count++] = move;
-                            } else {
-                                if (((targetPiece & COLOR_MASK) >> 4) != color) {
-                                    EngineMove move = {{i, j}, {x, y}, targetPiece, false, 0, hasModifier, 0};
-                                    list->moves[list->count++] = move;
-                                }
-                                break;  // Can't move past a piece
-                            }
-                        }
-                    }
-                    break;
-                }
-                case ROOK: {
-                    int directions[4][2] = {{-1, 0}, {1, 0}, {0, -1}, {0, 1}};
-                    
-                    for (int d = 0; d < 4; d++) {
-                        for (int step = 1; step < 8; step++) {
-                            int x = i + directions[d][0] * step;
-                            int y = j + directions[d][1] * step;
-                            
-                            if (x < 0 || x >= 8 || y < 0 || y >= 8) {
-                                break;  // Out of bounds
-                            }
-                            
-                            unsigned char targetPiece = board[x][y];
-                            if (targetPiece == NONE) {
-                                EngineMove move = {{i, j}, {x, y}, targetPiece, false, 0, hasModifier, 0};
-                                list->moves[list->count++] = move;
-                            } else {
-                                if (((targetPiece & COLOR_MASK) >> 4) != color) {
-                                    EngineMove move = {{i, j}, {x, y}, targetPiece, false, 0, hasModifier, 0};
-                                    list->moves[list->count++] = move;
-                                }
-                                break;  // Can't move past a piece
-                            }
-                        }
-                    }
-                    break;
-                }
-                case QUEEN: {
-                    int directions[8][2] = {
-                        {-1, -1}, {-1, 0}, {-1, 1},
-                        {0, -1},           {0, 1},
-                        {1, -1},  {1, 0},  {1, 1}
-                    };
-                    
-                    for (int d = 0; d < 8; d++) {
-                        for (int step = 1; step < 8; step++) {
-                            int x = i + directions[d][0] * step;
-                            int y = j + directions[d][1] * step;
-                            
-                            if (x < 0 || x >= 8 || y < 0 || y >= 8) {
-                                break;  // Out of bounds
-                            }
-                            
-                            unsigned char targetPiece = board[x][y];
-                            if (targetPiece == NONE) {
-                                EngineMove move = {{i, j}, {x, y}, targetPiece, false, 0, hasModifier, 0};
-                                list->moves[list->count++] = move;
-                            } else {
-                                if (((targetPiece & COLOR_MASK) >> 4) != color) {
-                                    EngineMove move = {{i, j}, {x, y}, targetPiece, false, 0, hasModifier, 0};
-                                    list->moves[list->count++] = move;
-                                }
-                                break;  // Can't move past a piece
-                            }
-                        }
-                    }
-                    break;
-                }
-                case KING: {
-                    int kingMoves[8][2] = {
-                        {-1, -1}, {-1, 0}, {-1, 1},
-                        {0, -1},           {0, 1},
-                        {1, -1},  {1, 0},  {1, 1}
-                    };
-                    
-                    for (int k = 0; k < 8; k++) {
-                        int nx = i + kingMoves[k][0];
-                        int ny = j + kingMoves[k][1];
-                        
-                        if (nx >= 0 && nx < 8 && ny >= 0 && ny < 8) {
-                            unsigned char targetPiece = board[nx][ny];
-                            if (targetPiece == NONE || ((targetPiece & COLOR_MASK) >> 4) != color) {
-                                EngineMove move = {{i, j}, {nx, ny}, targetPiece, false, 0, hasModifier, 0};
-                                list->moves[list->count++] = move;
-                            }
-                        }
-                    }
-                    
-                    // TODO: Add castling moves
-                    break;
-                }
+    while (pieces) {
+        int from = popLowestSquare(&pieces);
+        Bitboard destinations = legalDestinations(gen, board, from);
+        if (stage != GEN_ALL) {
+            Bitboard captures = destinations & enemies;
+            if (pawns & SQUARE_BIT(from)) {
+                captures |= destinations & (PROMOTION_ROWS | (gen->enPassantSquare >= 0 ? SQUARE_BIT(gen->enPassantSquare) : 0));
             }
+            destinations = (stage == GEN_CAPTURES) ? captures : (destinations & ~captures);
         }
+        addMoves(gen, board, from, destinations, list);
     }
 }
 
-// Check if a move is legal (doesn't leave king in check)
-bool isLegalMove(unsigned char board[8][8], EngineMove move, unsigned char color, Vector2f* lastDoublePawn, Vector2f* kings) {
-    unsigned char tempBoard[8][8];
-    Vector2f tempLastDoublePawn = lastDoublePawn ? *lastDoublePawn : (Vector2f){-1, -1};
-    Vector2f tempKings[2] = {kings[0], kings[1]};
+void generateLegalDestinations(unsigned char board[8][8], unsigned char color, Vector2f* lastDoublePawn, Bitboard destinations[64]) {
+    MoveGenContext gen;
+    initMoveGen(&gen, board, color, lastDoublePawn);
+    memset(destinations, 0, 64 * sizeof(Bitboard));
 
-    // Make the move on the temporary board
-    engineMakeMove(tempBoard, move, &tempLastDoublePawn, tempKings, 0);
+    Bitboard pieces = gen.bb.colors[color];
+    while (pieces) {
+        int square = popLowestSquare(&pieces);
+        destinations[square] = legalDestinations(&gen, board, square);
+    }
+}
 
-    // Check if the king is in check after the move
-    return !isKingInCheck(tempBoard, tempKings[color], color);
+int countLegalMoves(const MoveGenContext* gen, unsigned char board[8][8]) {
+    int count = 0;
+    Bitboard pieces = gen->bb.colors[gen->color];
+    Bitboard pawns = gen->bb.pieces[gen->color][PAWN];
+    while (pieces) {
+        int from = popLowestSquare(&pieces);
+        Bitboard destinations = legalDestinations(gen, board, from);
+        count += popCount(destinations);
+        // Four moves per promotion, as generateStagedMoves lists them
+        if (pawns & SQUARE_BIT(from)) {
+            count += 3 * popCount(destinations & PROMOTION_ROWS);
+        }
+    }
+    return count;
 }
 
 // Generate all legal moves
 void generateLegalMoves(unsigned char board[8][8], unsigned char color, MoveList* list, Vector2f* lastDoublePawn, Vector2f kings[]) {
-    MoveList pseudoLegalMoves;
-    generatePseudoLegalMoves(board, color, &pseudoLegalMoves, lastDoublePawn);
-
-    // Filter out moves that leave the king in check
-    list->count = 0;
-    for (int i = 0; i < pseudoLegalMoves.count; i++) {
-        if (isLegalMove(board, pseudoLegalMoves.moves[i], color, lastDoublePawn, kings)) {
-            list->moves[list->count++] = pseudoLegalMoves.moves[i];
-        }
-    }
+    MoveGenContext gen;
+    initMoveGen(&gen, board, color, lastDoublePawn);
+    generateStagedMoves(&gen, board, GEN_ALL, list);
 }
 
 // Make a move on the board and update lastDoublePawn if needed
-// isRealMove should be true for actual moves on the board, false for AI calculations
+// isRealMove is true for actual moves on the board, false for AI calculations; both are made alike
 void engineMakeMove(unsigned char board[8][8], EngineMove move, Vector2f* lastDoublePawn, Vector2f kings[], int isRealMove) {
+    (void)isRealMove;
     unsigned char movingPiece = board[(int)move.from.x][(int)move.from.y];
     unsigned char pieceType = movingPiece & TYPE_MASK;
     unsigned char color = (movingPiece & COLOR_MASK) >> 4;
@@ -564,16 +436,10 @@ void engineMakeMove(unsigned char board[8][8], EngineMove move, Vector2f* lastDo
     }
 
     // Handle pawn double push
+    // lastDoublePawn is tracked for search moves too, otherwise en passant goes stale inside the tree
     if (pieceType == PAWN && abs(move.to.x - move.from.x) == 2) {
-        // Only update lastDoublePawn if this is a real move
-        if (isRealMove) {
-            lastDoublePawn->x = move.to.y; // Column of the pawn
-            lastDoublePawn->y = move.to.x; // Row of the pawn
-            // Only print debug info when an actual move is made (not during initialization)
-            if (board[move.from.x][move.from.y] != NONE) {
-                printf("Double pawn push detected: lastDoublePawn set to (%d, %d)\n", (int)lastDoublePawn->x, (int)lastDoublePawn->y);
-            }
-        }
+        lastDoublePawn->x = move.to.y; // Column of the pawn
+        lastDoublePawn->y = move.to.x; // Row of the pawn
     } else {
         // Handle en passant capture
         if (pieceType == PAWN && 
@@ -583,20 +449,17 @@ void engineMakeMove(unsigned char board[8][8], EngineMove move, Vector2f* lastDo
             lastDoublePawn->y == move.from.x) { // Row of the capturing pawn
             
             // Remove the captured pawn
-            printf("En passant capture executed: removing pawn at (%d, %d)\n", (int)move.from.x, (int)move.to.y);
             board[move.from.x][move.to.y] = NONE;
         }
         
-        // Reset lastDoublePawn after any move that's not a double push, but only for real moves
-        if (isRealMove) {
+        // Reset lastDoublePawn after any move that's not a double push
         lastDoublePawn->x = -1;
         lastDoublePawn->y = -1;
-        }
     }
 
     // Update king position if the king moves
     if (pieceType == KING) {
-        kings[0] = move.to;
+        kings[color] = move.to;
         
         // Handle castling
         if (abs(move.to.y - move.from.y) == 2) {
@@ -638,10 +501,219 @@ void engineMakeMove(unsigned char board[8][8], EngineMove move, Vector2f* lastDo
     // Handle promotion (already handled in newPiece calculation)
 }
 
+/*==========
+Position hashing and draw rules
+==========*/
+
+// Keys indexed by the whole piece byte (type, MODIFIER and color), so castling rights are part of the hash
+static uint64_t zobristPieces[PIECE_MASK + 1][8][8];
+static uint64_t zobristBlackToMove;
+static uint64_t zobristEnPassant[8];
+
+// Fixed seed, so hashes are the same in every run
+static uint64_t nextRandom(uint64_t* state) {
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    return *state;
+}
+
+static void initZobrist() {
+    uint64_t state = 0x9E3779B97F4A7C15ULL;
+    for (int piece = 0; piece <= PIECE_MASK; piece++) {
+        for (int i = 0; i < 8; i++) {
+            for (int j = 0; j < 8; j++) {
+                zobristPieces[piece][i][j] = ((piece & TYPE_MASK) == NONE) ? 0 : nextRandom(&state);
+            }
+        }
+    }
+    zobristBlackToMove = nextRandom(&state);
+    for (int i = 0; i < 8; i++) {
+        zobristEnPassant[i] = nextRandom(&state);
+    }
+}
+
+uint64_t hashPosition(unsigned char board[8][8], unsigned char color, Vector2f* lastDoublePawn) {
+    uint64_t hash = 0;
+    for (int i = 0; i < 8; i++) {
+        for (int j = 0; j < 8; j++) {
+            hash ^= zobristPieces[board[i][j]][i][j];
+        }
+    }
+    if (color == 1) {
+        hash ^= zobristBlackToMove;
+    }
+
+    // The en passant file only matters when a pawn can actually take
+    if (lastDoublePawn && lastDoublePawn->x >= 0) {
+        int row = lastDoublePawn->y, col = lastDoublePawn->x;
+        unsigned char capturer = PAWN | (color << 4);
+        if ((col > 0 && (board[row][col - 1] & (TYPE_MASK | COLOR_MASK)) == capturer) ||
+            (col < 7 && (board[row][col + 1] & (TYPE_MASK | COLOR_MASK)) == capturer)) {
+            hash ^= zobristEnPassant[col];
+        }
+    }
+    return hash;
+}
+
+void resetPositionHistory(PositionHistory* history, unsigned char board[8][8], unsigned char color, Vector2f* lastDoublePawn, int halfmoveClock) {
+    history->hashes[0] = hashPosition(board, color, lastDoublePawn);
+    history->count = 1;
+    history->halfmoveClock = halfmoveClock;
+}
+
+void recordPosition(PositionHistory* history, unsigned char board[8][8], unsigned char color, Vector2f* lastDoublePawn, bool irreversible) {
+    if (irreversible) {
+        resetPositionHistory(history, board, color, lastDoublePawn, 0);
+        return;
+    }
+
+    // Past the fifty-move rule the oldest positions are no longer needed
+    if (history->count == MAX_GAME_POSITIONS) {
+        memmove(&history->hashes[0], &history->hashes[1], (MAX_GAME_POSITIONS - 1) * sizeof(uint64_t));
+        history->count--;
+    }
+    history->hashes[history->count++] = hashPosition(board, color, lastDoublePawn);
+    history->halfmoveClock++;
+}
+
+// Lone kings, or a single minor piece against a bare king
+bool isInsufficientMaterial(unsigned char board[8][8]) {
+    int minorPieces = 0;
+    for (int i = 0; i < 8; i++) {
+        for (int j = 0; j < 8; j++) {
+            switch (board[i][j] & TYPE_MASK) {
+                case PAWN:
+                case ROOK:
+                case QUEEN:
+                    return false;
+                case BISHOP:
+                case KNIGHT:
+                    if (++minorPieces > 1) return false;
+                    break;
+            }
+        }
+    }
+    return true;
+}
+
+// Occurrences of the last position among the earlier ones (only the same side to move can match)
+static int countRepetitions(const uint64_t* hashes, int count, int halfmoveClock) {
+    int repetitions = 0;
+    int oldest = count - 1 - halfmoveClock;
+    for (int i = count - 3; i >= 0 && i >= oldest; i -= 2) {
+        if (hashes[i] == hashes[count - 1]) {
+            repetitions++;
+        }
+    }
+    return repetitions;
+}
+
+DrawReason getDrawReason(unsigned char board[8][8], const PositionHistory* history) {
+    if (history && countRepetitions(history->hashes, history->count, history->halfmoveClock) >= 2) {
+        return DRAW_REPETITION;
+    }
+    if (history && history->halfmoveClock >= FIFTY_MOVE_PLIES) {
+        return DRAW_FIFTY_MOVES;
+    }
+    if (isInsufficientMaterial(board)) {
+        return DRAW_INSUFFICIENT_MATERIAL;
+    }
+    return DRAW_NONE;
+}
+
+/*==========
+Transposition table
+==========*/
+
+#define TT_EXACT 0
+#define TT_LOWER_BOUND 1
+#define TT_UPPER_BOUND 2
+#define NO_SQUARE 0xFF
+
+bool initTranspositionTable(TranspositionTable* tt, int sizeMB) {
+    size_t count = 1;
+    while (count * 2 * sizeof(TTEntry) <= (size_t)sizeMB * 1024 * 1024) {
+        count *= 2;
+    }
+    tt->entries = calloc(count, sizeof(TTEntry));
+    if (!tt->entries) {
+        fprintf(stderr, "Error: Could not allocate a %d MB transposition table\n", sizeMB);
+        tt->mask = 0;
+        return false;
+    }
+    tt->mask = count - 1;
+    return true;
+}
+
+void clearTranspositionTable(TranspositionTable* tt) {
+    if (tt->entries) {
+        memset(tt->entries, 0, (tt->mask + 1) * sizeof(TTEntry));
+    }
+}
+
+void freeTranspositionTable(TranspositionTable* tt) {
+    free(tt->entries);
+    tt->entries = NULL;
+    tt->mask = 0;
+}
+
+// Mate scores are stored relative to the node, not the root, so they stay valid at any ply
+static int scoreToTT(int score, int ply) {
+    if (score >= MATE_SCORE - 2 * MAX_PV_LENGTH) return score + ply;
+    if (score <= -MATE_SCORE + 2 * MAX_PV_LENGTH) return score - ply;
+    return score;
+}
+
+static int scoreFromTT(int score, int ply) {
+    if (score >= MATE_SCORE - 2 * MAX_PV_LENGTH) return score - ply;
+    if (score <= -MATE_SCORE + 2 * MAX_PV_LENGTH) return score + ply;
+    return score;
+}
+
+static TTEntry* probeTT(TranspositionTable* tt, uint64_t key) {
+    if (!tt || !tt->entries) return NULL;
+    TTEntry* entry = &tt->entries[key & tt->mask];
+    return entry->key == key ? entry : NULL;
+}
+
+// Keep a deeper result for the same position, otherwise always replace
+static void storeTT(TranspositionTable* tt, uint64_t key, int depth, int score, int flag, int ply, const EngineMove* move) {
+    if (!tt || !tt->entries) return;
+    TTEntry* entry = &tt->entries[key & tt->mask];
+    if (entry->key == key && entry->depth > depth) return;
+
+    entry->key = key;
+    entry->score = (short)scoreToTT(score, ply);
+    entry->depth = (signed char)depth;
+    entry->flag = (unsigned char)flag;
+    if (move) {
+        entry->from = (unsigned char)(move->from.x * 8 + move->from.y);
+        entry->to = (unsigned char)(move->to.x * 8 + move->to.y);
+        entry->promotionPiece = move->isPromotion ? (move->promotionPiece & TYPE_MASK) : NONE;
+    } else {
+        entry->from = entry->to = NO_SQUARE;
+        entry->promotionPiece = NONE;
+    }
+}
+
+// Index of the table's move in the list, or -1
+static int findTTMove(const TTEntry* entry, const MoveList* list) {
+    if (!entry || entry->from == NO_SQUARE) return -1;
+    for (int i = 0; i < list->count; i++) {
+        const EngineMove* move = &list->moves[i];
+        if (move->from.x * 8 + move->from.y == entry->from && move->to.x * 8 + move->to.y == entry->to &&
+            (!move->isPromotion || (move->promotionPiece & TYPE_MASK) == entry->promotionPiece)) {
+            return i;
+        }
+    }
+    return -1;
+}
+
 // Evaluation Functions
 
 // Material evaluation
-int evaluateMaterial(unsigned char board[8][8]) {
+int evaluateMaterial(unsigned char board[8][8], const EvalParams* params, EvalTrace* trace) {
     int score = 0;
     
     for (int i = 0; i < 8; i++) {
@@ -651,33 +723,18 @@ int evaluateMaterial(unsigned char board[8][8]) {
 
             if (piece == NONE) continue;
 
-            int value = 0;
-            switch (piece) {
-                case PAWN:
-                    value = PAWN_VALUE;
-                    break;
-                case KNIGHT:
-                    value = KNIGHT_VALUE;
-                    break;
-                case BISHOP:
-                    value = BISHOP_VALUE;
-                    break;
-                case ROOK:
-                    value = ROOK_VALUE;
-                    break;
-                case QUEEN:
-                    value = QUEEN_VALUE;
-                    break;
-                case KING:
-                    value = KING_VALUE;
-                    break;
-            }
+            int value = params->pieceValue[piece];
 
             if (color == 1) {
                 value = -value;
             }
 
             score += value;
+
+            // Kings always cancel out, so they carry no information for the tuner
+            if (piece != KING) {
+                traceAdd(trace, PARAM_INDEX(pieceValue) + piece, color == 1 ? -1.0f : 1.0f);
+            }
         }
     }
     
@@ -685,28 +742,29 @@ int evaluateMaterial(unsigned char board[8][8]) {
 }
 
 // Mobility evaluation (count legal moves)
-int evaluateMobility(unsigned char board[8][8], unsigned char color) {
-    MoveList moveList;
-    Vector2f lastDoublePawn = {-1, -1};
-    Vector2f kings[2];
-    findKings(board, kings);
-    
-    // Generate moves for white
-    generateLegalMoves(board, 0, &moveList, &lastDoublePawn, kings);
-    int whiteMobility = moveList.count;
-    
-    // Generate moves for black
-    generateLegalMoves(board, 1, &moveList, &lastDoublePawn, kings);
-    int blackMobility = moveList.count;
-    
+int evaluateMobility(unsigned char board[8][8], const EvalParams* params, EvalTrace* trace) {
+    MoveGenContext gen;
+
+    // Count moves for white
+    initMoveGen(&gen, board, 0, NULL);
+    int whiteMobility = countLegalMoves(&gen, board);
+
+    // Count moves for black
+    initMoveGen(&gen, board, 1, NULL);
+    int blackMobility = countLegalMoves(&gen, board);
+
+    traceAdd(trace, PARAM_INDEX(mobilityWeight), (float)(whiteMobility - blackMobility));
+
     // Return mobility difference (positive for white advantage)
-    return (whiteMobility - blackMobility) * 5; // 5 centipawns per move advantage
+    return (whiteMobility - blackMobility) * params->mobilityWeight;
 }
 
 // King safety evaluation
-int evaluateKingSafety(unsigned char board[8][8], unsigned char color, Vector2f kings[]) {
-    int whiteKingSafety = 0;
-    int blackKingSafety = 0;
+int evaluateKingSafety(unsigned char board[8][8], Vector2f kings[], const EvalParams* params, EvalTrace* trace) {
+    // Counts of each king safety term, white minus black
+    int centerCount = 0;
+    int shieldCount = 0;
+    int checkCount = 0;
     
     // Check if kings are castled or in the center
     Vector2f whiteKing = kings[0];
@@ -714,11 +772,11 @@ int evaluateKingSafety(unsigned char board[8][8], unsigned char color, Vector2f
     
     // Penalize kings in the center
     if (whiteKing.y >= 2 && whiteKing.y <= 5 && whiteKing.x < 7) {
-        whiteKingSafety -= 30;
+        centerCount++;
     }
     
     if (blackKing.y >= 2 && blackKing.y <= 5 && blackKing.x > 0) {
-        blackKingSafety -= 30;
+        centerCount--;
     }
     
     // Check pawn shield for white king
@@ -727,7 +785,7 @@ int evaluateKingSafety(unsigned char board[8][8], unsigned char color, Vector2f
             if (j >= 0 && j < 8) {
                 if (board[6][j] != NONE && (board[6][j] & TYPE_MASK) == PAWN && 
                     ((board[6][j] & COLOR_MASK) >> 4) == 0) {
-                    whiteKingSafety += 15; // Pawn shield bonus
+                    shieldCount++; // Pawn shield bonus
                 }
             }
         }
@@ -739,7 +797,7 @@ int evaluateKingSafety(unsigned char board[8][8], unsigned char color, Vector2f
             if (j >= 0 && j < 8) {
                 if (board[1][j] != NONE && (board[1][j] & TYPE_MASK) == PAWN && 
                     ((board[1][j] & COLOR_MASK) >> 4) == 1) {
-                    blackKingSafety += 15; // Pawn shield bonus
+                    shieldCount--; // Pawn shield bonus
                 }
             }
         }
@@ -747,20 +805,29 @@ int evaluateKingSafety(unsigned char board[8][8], unsigned char color, Vector2f
     
     // Check if king is in check
     if (isKingInCheck(board, kings[0], 0)) {
-        whiteKingSafety -= 50;
+        checkCount++;
     }
     
     if (isKingInCheck(board, kings[1], 1)) {
-        blackKingSafety -= 50;
+        checkCount--;
     }
     
-    return whiteKingSafety - blackKingSafety;
+    traceAdd(trace, PARAM_INDEX(kingCenterPenalty), (float)-centerCount);
+    traceAdd(trace, PARAM_INDEX(kingPawnShieldBonus), (float)shieldCount);
+    traceAdd(trace, PARAM_INDEX(kingInCheckPenalty), (float)-checkCount);
+
+    return -centerCount * params->kingCenterPenalty +
+           shieldCount * params->kingPawnShieldBonus -
+           checkCount * params->kingInCheckPenalty;
 }
 
 // Pawn structure evaluation
-int evaluatePawnStructure(unsigned char board[8][8], unsigned char color) {
-    int whiteScore = 0;
-    int blackScore = 0;
+int evaluatePawnStructure(unsigned char board[8][8], const EvalParams* params, EvalTrace* trace) {
+    // Counts of each pawn structure term, white minus black
+    int passedCount = 0;
+    int passedRanks = 0;
+    int doubledCount = 0;
+    int isolatedCount = 0;
     
     // Count pawns in each file for doubled pawns detection
     int whitePawnsInFile[8] = {0};
@@ -791,7 +858,8 @@ int evaluatePawnStructure(unsigned char board[8][8], unsigned char color) {
                     }
                     
                     if (passed) {
-                        whiteScore += 30 + (7 - i) * 10; // More bonus as pawn advances
+                        passedCount++;
+                        passedRanks += 7 - i; // More bonus as pawn advances
                     }
                     
                 } else { // Black pawn
@@ -805,7 +873,7 @@ int evaluatePawnStructure(unsigned char board[8][8], unsigned char color) {
                                 if ((board[r][c] & TYPE_MASK) == PAWN && 
                                     ((board[r][c] & COLOR_MASK) >> 4) == 0) {
                                     passed = false;
-                break;
+                                    break;
                                 }
                             }
                         }
@@ -813,7 +881,8 @@ int evaluatePawnStructure(unsigned char board[8][8], unsigned char color) {
                     }
                     
                     if (passed) {
-                        blackScore += 30 + i * 10; // More bonus as pawn advances
+                        passedCount--;
+                        passedRanks -= i; // More bonus as pawn advances
                     }
                 }
             }
@@ -823,10 +892,10 @@ int evaluatePawnStructure(unsigned char board[8][8], unsigned char color) {
     // Penalize doubled pawns
     for (int j = 0; j < 8; j++) {
         if (whitePawnsInFile[j] > 1) {
-            whiteScore -= 15 * (whitePawnsInFile[j] - 1);
+            doubledCount += whitePawnsInFile[j] - 1;
         }
         if (blackPawnsInFile[j] > 1) {
-            blackScore -= 15 * (blackPawnsInFile[j] - 1);
+            doubledCount -= blackPawnsInFile[j] - 1;
         }
     }
     
@@ -838,7 +907,7 @@ int evaluatePawnStructure(unsigned char board[8][8], unsigned char color) {
             if (j < 7 && whitePawnsInFile[j + 1] > 0) isolated = false;
             
             if (isolated) {
-                whiteScore -= 20;
+                isolatedCount++;
             }
         }
         
@@ -848,16 +917,24 @@ int evaluatePawnStructure(unsigned char board[8][8], unsigned char color) {
             if (j < 7 && blackPawnsInFile[j + 1] > 0) isolated = false;
             
             if (isolated) {
-                blackScore -= 20;
+                isolatedCount--;
             }
         }
     }
     
-    return whiteScore - blackScore;
+    traceAdd(trace, PARAM_INDEX(passedPawnBonus), (float)passedCount);
+    traceAdd(trace, PARAM_INDEX(passedPawnRankBonus), (float)passedRanks);
+    traceAdd(trace, PARAM_INDEX(doubledPawnPenalty), (float)-doubledCount);
+    traceAdd(trace, PARAM_INDEX(isolatedPawnPenalty), (float)-isolatedCount);
+
+    return passedCount * params->passedPawnBonus +
+           passedRanks * params->passedPawnRankBonus -
+           doubledCount * params->doubledPawnPenalty -
+           isolatedCount * params->isolatedPawnPenalty;
 }
 
 // Piece-square table evaluation
-int evaluatePieceSquareTables(unsigned char board[8][8], unsigned char color, int phase) {
+int evaluatePieceSquareTables(unsigned char board[8][8], int phase, const EvalParams* params, EvalTrace* trace) {
     int score = 0;
     
     for (int i = 0; i < 8; i++) {
@@ -871,72 +948,55 @@ int evaluatePieceSquareTables(unsigned char board[8][8], unsigned char color, in
             int row = (pieceColor == 1) ? i : 7 - i;
             int col = (pieceColor == 1) ? j : 7 - j;
             
-            int mgScore = 0;
-            int egScore = 0;
-            
-            switch (piece) {
-                case PAWN:
-                    mgScore = pawnTableMG[row][col];
-                    egScore = pawnTableEG[row][col];
-                    break;
-                case KNIGHT:
-                    mgScore = knightTableMG[row][col];
-                    egScore = knightTableEG[row][col];
-                    break;
-                case BISHOP:
-                    mgScore = bishopTableMG[row][col];
-                    egScore = bishopTableEG[row][col];
-                    break;
-                case ROOK:
-                    mgScore = rookTableMG[row][col];
-                    egScore = rookTableEG[row][col];
-                    break;
-                case QUEEN:
-                    mgScore = queenTableMG[row][col];
-                    egScore = queenTableEG[row][col];
-                    break;
-                case KING:
-                    mgScore = kingTableMG[row][col];
-                    egScore = kingTableEG[row][col];
-                    break;
-            }
+            int mgScore = params->pstMG[piece][row][col];
+            int egScore = params->pstEG[piece][row][col];
             
             // Interpolate between middlegame and endgame scores based on phase
             int positionScore = (mgScore * phase + egScore * (256 - phase)) / 256;
             
             // Adjust score based on piece color
+            float sign = 1.0f;
             if (pieceColor == 1) {
                 positionScore = -positionScore;
+                sign = -1.0f;
             }
             
             score += positionScore;
+
+            int square = (piece * 8 + row) * 8 + col;
+            traceAdd(trace, PARAM_INDEX(pstMG) + square, sign * phase / 256.0f);
+            traceAdd(trace, PARAM_INDEX(pstEG) + square, sign * (256 - phase) / 256.0f);
         }
     }
     
     return score;
 }
 
-// Main evaluation function
-int evaluatePosition(unsigned char board[8][8], unsigned char color) {
+// Full evaluation with explicit weights (positive for white advantage)
+int evaluateWithParams(unsigned char board[8][8], const EvalParams* params, EvalTrace* trace) {
     Vector2f kings[2];
     findKings(board, kings);
     
+    if (trace) {
+        memset(trace, 0, sizeof(EvalTrace));
+    }
+
     int phase = getPhase(board);
     
     // Material evaluation (most important)
-    int materialScore = evaluateMaterial(board);
+    int materialScore = evaluateMaterial(board, params, trace);
     
     // Piece-square tables
-    int pstScore = evaluatePieceSquareTables(board, color, phase);
+    int pstScore = evaluatePieceSquareTables(board, phase, params, trace);
     
     // Mobility evaluation
-    int mobilityScore = evaluateMobility(board, color);
+    int mobilityScore = evaluateMobility(board, params, trace);
     
     // King safety
-    int kingSafetyScore = evaluateKingSafety(board, color, kings);
+    int kingSafetyScore = evaluateKingSafety(board, kings, params, trace);
     
     // Pawn structure
-    int pawnStructureScore = evaluatePawnStructure(board, color);
+    int pawnStructureScore = evaluatePawnStructure(board, params, trace);
     
     // Combine all evaluation terms
     int totalScore = materialScore + 
@@ -948,6 +1008,12 @@ int evaluatePosition(unsigned char board[8][8], unsigned char color) {
     return totalScore;
 }
 
+// Main evaluation function, from white's point of view whichever side is to move
+int evaluatePosition(unsigned char board[8][8], unsigned char color) {
+    (void)color;
+    return evaluateWithParams(board, &evalParams, NULL);
+}
+
 // Function to get the relative score (positive for white advantage, negative for black)
 int getRelativeScore(unsigned char board[8][8]) {
     // Evaluate from white's perspective
@@ -991,125 +1057,624 @@ int min(int a, int b) {
     return (a < b) ? a : b;
 }
 
-int minimax(unsigned char board[8][8], int depth, int alpha, int beta, bool maximizing, unsigned char color, Vector2f* lastDoublePawn, Vector2f* kings) {
-    // Base case: if we've reached the maximum depth or the game is over
-    if (depth == 0) {
-        return evaluatePosition(board, maximizing ? color : color ^ 0x10);
+// State of one search. Each search owns its context, so several can run in parallel.
+typedef struct {
+    const EvalParams* params;
+    Uint32 startTime;
+    int timeLimitMs;
+    long long nodes;
+    bool stopped;
+    TranspositionTable* tt;
+    SDL_atomic_t* stopFlag;
+
+    // Repetition stack: the game so far followed by the current search path
+    uint64_t hashes[MAX_GAME_POSITIONS + MAX_PV_LENGTH + 1];
+    int hashCount;
+} SearchContext;
+
+// Piece values used for move ordering only
+static const int orderValue[7] = {0, PAWN_VALUE, BISHOP_VALUE, KNIGHT_VALUE, ROOK_VALUE, QUEEN_VALUE, KING_VALUE};
+
+// Score from the point of view of the side to move
+static int evaluateForSide(unsigned char board[8][8], unsigned char color, const EvalParams* params) {
+    int score = evaluateWithParams(board, params, NULL);
+    return (color == 0) ? score : -score;
+}
+
+// Captures first (most valuable victim, least valuable attacker), then promotions
+static void orderMoves(unsigned char board[8][8], MoveList* list) {
+    int scores[MAX_MOVES_PER_POSITION];
+    for (int i = 0; i < list->count; i++) {
+        EngineMove* move = &list->moves[i];
+        scores[i] = 0;
+        if (move->capturedPiece != NONE) {
+            scores[i] += 10 * orderValue[move->capturedPiece & TYPE_MASK] -
+                         orderValue[board[move->from.x][move->from.y] & TYPE_MASK] / 100;
+        }
+        if (move->isPromotion) {
+            scores[i] += orderValue[move->promotionPiece & TYPE_MASK];
+        }
     }
 
-    MoveList moveList;
-    generateLegalMoves(board, color, &moveList, lastDoublePawn, kings);
+    // Insertion sort, highest score first (lists are short)
+    for (int i = 1; i < list->count; i++) {
+        EngineMove move = list->moves[i];
+        int score = scores[i];
+        int j = i - 1;
+        while (j >= 0 && scores[j] < score) {
+            list->moves[j + 1] = list->moves[j];
+            scores[j + 1] = scores[j];
+            j--;
+        }
+        list->moves[j + 1] = move;
+        scores[j + 1] = score;
+    }
+}
 
-    // Check for checkmate or stalemate
-    if (moveList.count == 0) {
-        if (isKingInCheck(board, kings[color], color)) {
-            return maximizing ? -10000 : 10000; // Checkmate
-        } else {
-            return 0; // Stalemate
+// Hands out a node's moves in stages: the table's move, then captures and promotions, then
+// quiet moves, or every evasion at once when in check. A cutoff skips the later stages.
+typedef enum {
+    PICK_HASH_MOVE,
+    PICK_GENERATE_CAPTURES,
+    PICK_CAPTURES,
+    PICK_GENERATE_QUIETS,
+    PICK_QUIETS,
+    PICK_DONE
+} PickStage;
+
+typedef struct {
+    MoveGenContext gen;
+    EngineMove hashMove;
+    bool hasHashMove;
+    MoveList moves;
+    int index;
+    PickStage stage;
+} MovePicker;
+
+static bool isSameMove(const EngineMove* a, const EngineMove* b) {
+    return a->from.x == b->from.x && a->from.y == b->from.y && a->to.x == b->to.x && a->to.y == b->to.y &&
+           (a->promotionPiece & TYPE_MASK) == (b->promotionPiece & TYPE_MASK);
+}
+
+static void initMovePicker(MovePicker* picker, unsigned char board[8][8], unsigned char color, Vector2f* lastDoublePawn, const TTEntry* entry) {
+    initMoveGen(&picker->gen, board, color, lastDoublePawn);
+    picker->stage = PICK_HASH_MOVE;
+    picker->hasHashMove = false;
+    picker->moves.count = 0;
+    picker->index = 0;
+
+    // The table's move is only trusted once it is known to be legal here (keys can collide)
+    if (entry && entry->from != NO_SQUARE &&
+        (legalDestinations(&picker->gen, board, entry->from) & SQUARE_BIT(entry->to))) {
+        picker->hashMove = createEngineMove(&picker->gen, board, entry->from, entry->to, entry->promotionPiece);
+        picker->hasHashMove = !picker->hashMove.isPromotion || entry->promotionPiece != NONE;
+    }
+}
+
+static bool nextMove(MovePicker* picker, unsigned char board[8][8], EngineMove* move) {
+    while (true) {
+        switch (picker->stage) {
+            case PICK_HASH_MOVE:
+                picker->stage = PICK_GENERATE_CAPTURES;
+                if (picker->hasHashMove) {
+                    *move = picker->hashMove;
+                    return true;
+                }
+                break;
+            case PICK_GENERATE_CAPTURES:
+                generateStagedMoves(&picker->gen, board, picker->gen.checkers ? GEN_ALL : GEN_CAPTURES, &picker->moves);
+                orderMoves(board, &picker->moves);
+                picker->index = 0;
+                picker->stage = PICK_CAPTURES;
+                break;
+            case PICK_GENERATE_QUIETS:
+                generateStagedMoves(&picker->gen, board, GEN_QUIETS, &picker->moves);
+                picker->index = 0;
+                picker->stage = PICK_QUIETS;
+                break;
+            case PICK_CAPTURES:
+            case PICK_QUIETS:
+                while (picker->index < picker->moves.count) {
+                    EngineMove* candidate = &picker->moves.moves[picker->index++];
+                    if (!picker->hasHashMove || !isSameMove(candidate, &picker->hashMove)) {
+                        *move = *candidate;
+                        return true;
+                    }
+                }
+                picker->stage = (picker->stage == PICK_CAPTURES && !picker->gen.checkers) ? PICK_GENERATE_QUIETS : PICK_DONE;
+                break;
+            default:
+                return false;
         }
     }
-    
-    // Make a temporary copy of the board and kings
+}
+
+// Poll the clock and the stop flag every 256 nodes (evaluation is expensive, so that is often enough)
+static bool searchStopped(SearchContext* ctx) {
+    if (ctx->stopped || (ctx->nodes & 255) != 0) {
+        return ctx->stopped;
+    }
+    if (ctx->timeLimitMs > 0 && (int)(SDL_GetTicks() - ctx->startTime) >= ctx->timeLimitMs) {
+        ctx->stopped = true;
+    }
+    if (ctx->stopFlag && SDL_AtomicGet(ctx->stopFlag)) {
+        ctx->stopped = true;
+    }
+    return ctx->stopped;
+}
+
+// Draws by rule end the line: any repetition inside the search counts, and material
+// only needs checking right after a capture or pawn move
+static bool isSearchDraw(SearchContext* ctx, unsigned char board[8][8], int halfmoveClock) {
+    if (halfmoveClock >= FIFTY_MOVE_PLIES) {
+        return true;
+    }
+    if (halfmoveClock == 0) {
+        return isInsufficientMaterial(board);
+    }
+    return countRepetitions(ctx->hashes, ctx->hashCount, halfmoveClock) > 0;
+}
+
+static int negamax(SearchContext* ctx, unsigned char board[8][8], int depth, int ply, int alpha, int beta, unsigned char color, Vector2f* lastDoublePawn, Vector2f* kings, int halfmoveClock);
+
+// Play a move on a copy of the position and search the reply; score is relative to 'color'
+static int searchMove(SearchContext* ctx, unsigned char board[8][8], EngineMove move, int depth, int ply, int alpha, int beta, unsigned char color, Vector2f* lastDoublePawn, Vector2f* kings, int halfmoveClock) {
     unsigned char tempBoard[8][8];
     Vector2f tempKings[2] = {kings[0], kings[1]};
     Vector2f tempLastDoublePawn = *lastDoublePawn;
-    
-    if (maximizing) {
-        int maxEval = -100000;
-        
-        for (int i = 0; i < moveList.count; i++) {
-            // Copy the board and kings
-            memcpy(tempBoard, board, sizeof(tempBoard));
-            tempKings[0] = kings[0];
-            tempKings[1] = kings[1];
-            tempLastDoublePawn = *lastDoublePawn;
-            
-            // Make the move on the temporary board (pass isRealMove=0 for AI calculations)
-            engineMakeMove(tempBoard, moveList.moves[i], &tempLastDoublePawn, tempKings, 0);
-            
-            // Recursive call
-            int eval = minimax(tempBoard, depth - 1, alpha, beta, false, color ^ 0x10, &tempLastDoublePawn, tempKings);
-            maxEval = max(maxEval, eval);
-            
-            // Alpha-beta pruning
-            alpha = max(alpha, eval);
-            if (beta <= alpha) {
+    bool irreversible = move.capturedPiece != NONE || (board[move.from.x][move.from.y] & TYPE_MASK) == PAWN;
+
+    copyBoard(board, tempBoard);
+    engineMakeMove(tempBoard, move, &tempLastDoublePawn, tempKings, 0);
+
+    ctx->hashes[ctx->hashCount++] = hashPosition(tempBoard, color ^ 1, &tempLastDoublePawn);
+    int score = -negamax(ctx, tempBoard, depth - 1, ply + 1, -beta, -alpha, color ^ 1, &tempLastDoublePawn, tempKings,
+                         irreversible ? 0 : halfmoveClock + 1);
+    ctx->hashCount--;
+    return score;
+}
+
+// Alpha-beta in negamax form; scores are relative to 'color', the side to move
+static int negamax(SearchContext* ctx, unsigned char board[8][8], int depth, int ply, int alpha, int beta, unsigned char color, Vector2f* lastDoublePawn, Vector2f* kings, int halfmoveClock) {
+    ctx->nodes++;
+    if (searchStopped(ctx)) {
+        return 0;
+    }
+
+    if (isSearchDraw(ctx, board, halfmoveClock)) {
+        return DRAW_SCORE;
+    }
+
+    // Base case: if we've reached the maximum depth
+    if (depth == 0) {
+        return evaluateForSide(board, color, ctx->params);
+    }
+
+    // A deep enough earlier result for this position may settle it
+    uint64_t key = ctx->hashes[ctx->hashCount - 1];
+    TTEntry* entry = probeTT(ctx->tt, key);
+    if (entry && entry->depth >= depth) {
+        int score = scoreFromTT(entry->score, ply);
+        if (entry->flag == TT_EXACT ||
+            (entry->flag == TT_LOWER_BOUND && score >= beta) ||
+            (entry->flag == TT_UPPER_BOUND && score <= alpha)) {
+            return score;
+        }
+    }
+
+    MovePicker picker;
+    initMovePicker(&picker, board, color, lastDoublePawn, entry);
+
+    int originalAlpha = alpha;
+    int bestScore = -INFINITE_SCORE;
+    int moveCount = 0;
+    EngineMove move, bestMove;
+
+    while (nextMove(&picker, board, &move)) {
+        moveCount++;
+        int score = searchMove(ctx, board, move, depth, ply, alpha, beta, color, lastDoublePawn, kings, halfmoveClock);
+        if (ctx->stopped) {
+            return 0;
+        }
+
+        if (score > bestScore) {
+            bestScore = score;
+            bestMove = move;
+        }
+        alpha = max(alpha, score);
+
+        // Alpha-beta pruning; the remaining stages are never generated
+        if (alpha >= beta) {
+            break;
+        }
+    }
+
+    // Check for checkmate or stalemate (prefer the quickest mate)
+    if (moveCount == 0) {
+        return picker.gen.checkers ? -MATE_SCORE + ply : DRAW_SCORE;
+    }
+
+    int flag = (bestScore >= beta) ? TT_LOWER_BOUND : (bestScore > originalAlpha) ? TT_EXACT : TT_UPPER_BOUND;
+    storeTT(ctx->tt, key, depth, bestScore, flag, ply, &bestMove);
+
+    return bestScore;
+}
+
+// Follow the table's best moves from the root to recover the expected line
+static int extractPV(TranspositionTable* tt, unsigned char board[8][8], unsigned char color, Vector2f lastDoublePawn, Vector2f* kings, EngineMove bestMove, int maxLength, EngineMove* pv) {
+    unsigned char tempBoard[8][8];
+    Vector2f tempKings[2] = {kings[0], kings[1]};
+    copyBoard(board, tempBoard);
+
+    int length = 0;
+    pv[length++] = bestMove;
+    engineMakeMove(tempBoard, bestMove, &lastDoublePawn, tempKings, 0);
+    color ^= 1;
+
+    while (length < maxLength) {
+        TTEntry* entry = probeTT(tt, hashPosition(tempBoard, color, &lastDoublePawn));
+        MoveList moveList;
+        generateLegalMoves(tempBoard, color, &moveList, &lastDoublePawn, tempKings);
+        int index = findTTMove(entry, &moveList);
+        if (index < 0) {
+            break;
+        }
+        pv[length++] = moveList.moves[index];
+        engineMakeMove(tempBoard, moveList.moves[index], &lastDoublePawn, tempKings, 0);
+        color ^= 1;
+    }
+    return length;
+}
+
+// Iterative deepening search from the root; stops at limits->maxDepth or when time runs out
+SearchResult searchPosition(unsigned char board[8][8], unsigned char color, Vector2f* lastDoublePawn, Vector2f kings[], const PositionHistory* history, const SearchLimits* limits) {
+    SearchContext* ctx = malloc(sizeof(SearchContext));
+    ctx->params = limits->params ? limits->params : (const EvalParams*)&evalParams;
+    ctx->startTime = SDL_GetTicks();
+    ctx->timeLimitMs = limits->timeLimitMs;
+    ctx->nodes = 0;
+    ctx->stopped = false;
+    ctx->tt = limits->tt;
+    ctx->stopFlag = limits->stop;
+    SearchResult result = {{{-1, -1}, {-1, -1}, 0, false, 0, false, 0}, 0, 0, 0, 0};
+
+    Vector2f rootLastDoublePawn = lastDoublePawn ? *lastDoublePawn : (Vector2f){-1, -1};
+    Vector2f rootKings[2] = {kings[0], kings[1]};
+
+    // Seed the repetition stack with the game, ending in the root position
+    uint64_t rootHash = hashPosition(board, color, &rootLastDoublePawn);
+    int rootHalfmoveClock = 0;
+    ctx->hashCount = 0;
+    if (history && history->count > 0) {
+        memcpy(ctx->hashes, history->hashes, history->count * sizeof(uint64_t));
+        ctx->hashCount = history->count;
+        rootHalfmoveClock = history->halfmoveClock;
+    }
+    if (ctx->hashCount == 0 || ctx->hashes[ctx->hashCount - 1] != rootHash) {
+        if (ctx->hashCount == MAX_GAME_POSITIONS) {
+            memmove(&ctx->hashes[0], &ctx->hashes[1], (MAX_GAME_POSITIONS - 1) * sizeof(uint64_t));
+            ctx->hashCount--;
+        }
+        ctx->hashes[ctx->hashCount++] = rootHash;
+    }
+
+    MoveList rootMoves;
+    generateLegalMoves(board, color, &rootMoves, &rootLastDoublePawn, rootKings);
+    if (rootMoves.count == 0) {
+        free(ctx);
+        return result;
+    }
+
+    orderMoves(board, &rootMoves);
+
+    // Start from the previous best move when the table knows this position
+    int ttMove = findTTMove(probeTT(ctx->tt, rootHash), &rootMoves);
+    if (ttMove > 0) {
+        EngineMove move = rootMoves.moves[ttMove];
+        memmove(&rootMoves.moves[1], &rootMoves.moves[0], ttMove * sizeof(EngineMove));
+        rootMoves.moves[0] = move;
+    }
+    result.bestMove = rootMoves.moves[0];
+    result.pv[0] = result.bestMove;
+    result.pvLength = 1;
+    result.lines[0].pv[0] = result.bestMove;
+    result.lines[0].pvLength = 1;
+    result.lineCount = 1;
+
+    int lineCount = limits->multiPV > 1 ? min(limits->multiPV, MAX_MULTI_PV) : 1;
+    lineCount = min(lineCount, rootMoves.count);
+
+    // Nothing to think about with a single legal move
+    int maxDepth = (limits->maxDepth > 0 && limits->maxDepth < MAX_PV_LENGTH) ? limits->maxDepth : MAX_PV_LENGTH;
+    if (rootMoves.count == 1) {
+        maxDepth = 1;
+    }
+
+    for (int depth = 1; depth <= maxDepth; depth++) {
+        // The best moves so far, best first, as indices into rootMoves. A move only needs an
+        // exact score when it beats the last of them, so that score is alpha for the next one.
+        int lineMoves[MAX_MULTI_PV];
+        int lineScores[MAX_MULTI_PV];
+        int found = 0;
+
+        for (int i = 0; i < rootMoves.count; i++) {
+            int alpha = found < lineCount ? -INFINITE_SCORE : lineScores[lineCount - 1];
+            int score = searchMove(ctx, board, rootMoves.moves[i], depth, 0, alpha, INFINITE_SCORE, color,
+                                   &rootLastDoublePawn, rootKings, rootHalfmoveClock);
+            if (ctx->stopped) {
                 break;
             }
+
+            if (score > alpha) {
+                int slot = found < lineCount ? found++ : lineCount - 1;
+                while (slot > 0 && lineScores[slot - 1] < score) {
+                    lineScores[slot] = lineScores[slot - 1];
+                    lineMoves[slot] = lineMoves[slot - 1];
+                    slot--;
+                }
+                lineScores[slot] = score;
+                lineMoves[slot] = i;
+            }
         }
-        
-        return maxEval;
-        } else {
-        int minEval = 100000;
-        
-        for (int i = 0; i < moveList.count; i++) {
-            // Copy the board and kings
-            memcpy(tempBoard, board, sizeof(tempBoard));
-            tempKings[0] = kings[0];
-            tempKings[1] = kings[1];
-            tempLastDoublePawn = *lastDoublePawn;
-            
-            // Make the move on the temporary board (pass isRealMove=0 for AI calculations)
-            engineMakeMove(tempBoard, moveList.moves[i], &tempLastDoublePawn, tempKings, 0);
-            
-            // Recursive call
-            int eval = minimax(tempBoard, depth - 1, alpha, beta, true, color ^ 0x10, &tempLastDoublePawn, tempKings);
-            minEval = min(minEval, eval);
-            
-            // Alpha-beta pruning
-            beta = min(beta, eval);
-            if (beta <= alpha) {
-                break;
+
+        // An interrupted iteration is incomplete, keep the previous result
+        if (ctx->stopped) {
+            break;
+        }
+
+        result.bestMove = rootMoves.moves[lineMoves[0]];
+        result.score = lineScores[0];
+        result.depth = depth;
+
+        storeTT(ctx->tt, rootHash, depth, result.score, TT_EXACT, 0, &result.bestMove);
+        bool allMates = true;
+        for (int k = 0; k < found; k++) {
+            SearchLine* line = &result.lines[k];
+            EngineMove move = rootMoves.moves[lineMoves[k]];
+            line->score = lineScores[k];
+            if (ctx->tt) {
+                line->pvLength = extractPV(ctx->tt, board, color, rootLastDoublePawn, rootKings, move, depth, line->pv);
+            } else {
+                line->pv[0] = move;
+                line->pvLength = 1;
             }
+            allMates = allMates && abs(lineScores[k]) >= MATE_SCORE - MAX_PV_LENGTH;
+        }
+        result.lineCount = found;
+        result.pvLength = result.lines[0].pvLength;
+        memcpy(result.pv, result.lines[0].pv, result.pvLength * sizeof(EngineMove));
+        if (limits->onProgress) {
+            result.nodes = ctx->nodes;
+            result.timeMs = (int)(SDL_GetTicks() - ctx->startTime);
+            limits->onProgress(&result, limits->progressData);
+        }
+
+        // Search the lines first, best first, in the next iteration
+        MoveList ordered;
+        ordered.count = 0;
+        for (int k = 0; k < found; k++) {
+            ordered.moves[ordered.count++] = rootMoves.moves[lineMoves[k]];
+        }
+        for (int i = 0; i < rootMoves.count; i++) {
+            bool isLine = false;
+            for (int k = 0; k < found; k++) {
+                isLine = isLine || lineMoves[k] == i;
+            }
+            if (!isLine) {
+                ordered.moves[ordered.count++] = rootMoves.moves[i];
+            }
+        }
+        rootMoves = ordered;
+
+        // Forced mates won't change with more depth
+        if (allMates) {
+            break;
+        }
+
+        // The next iteration takes several times longer; don't start what can't finish
+        if (ctx->timeLimitMs > 0 && (int)(SDL_GetTicks() - ctx->startTime) * 2 >= ctx->timeLimitMs) {
+            break;
         }
-        
-        return minEval;
     }
+
+    result.nodes = ctx->nodes;
+    result.timeMs = (int)(SDL_GetTicks() - ctx->startTime);
+    free(ctx);
+    return result;
 }
 
 // Top-level function to get the best move using the full tree search
-EngineMove findBestMoveWithMinimax(unsigned char board[8][8], unsigned char color, Vector2f* lastDoublePawn, Vector2f kings[]) {
-    MoveList moveList;
-    generateLegalMoves(board, color, &moveList, lastDoublePawn, kings);
+EngineMove findBestMoveWithMinimax(unsigned char board[8][8], unsigned char color, Vector2f* lastDoublePawn, Vector2f kings[], const PositionHistory* history) {
+    SearchLimits limits = {MAX_DEPTH, 0, NULL};
+    return searchPosition(board, color, lastDoublePawn, kings, history, &limits).bestMove;
+}
+
+// Write a legal move in Standard Algebraic Notation (e.g. "Nbd7", "exd6", "e8=Q+", "O-O")
+void moveToSAN(unsigned char board[8][8], EngineMove move, unsigned char color, Vector2f* lastDoublePawn, Vector2f kings[], char* san) {
+    static const char pieceLetters[7] = {'?', 'P', 'B', 'N', 'R', 'Q', 'K'};
+    unsigned char pieceType = board[move.from.x][move.from.y] & TYPE_MASK;
+    int len = 0;
 
-    if (moveList.count == 0) {
-        // No legal moves
-        EngineMove nullMove = {{-1, -1}, {-1, -1}, 0, false, 0, false, 0};
-        return nullMove;
+    if (pieceType == KING && abs(move.to.y - move.from.y) == 2) {
+        len += sprintf(san, move.to.y > move.from.y ? "O-O" : "O-O-O");
+    } else {
+        if (pieceType == PAWN) {
+            if (move.capturedPiece != NONE) {
+                san[len++] = 'a' + move.from.y;
+            }
+        } else {
+            san[len++] = pieceLetters[pieceType];
+
+            // Disambiguate between identical pieces that can reach the same square
+            MoveGenContext gen;
+            Vector2f tempLastDoublePawn = lastDoublePawn ? *lastDoublePawn : (Vector2f){-1, -1};
+            initMoveGen(&gen, board, color, &tempLastDoublePawn);
+
+            int from = SQUARE(move.from.x, move.from.y);
+            Bitboard others = gen.bb.pieces[color][pieceType] & ~SQUARE_BIT(from);
+            bool ambiguous = false, sameFile = false, sameRank = false;
+            while (others) {
+                int other = popLowestSquare(&others);
+                if (legalDestinations(&gen, board, other) & SQUARE_BIT(SQUARE(move.to.x, move.to.y))) {
+                    ambiguous = true;
+                    if (SQUARE_COL(other) == move.from.y) sameFile = true;
+                    if (SQUARE_ROW(other) == move.from.x) sameRank = true;
+                }
+            }
+            if (ambiguous) {
+                if (!sameFile) {
+                    san[len++] = 'a' + move.from.y;
+                } else if (!sameRank) {
+                    san[len++] = '8' - move.from.x;
+                } else {
+                    san[len++] = 'a' + move.from.y;
+                    san[len++] = '8' - move.from.x;
+                }
+            }
+        }
+
+        if (move.capturedPiece != NONE) {
+            san[len++] = 'x';
+        }
+        san[len++] = 'a' + move.to.y;
+        san[len++] = '8' - move.to.x;
+
+        if (move.isPromotion) {
+            san[len++] = '=';
+            san[len++] = pieceLetters[move.promotionPiece & TYPE_MASK];
+        }
     }
 
-    int bestScore = -100000;
-    EngineMove bestMove = moveList.moves[0]; // Default to first move
+    // Check / checkmate suffix
+    unsigned char tempBoard[8][8];
+    Vector2f tempKings[2] = {kings[0], kings[1]};
+    Vector2f tempLastDoublePawn = lastDoublePawn ? *lastDoublePawn : (Vector2f){-1, -1};
+    copyBoard(board, tempBoard);
+    engineMakeMove(tempBoard, move, &tempLastDoublePawn, tempKings, 0);
+    MoveGenContext replies;
+    initMoveGen(&replies, tempBoard, color ^ 1, &tempLastDoublePawn);
+    if (replies.checkers) {
+        san[len++] = (countLegalMoves(&replies, tempBoard) == 0) ? '#' : '+';
+    }
+    san[len] = '\0';
+}
 
-    for (int i = 0; i < moveList.count; i++) {
-        unsigned char tempBoard[8][8];
-        Vector2f tempKings[2] = {kings[0], kings[1]};
-        Vector2f tempLastDoublePawn = lastDoublePawn ? *lastDoublePawn : (Vector2f){-1, -1};
-        
-        copyBoard(board, tempBoard);
-        
-        // Make the move on the temporary board
-        engineMakeMove(tempBoard, moveList.moves[i], &tempLastDoublePawn, tempKings, 0);
-        
-        // Calculate the score for this move
-        int score = minimax(tempBoard, MAX_DEPTH - 1, -100000, 100000, false, !color, &tempLastDoublePawn, tempKings);
-        
-        if (score > bestScore) {
-            bestScore = score;
-            bestMove = moveList.moves[i];
+bool parseSAN(unsigned char board[8][8], unsigned char color, Vector2f* lastDoublePawn, const char* san, EngineMove* move) {
+    // Drop check marks and annotations
+    char text[16];
+    int len = 0;
+    while (san[len] && len < (int)sizeof(text) - 1) {
+        text[len] = san[len];
+        len++;
+    }
+    while (len > 0 && strchr("+#!?", text[len - 1])) len--;
+    text[len] = '\0';
+
+    MoveGenContext gen;
+    initMoveGen(&gen, board, color, lastDoublePawn);
+
+    // Castling, with letter O or digit 0
+    if (strcmp(text, "O-O") == 0 || strcmp(text, "0-0") == 0 || strcmp(text, "O-O-O") == 0 || strcmp(text, "0-0-0") == 0) {
+        if (gen.kingSquare < 0) return false;
+        int to = gen.kingSquare + (len == 3 ? 2 : -2);
+        if (to < 0 || to > 63 || !(legalDestinations(&gen, board, gen.kingSquare) & SQUARE_BIT(to))) return false;
+        *move = createEngineMove(&gen, board, gen.kingSquare, to, NONE);
+        return true;
+    }
+
+    unsigned char pieceType = PAWN;
+    const char* pieceLetters = "PBNRQK";
+    int start = 0;
+    if (len > 0 && isupper((unsigned char)text[0]) && strchr(pieceLetters, text[0])) {
+        pieceType = (unsigned char)(strchr(pieceLetters, text[0]) - pieceLetters + PAWN);
+        start = 1;
+    }
+
+    // Promotion piece: "e8=Q", also "e8Q"
+    unsigned char promotionPiece = NONE;
+    if (pieceType == PAWN && len >= 3 && strchr("BNRQ", text[len - 1])) {
+        promotionPiece = (unsigned char)(strchr(pieceLetters, text[len - 1]) - pieceLetters + PAWN);
+        len -= (text[len - 2] == '=') ? 2 : 1;
+    }
+
+    // The target is the last square; what comes before it can only narrow down the origin
+    if (len - start < 2) return false;
+    char file = text[len - 2], rank = text[len - 1];
+    if (file < 'a' || file > 'h' || rank < '1' || rank > '8') return false;
+    int to = SQUARE('8' - rank, file - 'a');
+
+    int fromFile = -1, fromRank = -1;
+    for (int i = start; i < len - 2; i++) {
+        if (text[i] >= 'a' && text[i] <= 'h') {
+            fromFile = text[i] - 'a';
+        } else if (text[i] >= '1' && text[i] <= '8') {
+            fromRank = '8' - text[i];
+        } else if (text[i] != 'x' && text[i] != '-') {
+            return false;
         }
     }
-    
-    return bestMove;
+
+    int from = -1;
+    Bitboard candidates = gen.bb.pieces[color][pieceType];
+    while (candidates) {
+        int square = popLowestSquare(&candidates);
+        if ((fromFile >= 0 && SQUARE_COL(square) != fromFile) || (fromRank >= 0 && SQUARE_ROW(square) != fromRank)) {
+            continue;
+        }
+        if (legalDestinations(&gen, board, square) & SQUARE_BIT(to)) {
+            if (from >= 0) return false; // Ambiguous
+            from = square;
+        }
+    }
+    if (from < 0) return false;
+
+    // A pawn reaching the last rank must say what it becomes, and only then
+    bool promotes = pieceType == PAWN && (SQUARE_ROW(to) == 0 || SQUARE_ROW(to) == 7);
+    if (promotes != (promotionPiece != NONE) || promotionPiece == KING) return false;
+
+    *move = createEngineMove(&gen, board, from, to, promotionPiece);
+    return true;
+}
+
+bool parseCoordinateMove(unsigned char board[8][8], unsigned char color, Vector2f* lastDoublePawn, const char* text, EngineMove* move) {
+    static const char promotionLetters[] = "bnrq"; // BISHOP, KNIGHT, ROOK, QUEEN
+    size_t length = strlen(text);
+    if (length < 4 || length > 5 || text[0] < 'a' || text[0] > 'h' || text[1] < '1' || text[1] > '8' ||
+        text[2] < 'a' || text[2] > 'h' || text[3] < '1' || text[3] > '8') {
+        return false;
+    }
+    int from = SQUARE('8' - text[1], text[0] - 'a');
+    int to = SQUARE('8' - text[3], text[2] - 'a');
+    unsigned char promotionPiece = QUEEN;
+    if (length == 5) {
+        const char* letter = strchr(promotionLetters, text[4]);
+        if (!letter) return false;
+        promotionPiece = (unsigned char)(BISHOP + (letter - promotionLetters));
+    }
+
+    MoveGenContext gen;
+    initMoveGen(&gen, board, color, lastDoublePawn);
+    if (!(legalDestinations(&gen, board, from) & SQUARE_BIT(to))) return false;
+    *move = createEngineMove(&gen, board, from, to, promotionPiece);
+    return true;
+}
+
+void moveToCoordinates(EngineMove move, char* text) {
+    static const char promotionLetters[7] = {'?', '?', 'b', 'n', 'r', 'q', '?'};
+    int len = sprintf(text, "%c%d%c%d", 'a' + move.from.y, 8 - move.from.x, 'a' + move.to.y, 8 - move.to.x);
+    if (move.isPromotion) {
+        text[len++] = promotionLetters[move.promotionPiece & TYPE_MASK];
+        text[len] = '\0';
+    }
 }
 
-// Function to check if the game is over (checkmate or stalemate)
-bool isGameOver(unsigned char board[8][8], unsigned char color, Vector2f* lastDoublePawn, Vector2f* kings) {
+// Function to check if the game is over (checkmate, stalemate or a draw by rule)
+bool isGameOver(unsigned char board[8][8], unsigned char color, Vector2f* lastDoublePawn, Vector2f* kings, const PositionHistory* history) {
     MoveList moveList;
     generateLegalMoves(board, color, &moveList, lastDoublePawn, kings);
     
-    // No legal moves and king in check = checkmate
-    return moveList.count == 0;
+    // No legal moves = checkmate or stalemate; otherwise the draw rules can still end the game
+    return moveList.count == 0 || getDrawReason(board, history) != DRAW_NONE;
 }
 
 // Function to get a visual representation of the relative score (for UI)
@@ -1137,7 +1702,7 @@ void analyzePosition(unsigned char board[8][8], unsigned char color, Vector2f* l
     printf("Position evaluation: %.2f\n", score / 100.0f);
     
     // Find best move
-    EngineMove bestMove = findBestMoveWithMinimax(board, color, lastDoublePawn, kings);
+    EngineMove bestMove = findBestMoveWithMinimax(board, color, lastDoublePawn, kings, NULL);
     
     if (bestMove.from.x != -1) {
         printf("Best move: %c%d to %c%d\n", 
@@ -1195,6 +1760,23 @@ int evaluateMoveSafety(unsigned char board[8][8], EngineMove move, unsigned char
     return 0; // No immediate threat detected
 }
 
+Bitboard attackedDestinations(unsigned char board[8][8], int from, Bitboard destinations) {
+    unsigned char enemy = ((board[SQUARE_ROW(from)][SQUARE_COL(from)] & COLOR_MASK) >> 4) ^ 1;
+    BoardBitboards bb;
+    loadBitboards(board, &bb);
+
+    // The piece no longer blocks lines through the square it leaves
+    Bitboard occupied = bb.occupied & ~SQUARE_BIT(from);
+    Bitboard attacked = 0;
+    while (destinations) {
+        int to = popLowestSquare(&destinations);
+        if (attackersOfColor(&bb, to, enemy, occupied | SQUARE_BIT(to))) {
+            attacked |= SQUARE_BIT(to);
+        }
+    }
+    return attacked;
+}
+
 // Function to evaluate all legal moves and determine their safety
 void evaluateMovesSafety(unsigned char board[8][8], unsigned char color, MoveList* moveList) {
     // Reset safety scores for all moves
@@ -1222,6 +1804,6 @@ void evaluateMovesSafety(unsigned char board[8][8], unsigned char color, MoveLis
 }
 
 // Legacy wrapper for findBestMove to maintain compatibility
-EngineMove findBestMove(unsigned char board[8][8], unsigned char color, Vector2f* lastDoublePawn, Vector2f* kings) {
-    return findBestMoveWithMinimax(board, color, lastDoublePawn, kings);
+EngineMove findBestMove(unsigned char board[8][8], unsigned char color, Vector2f* lastDoublePawn, Vector2f* kings, const PositionHistory* history) {
+    return findBestMoveWithMinimax(board, color, lastDoublePawn, kings, history);
 }
\ No newline at end of file
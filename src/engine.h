@@ -3,21 +3,30 @@
 #define ENGINE_H
 
 #include <stdbool.h>
+#include <stdint.h>
 #include "util.h"
 #include "Piece.h"
+#include "bitboard.h"
+#include "eval_params.h" // Tuned piece values, positional weights and piece-square tables
 
-// Piece values for evaluation
-#define PAWN_VALUE 100
-#define KNIGHT_VALUE 320
-#define BISHOP_VALUE 330
-#define ROOK_VALUE 500
-#define QUEEN_VALUE 900
+// King value is fixed; both sides always have one so it is never tuned
 #define KING_VALUE 20000
 
 // Search parameters
 #define MAX_DEPTH 3
 #define MAX_PV_LENGTH 64
-#define MAX_MOVES_PER_POSITION 1024
+#define MAX_MULTI_PV 8
+#define MAX_MOVES_PER_POSITION 256 // Legal moves only; no position has more than 218
+#define SEARCH_STACK_SIZE (4 * 1024 * 1024) // For threads running searchPosition: a MoveList per ply, MAX_PV_LENGTH plies deep
+#define MATE_SCORE 30000       // Mate at the root; mate in n plies scores MATE_SCORE - n
+#define INFINITE_SCORE 32000
+#define DRAW_SCORE 0
+
+// Draw rules
+#define MAX_GAME_POSITIONS 1024  // Positions kept for repetition detection
+#define FIFTY_MOVE_PLIES 100
+
+#define DEFAULT_TT_SIZE_MB 16
 
 typedef struct {
     Vector2f from;
@@ -34,24 +43,200 @@ typedef struct {
     int count;
 } MoveList;
 
+// Which moves generateStagedMoves produces
+typedef enum {
+    GEN_CAPTURES,                // Captures, en passant and promotions
+    GEN_QUIETS,                  // Everything else, castling included
+    GEN_ALL
+} GenStage;
+
+// What legality depends on, worked out once per position. Only legal moves are generated:
+// non-king moves must land on checkMask and pinned pieces stay on their pin line.
+typedef struct {
+    BoardBitboards bb;
+    unsigned char color;         // Side to move
+    int kingSquare;              // -1 when the side has no king (test positions)
+    Bitboard checkers;           // Enemy pieces giving check
+    Bitboard pinned;             // Our pieces that may only move along the line to our king
+    Bitboard checkMask;          // All squares, the checker and the squares between in single check, none in double check
+    int enPassantSquare;         // Destination of an en passant capture, or -1
+    int enPassantVictim;         // Square of the pawn it captures
+} MoveGenContext;
+
+// Every evaluation weight, indexed by piece type where relevant.
+// Only ints, so the tuner can treat it as a flat array of EVAL_PARAM_COUNT values.
+typedef struct {
+    int pieceValue[7];
+    int pstMG[7][8][8];
+    int pstEG[7][8][8];
+    int mobilityWeight;
+    int kingCenterPenalty;
+    int kingPawnShieldBonus;
+    int kingInCheckPenalty;
+    int passedPawnBonus;
+    int passedPawnRankBonus;
+    int doubledPawnPenalty;
+    int isolatedPawnPenalty;
+} EvalParams;
+
+#define EVAL_PARAM_COUNT ((int)(sizeof(EvalParams) / sizeof(int)))
+
+// Coefficient of each parameter in an evaluation (white minus black),
+// so that score ~= sum(coef[i] * param[i]). Filled in for the tuner.
+typedef struct {
+    float coef[EVAL_PARAM_COUNT];
+} EvalTrace;
+
+// Zobrist hashes of the positions since the last capture or pawn move, oldest first.
+// Earlier positions can never repeat, so the stack is cleared on every irreversible move.
+typedef struct {
+    uint64_t hashes[MAX_GAME_POSITIONS];
+    int count;
+    int halfmoveClock;           // Plies since the last capture or pawn move
+} PositionHistory;
+
+typedef enum {
+    DRAW_NONE,
+    DRAW_REPETITION,
+    DRAW_FIFTY_MOVES,
+    DRAW_INSUFFICIENT_MATERIAL
+} DrawReason;
+
+// Transposition table entry; moves are stored as square indices (row * 8 + col)
+typedef struct {
+    uint64_t key;
+    short score;
+    signed char depth;
+    unsigned char flag;          // TT_EXACT, TT_LOWER_BOUND or TT_UPPER_BOUND
+    unsigned char from;
+    unsigned char to;
+    unsigned char promotionPiece;
+} TTEntry;
+
+// One table per searcher; tables are not shared between threads searching at the same time
+typedef struct {
+    TTEntry* entries;
+    size_t mask;                 // Entry count - 1 (a power of two)
+} TranspositionTable;
+
+// One of the best root moves with its exact score and expected line
+typedef struct {
+    int score;                   // Centipawns for the side to move
+    EngineMove pv[MAX_PV_LENGTH]; // Starts with the root move
+    int pvLength;
+} SearchLine;
+
+typedef struct {
+    EngineMove bestMove;         // from.x == -1 when there is no legal move
+    int score;                   // Centipawns for the side to move
+    int depth;                   // Deepest completed iteration
+    long long nodes;
+    int timeMs;
+    EngineMove pv[MAX_PV_LENGTH]; // Expected line, starting with bestMove
+    int pvLength;
+    SearchLine lines[MAX_MULTI_PV]; // Best first; lines[0] repeats bestMove, score and pv
+    int lineCount;
+} SearchResult;
+
+// Called on the searching thread after every completed iteration, with the result so far
+typedef void (*SearchProgressCallback)(const SearchResult* result, void* data);
+
+// Limits for searchPosition
+typedef struct {
+    int maxDepth;                // 0 = no depth limit
+    int timeLimitMs;             // 0 = no time limit
+    const EvalParams* params;    // NULL = evalParams
+    TranspositionTable* tt;      // NULL = search without a table
+    SDL_atomic_t* stop;          // NULL = none; the search aborts once it becomes non-zero
+    SearchProgressCallback onProgress; // NULL = none
+    void* progressData;          // Handed to onProgress
+    int multiPV;                 // Best moves to score exactly, up to MAX_MULTI_PV; 0 = 1
+} SearchLimits;
+
+// Weights used by evaluatePosition, initialized from eval_params.h
+extern EvalParams evalParams;
+
 // Function to initialize the engine
 void initializeEngine();
 
 // Function to generate all legal moves for the current position
 void generateMoves(unsigned char board[8][8], unsigned char color, MoveList* moveList, Vector2f* lastDoublePawn);
 
+// Work out checkers, pins and en passant for the side to move
+void initMoveGen(MoveGenContext* gen, unsigned char board[8][8], unsigned char color, Vector2f* lastDoublePawn);
+
+// Squares the piece on 'square' (row * 8 + col) can legally move to; empty for enemy pieces
+Bitboard legalDestinations(const MoveGenContext* gen, unsigned char board[8][8], int square);
+
+// Legal moves of one stage (all moves are evasions when in check)
+void generateStagedMoves(const MoveGenContext* gen, unsigned char board[8][8], GenStage stage, MoveList* list);
+
+// Legal target squares of every piece of the side to move, indexed by square; what the board UI highlights
+void generateLegalDestinations(unsigned char board[8][8], unsigned char color, Vector2f* lastDoublePawn, Bitboard destinations[64]);
+
+// The move of the piece on 'from' to 'to'; promotionPiece is a piece type, used when the move promotes
+EngineMove createEngineMove(const MoveGenContext* gen, unsigned char board[8][8], int from, int to, unsigned char promotionPiece);
+
+// Number of legal moves (as generateStagedMoves would list them) without building the list
+int countLegalMoves(const MoveGenContext* gen, unsigned char board[8][8]);
+
 // Function to find the best move for the AI
-EngineMove findBestMove(unsigned char board[8][8], unsigned char color, Vector2f* lastDoublePawn, Vector2f kings[]);
+EngineMove findBestMove(unsigned char board[8][8], unsigned char color, Vector2f* lastDoublePawn, Vector2f kings[], const PositionHistory* history);
+
+// Iterative deepening alpha-beta search; safe to run from several threads at once.
+// history holds the game so far for repetition detection (may be NULL).
+SearchResult searchPosition(unsigned char board[8][8], unsigned char color, Vector2f* lastDoublePawn, Vector2f kings[], const PositionHistory* history, const SearchLimits* limits);
+
+// Allocate a table of about sizeMB megabytes; returns false when out of memory
+bool initTranspositionTable(TranspositionTable* tt, int sizeMB);
+void clearTranspositionTable(TranspositionTable* tt);
+void freeTranspositionTable(TranspositionTable* tt);
+
+// Zobrist hash of a position
+uint64_t hashPosition(unsigned char board[8][8], unsigned char color, Vector2f* lastDoublePawn);
+
+// Start a new history at the given position
+void resetPositionHistory(PositionHistory* history, unsigned char board[8][8], unsigned char color, Vector2f* lastDoublePawn, int halfmoveClock);
+
+// Record the position reached after a move; irreversible = the move was a capture or a pawn move
+void recordPosition(PositionHistory* history, unsigned char board[8][8], unsigned char color, Vector2f* lastDoublePawn, bool irreversible);
+
+// Neither side has enough material left to checkmate
+bool isInsufficientMaterial(unsigned char board[8][8]);
+
+// Threefold repetition, fifty-move rule or insufficient material for the last recorded position
+DrawReason getDrawReason(unsigned char board[8][8], const PositionHistory* history);
+
+// Function to write a legal move in Standard Algebraic Notation (san needs room for 8 characters)
+void moveToSAN(unsigned char board[8][8], EngineMove move, unsigned char color, Vector2f* lastDoublePawn, Vector2f kings[], char* san);
+
+// Find the legal move a SAN string names ("Nbd7", "exd8=Q+", "O-O"); false when it names none, or several
+bool parseSAN(unsigned char board[8][8], unsigned char color, Vector2f* lastDoublePawn, const char* san, EngineMove* move);
+
+// Find the legal move a coordinate string names ("e2e4", "e7e8q"; promotions default to a queen)
+bool parseCoordinateMove(unsigned char board[8][8], unsigned char color, Vector2f* lastDoublePawn, const char* text, EngineMove* move);
+
+// Write a move in coordinate notation, as UCI uses it (text needs room for 6 characters)
+void moveToCoordinates(EngineMove move, char* text);
 
 // Corrected prototype for engineMakeMove:
 void engineMakeMove(unsigned char board[8][8], EngineMove move, Vector2f* lastDoublePawn, Vector2f kingsPositions[], int isRealMove); // Changed function name and added 'int isRealMove' parameter
 
-// Function to get the relative score based on the current player's perspective
+// Static evaluation in centipawns from white's point of view; color is not used
 int evaluatePosition(unsigned char board[8][8], unsigned char color);
 
+// Read weights from a file written by the tuner (eval_params.h format)
+bool loadEvalParams(const char* path, EvalParams* params);
+
+// Evaluate with explicit weights, optionally recording parameter coefficients (trace may be NULL)
+int evaluateWithParams(unsigned char board[8][8], const EvalParams* params, EvalTrace* trace);
+
 // Function to convert numerical score to evaluation bar percentages
 void getScoreBar(int score, float* whitePercentage, float* blackPercentage);
 
+// Those of the destinations where the piece on 'from' would stand attacked by the opponent
+Bitboard attackedDestinations(unsigned char board[8][8], int from, Bitboard destinations);
+
 // Function to evaluate the safety of moves
 void evaluateMovesSafety(unsigned char board[8][8], unsigned char color, MoveList* moveList);
 
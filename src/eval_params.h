@@ -0,0 +1,157 @@
+// src/eval_params.h
+// Generated by the evaluation tuner (tuner.c). Re-run the tuner instead of
+// editing these values by hand; the next tuning run overwrites this file.
+#ifndef EVAL_PARAMS_H
+#define EVAL_PARAMS_H
+
+// Piece values
+#define PAWN_VALUE 100
+#define BISHOP_VALUE 330
+#define KNIGHT_VALUE 320
+#define ROOK_VALUE 500
+#define QUEEN_VALUE 900
+
+// Positional terms
+#define MOBILITY_WEIGHT 5
+#define KING_CENTER_PENALTY 30
+#define KING_PAWN_SHIELD_BONUS 15
+#define KING_IN_CHECK_PENALTY 50
+#define PASSED_PAWN_BONUS 30
+#define PASSED_PAWN_RANK_BONUS 10
+#define DOUBLED_PAWN_PENALTY 15
+#define ISOLATED_PAWN_PENALTY 20
+
+// Piece-square tables (same orientation as evaluatePieceSquareTables)
+#define PAWN_TABLE_MG { \
+    {   0,   0,   0,   0,   0,   0,   0,   0}, \
+    {  50,  50,  50,  50,  50,  50,  50,  50}, \
+    {  10,  10,  20,  30,  30,  20,  10,  10}, \
+    {   5,   5,  10,  25,  25,  10,   5,   5}, \
+    {   0,   0,   0,  20,  20,   0,   0,   0}, \
+    {   5,  -5, -10,   0,   0, -10,  -5,   5}, \
+    {   5,  10,  10, -20, -20,  10,  10,   5}, \
+    {   0,   0,   0,   0,   0,   0,   0,   0} \
+}
+
+#define PAWN_TABLE_EG { \
+    {   0,   0,   0,   0,   0,   0,   0,   0}, \
+    {  80,  80,  80,  80,  80,  80,  80,  80}, \
+    {  50,  50,  50,  50,  50,  50,  50,  50}, \
+    {  30,  30,  30,  30,  30,  30,  30,  30}, \
+    {  20,  20,  20,  20,  20,  20,  20,  20}, \
+    {  10,  10,  10,  10,  10,  10,  10,  10}, \
+    {  10,  10,  10,  10,  10,  10,  10,  10}, \
+    {   0,   0,   0,   0,   0,   0,   0,   0} \
+}
+
+#define BISHOP_TABLE_MG { \
+    { -20, -10, -10, -10, -10, -10, -10, -20}, \
+    { -10,   0,   0,   0,   0,   0,   0, -10}, \
+    { -10,   0,  10,  10,  10,  10,   0, -10}, \
+    { -10,   5,   5,  10,  10,   5,   5, -10}, \
+    { -10,   0,   5,  10,  10,   5,   0, -10}, \
+    { -10,   5,   5,   5,   5,   5,   5, -10}, \
+    { -10,   0,   5,   0,   0,   5,   0, -10}, \
+    { -20, -10, -10, -10, -10, -10, -10, -20} \
+}
+
+#define BISHOP_TABLE_EG { \
+    { -20, -10, -10, -10, -10, -10, -10, -20}, \
+    { -10,   0,   0,   0,   0,   0,   0, -10}, \
+    { -10,   0,  10,  10,  10,  10,   0, -10}, \
+    { -10,   5,   5,  10,  10,   5,   5, -10}, \
+    { -10,   0,   5,  10,  10,   5,   0, -10}, \
+    { -10,   5,   5,   5,   5,   5,   5, -10}, \
+    { -10,   0,   5,   0,   0,   5,   0, -10}, \
+    { -20, -10, -10, -10, -10, -10, -10, -20} \
+}
+
+#define KNIGHT_TABLE_MG { \
+    { -50, -40, -30, -30, -30, -30, -40, -50}, \
+    { -40, -20,   0,   0,   0,   0, -20, -40}, \
+    { -30,   0,  10,  15,  15,  10,   0, -30}, \
+    { -30,   5,  15,  20,  20,  15,   5, -30}, \
+    { -30,   0,  15,  20,  20,  15,   0, -30}, \
+    { -30,   5,  10,  15,  15,  10,   5, -30}, \
+    { -40, -20,   0,   5,   5,   0, -20, -40}, \
+    { -50, -40, -30, -30, -30, -30, -40, -50} \
+}
+
+#define KNIGHT_TABLE_EG { \
+    { -50, -40, -30, -30, -30, -30, -40, -50}, \
+    { -40, -20,   0,   0,   0,   0, -20, -40}, \
+    { -30,   0,  10,  15,  15,  10,   0, -30}, \
+    { -30,   5,  15,  20,  20,  15,   5, -30}, \
+    { -30,   0,  15,  20,  20,  15,   0, -30}, \
+    { -30,   5,  10,  15,  15,  10,   5, -30}, \
+    { -40, -20,   0,   5,   5,   0, -20, -40}, \
+    { -50, -40, -30, -30, -30, -30, -40, -50} \
+}
+
+#define ROOK_TABLE_MG { \
+    {   0,   0,   0,   0,   0,   0,   0,   0}, \
+    {   5,  10,  10,  10,  10,  10,  10,   5}, \
+    {  -5,   0,   0,   0,   0,   0,   0,  -5}, \
+    {  -5,   0,   0,   0,   0,   0,   0,  -5}, \
+    {  -5,   0,   0,   0,   0,   0,   0,  -5}, \
+    {  -5,   0,   0,   0,   0,   0,   0,  -5}, \
+    {  -5,   0,   0,   0,   0,   0,   0,  -5}, \
+    {   0,   0,   0,   5,   5,   0,   0,   0} \
+}
+
+#define ROOK_TABLE_EG { \
+    {   0,   0,   0,   0,   0,   0,   0,   0}, \
+    {   5,  10,  10,  10,  10,  10,  10,   5}, \
+    {  -5,   0,   0,   0,   0,   0,   0,  -5}, \
+    {  -5,   0,   0,   0,   0,   0,   0,  -5}, \
+    {  -5,   0,   0,   0,   0,   0,   0,  -5}, \
+    {  -5,   0,   0,   0,   0,   0,   0,  -5}, \
+    {  -5,   0,   0,   0,   0,   0,   0,  -5}, \
+    {   0,   0,   0,   5,   5,   0,   0,   0} \
+}
+
+#define QUEEN_TABLE_MG { \
+    { -20, -10, -10,  -5,  -5, -10, -10, -20}, \
+    { -10,   0,   0,   0,   0,   0,   0, -10}, \
+    { -10,   0,   5,   5,   5,   5,   0, -10}, \
+    {  -5,   0,   5,   5,   5,   5,   0,  -5}, \
+    {   0,   0,   5,   5,   5,   5,   0,  -5}, \
+    { -10,   5,   5,   5,   5,   5,   0, -10}, \
+    { -10,   0,   5,   0,   0,   0,   0, -10}, \
+    { -20, -10, -10,  -5,  -5, -10, -10, -20} \
+}
+
+#define QUEEN_TABLE_EG { \
+    { -20, -10, -10,  -5,  -5, -10, -10, -20}, \
+    { -10,   0,   0,   0,   0,   0,   0, -10}, \
+    { -10,   0,   5,   5,   5,   5,   0, -10}, \
+    {  -5,   0,   5,   5,   5,   5,   0,  -5}, \
+    {   0,   0,   5,   5,   5,   5,   0,  -5}, \
+    { -10,   5,   5,   5,   5,   5,   0, -10}, \
+    { -10,   0,   5,   0,   0,   0,   0, -10}, \
+    { -20, -10, -10,  -5,  -5, -10, -10, -20} \
+}
+
+#define KING_TABLE_MG { \
+    { -30, -40, -40, -50, -50, -40, -40, -30}, \
+    { -30, -40, -40, -50, -50, -40, -40, -30}, \
+    { -30, -40, -40, -50, -50, -40, -40, -30}, \
+    { -30, -40, -40, -50, -50, -40, -40, -30}, \
+    { -20, -30, -30, -40, -40, -30, -30, -20}, \
+    { -10, -20, -20, -20, -20, -20, -20, -10}, \
+    {  20,  20,   0,   0,   0,   0,  20,  20}, \
+    {  20,  30,  10,   0,   0,  10,  30,  20} \
+}
+
+#define KING_TABLE_EG { \
+    { -50, -40, -30, -20, -20, -30, -40, -50}, \
+    { -30, -20, -10,   0,   0, -10, -20, -30}, \
+    { -30, -10,  20,  30,  30,  20, -10, -30}, \
+    { -30, -10,  30,  40,  40,  30, -10, -30}, \
+    { -30, -10,  30,  40,  40,  30, -10, -30}, \
+    { -30, -10,  20,  30,  30,  20, -10, -30}, \
+    { -30, -30,   0,   0,   0,   0, -30, -30}, \
+    { -50, -30, -30, -30, -30, -30, -30, -50} \
+}
+
+#endif // EVAL_PARAMS_H
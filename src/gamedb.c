@@ -0,0 +1,386 @@
+// src/gamedb.c
+// Headless game database tool: imports games into a database (see database.h) and
+// looks up the games that reach a position.
+//
+// Usage: gamedb import <db> <games.pgn|games.txt>  append games and update the index
+//        gamedb export <db> <games.pgn>             write every game as PGN
+//        gamedb index <db>                          rebuild the index if it is missing or stale
+//        gamedb tree <db> <out> [-plies N]          build the opening tree the GUI's explorer reads
+//        gamedb find <db> <FEN> [-limit N]          list the games reaching a position
+//        gamedb show <db> <game>                    print one game
+//
+// PGN files are streamed, so archives of any size import in constant memory; games from a
+// set-up position (FEN tag) are skipped. Other files hold one game per line in coordinate
+// notation, optionally ending with the result; blank lines and lines starting with '#' are skipped:
+//   e2e4 e7e5 g1f3 b8c6 f1b5 a7a6 1-0
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <SDL2/SDL.h>
+
+#include "database.h"
+#include "engine.h"
+#include "pgn.h"
+#include "Piece.h"
+
+#define MAX_LINE_LENGTH 65536
+#define DEFAULT_FIND_LIMIT 20
+#define PROGRESS_INTERVAL 100000 // Games between progress reports
+
+static const char* resultNames[] = {"*", "1-0", "0-1", "1/2-1/2"};
+
+static double secondsSince(Uint64 start) {
+    return (double)(SDL_GetPerformanceCounter() - start) / SDL_GetPerformanceFrequency();
+}
+
+// Parse one line into moves; false (with the reason in error) when it isn't a legal game
+static bool parseGameLine(char* line, EngineMove* moves, int* plyCount, DatabaseResult* result, const char** error) {
+    unsigned char board[8][8];
+    Vector2f kings[2];
+    Vector2f lastDoublePawn;
+    loadStartPosition(board, kings, &lastDoublePawn);
+    unsigned char color = 0;
+
+    *plyCount = 0;
+    *result = DB_RESULT_UNKNOWN;
+    for (char* token = strtok(line, " \t\r\n"); token; token = strtok(NULL, " \t\r\n")) {
+        bool isResult = false;
+        for (int r = 0; r <= DB_RESULT_DRAW; r++) {
+            if (strcmp(token, resultNames[r]) == 0) {
+                *result = (DatabaseResult)r;
+                isResult = true;
+            }
+        }
+        if (isResult) {
+            continue;
+        }
+        if (*plyCount == DATABASE_MAX_PLIES) {
+            *error = "too long";
+            return false;
+        }
+        EngineMove move;
+        if (!parseCoordinateMove(board, color, &lastDoublePawn, token, &move)) {
+            *error = "illegal move";
+            return false;
+        }
+        moves[(*plyCount)++] = move;
+        engineMakeMove(board, move, &lastDoublePawn, kings, 0);
+        color ^= 1;
+    }
+    return true;
+}
+
+typedef struct {
+    int imported;
+    int skipped;
+    long long plies;
+} ImportCounts;
+
+static void reportProgress(const ImportCounts* counts, Uint64 start) {
+    int games = counts->imported + counts->skipped;
+    if (games % PROGRESS_INTERVAL == 0) {
+        printf("%d games, %.0f games/s\n", games, games / secondsSince(start));
+        fflush(stdout);
+    }
+}
+
+static bool importLines(DatabaseWriter* writer, const char* gamesPath, ImportCounts* counts, Uint64 start) {
+    FILE* input = fopen(gamesPath, "r");
+    char* line = malloc(MAX_LINE_LENGTH);
+    EngineMove* moves = malloc(DATABASE_MAX_PLIES * sizeof(EngineMove));
+    if (!input || !line || !moves) {
+        fprintf(stderr, "Error: Cannot read %s\n", gamesPath);
+        if (input) fclose(input);
+        free(line);
+        free(moves);
+        return false;
+    }
+
+    int lineNumber = 0;
+    while (fgets(line, MAX_LINE_LENGTH, input)) {
+        lineNumber++;
+        char* text = line;
+        while (*text == ' ' || *text == '\t') text++;
+        if (*text == '#' || *text == '\n' || *text == '\r' || *text == '\0') {
+            continue;
+        }
+
+        int plyCount;
+        DatabaseResult result;
+        const char* error = NULL;
+        if (!parseGameLine(text, moves, &plyCount, &result, &error) ||
+            !addDatabaseGame(writer, moves, plyCount, result)) {
+            fprintf(stderr, "Error: %s:%d: %s, game skipped\n", gamesPath, lineNumber, error ? error : "cannot store");
+            counts->skipped++;
+        } else {
+            counts->imported++;
+            counts->plies += plyCount;
+        }
+        reportProgress(counts, start);
+    }
+    fclose(input);
+    free(line);
+    free(moves);
+    return true;
+}
+
+static DatabaseResult parseResult(const char* text) {
+    for (int r = 0; r <= DB_RESULT_DRAW; r++) {
+        if (strcmp(text, resultNames[r]) == 0) return (DatabaseResult)r;
+    }
+    return DB_RESULT_UNKNOWN;
+}
+
+static bool importPgn(DatabaseWriter* writer, const char* gamesPath, ImportCounts* counts, Uint64 start) {
+    PgnReader* reader = malloc(sizeof(PgnReader));
+    PgnGame* game = malloc(sizeof(PgnGame));
+    if (!reader || !game || !openPgnReader(reader, gamesPath)) {
+        free(reader);
+        free(game);
+        return false;
+    }
+
+    PgnStatus status;
+    while ((status = readPgnGame(reader, game)) != PGN_END) {
+        if (status == PGN_GAME_SKIPPED) {
+            counts->skipped++;
+        } else if (game->tags.fen[0] && strcmp(game->tags.fen, START_FEN) != 0) {
+            fprintf(stderr, "Error: Line %lld: Game starts from a set-up position, skipped\n", reader->line);
+            counts->skipped++;
+        } else if (game->plyCount > DATABASE_MAX_PLIES ||
+                   !addDatabaseGame(writer, game->moves, game->plyCount, parseResult(game->tags.result))) {
+            fprintf(stderr, "Error: Line %lld: Cannot store game, skipped\n", reader->line);
+            counts->skipped++;
+        } else {
+            counts->imported++;
+            counts->plies += game->plyCount;
+        }
+        reportProgress(counts, start);
+    }
+    printf("Read %.1f MB of PGN\n", reader->bytesRead / (1024.0 * 1024.0));
+    closePgnReader(reader);
+    free(reader);
+    free(game);
+    return true;
+}
+
+static bool isPgnPath(const char* path) {
+    size_t length = strlen(path);
+    return length >= 4 && SDL_strcasecmp(path + length - 4, ".pgn") == 0;
+}
+
+static int importGames(const char* dbPath, const char* gamesPath) {
+    DatabaseWriter writer;
+    if (!openDatabaseWriter(&writer, dbPath)) {
+        return 1;
+    }
+
+    Uint64 start = SDL_GetPerformanceCounter();
+    ImportCounts counts = {0, 0, 0};
+    bool read = isPgnPath(gamesPath) ? importPgn(&writer, gamesPath, &counts, start)
+                                     : importLines(&writer, gamesPath, &counts, start);
+    double parseSeconds = secondsSince(start);
+
+    Uint64 indexStart = SDL_GetPerformanceCounter();
+    if (!closeDatabaseWriter(&writer) || !read) {
+        return 1;
+    }
+    double indexSeconds = secondsSince(indexStart);
+    double totalSeconds = parseSeconds + indexSeconds;
+
+    printf("Imported %d games (%lld plies), skipped %d\n", counts.imported, counts.plies, counts.skipped);
+    printf("%.2f s (%.2f s indexing), %.0f games/s\n", totalSeconds, indexSeconds,
+           totalSeconds > 0 ? counts.imported / totalSeconds : 0.0);
+    return 0;
+}
+
+static int exportGames(const char* dbPath, const char* pgnPath) {
+    GameDatabase db;
+    if (!openGameDatabase(&db, dbPath)) {
+        return 1;
+    }
+    FILE* output = fopen(pgnPath, "w");
+    PgnGame* game = malloc(sizeof(PgnGame));
+    if (!output || !game) {
+        fprintf(stderr, "Error: Cannot write %s\n", pgnPath);
+        if (output) fclose(output);
+        free(game);
+        closeGameDatabase(&db);
+        return 1;
+    }
+
+    Uint64 start = SDL_GetPerformanceCounter();
+    uint32_t written = 0;
+    for (uint32_t i = 0; i < db.gameCount; i++) {
+        DatabaseResult result;
+        initPgnTags(&game->tags);
+        game->plyCount = readDatabaseGame(&db, i, game->moves, &result);
+        if (game->plyCount < 0) {
+            fprintf(stderr, "Error: Game %u is corrupt, skipped\n", i);
+            continue;
+        }
+        strcpy(game->tags.result, resultNames[result]);
+        snprintf(game->tags.round, sizeof(game->tags.round), "%u", i + 1);
+        if (!writePgnGame(output, game)) {
+            break;
+        }
+        written++;
+    }
+    double seconds = secondsSince(start);
+    bool ok = fclose(output) == 0 && written == db.gameCount;
+    free(game);
+    closeGameDatabase(&db);
+
+    printf("Exported %u games in %.2f s, %.0f games/s\n", written, seconds, seconds > 0 ? written / seconds : 0.0);
+    return ok ? 0 : 1;
+}
+
+static int rebuildIndex(const char* dbPath) {
+    DatabaseWriter writer;
+    if (!openDatabaseWriter(&writer, dbPath) || !closeDatabaseWriter(&writer)) {
+        return 1;
+    }
+    printf("Index of %s is up to date\n", dbPath);
+    return 0;
+}
+
+static int buildTree(const char* dbPath, const char* treePath, int maxPlies) {
+    GameDatabase db;
+    if (!openGameDatabase(&db, dbPath)) {
+        return 1;
+    }
+    Uint64 start = SDL_GetPerformanceCounter();
+    bool built = buildOpeningTree(&db, treePath, maxPlies);
+    double seconds = secondsSince(start);
+    uint32_t gameCount = db.gameCount;
+    closeGameDatabase(&db);
+    if (!built) {
+        return 1;
+    }
+
+    OpeningTree tree;
+    if (!openOpeningTree(&tree, treePath)) {
+        return 1;
+    }
+    printf("Opening tree of %u games to ply %d: %llu moves in %.2f s\n", gameCount, maxPlies,
+           (unsigned long long)tree.entryCount, seconds);
+    closeOpeningTree(&tree);
+    return 0;
+}
+
+static int findGames(const char* dbPath, const char* fen, int limit) {
+    unsigned char board[8][8];
+    bool blackTurn;
+    Vector2f lastDoublePawn;
+    if (!loadFEN(fen, board, &blackTurn, &lastDoublePawn)) {
+        fprintf(stderr, "Error: Invalid FEN %s\n", fen);
+        return 1;
+    }
+    GameDatabase db;
+    if (!openGameDatabase(&db, dbPath)) {
+        return 1;
+    }
+
+    Uint64 start = SDL_GetPerformanceCounter();
+    size_t count;
+    uint64_t key = hashPosition(board, blackTurn ? 1 : 0, &lastDoublePawn);
+    const DatabasePosting* postings = findPosition(&db, key, &count);
+    double ms = 1000.0 * secondsSince(start);
+
+    int results[4] = {0};
+    for (size_t i = 0; i < count; i++) {
+        const unsigned char* record = db.games.data + db.gameOffsets[postings[i].game];
+        results[record[4] <= DB_RESULT_DRAW ? record[4] : DB_RESULT_UNKNOWN]++;
+    }
+    printf("%zu of %u games reach the position (%.3f ms): +%d =%d -%d *%d\n", count, db.gameCount, ms,
+           results[DB_RESULT_WHITE_WINS], results[DB_RESULT_DRAW], results[DB_RESULT_BLACK_WINS],
+           results[DB_RESULT_UNKNOWN]);
+    for (size_t i = 0; i < count && i < (size_t)limit; i++) {
+        const unsigned char* record = db.games.data + db.gameOffsets[postings[i].game];
+        printf("  game %u at ply %u, %s\n", postings[i].game, postings[i].ply,
+               resultNames[record[4] <= DB_RESULT_DRAW ? record[4] : DB_RESULT_UNKNOWN]);
+    }
+    closeGameDatabase(&db);
+    return 0;
+}
+
+static int showGame(const char* dbPath, uint32_t game) {
+    GameDatabase db;
+    if (!openGameDatabase(&db, dbPath)) {
+        return 1;
+    }
+    EngineMove* moves = malloc(DATABASE_MAX_PLIES * sizeof(EngineMove));
+    DatabaseResult result;
+    int plyCount = moves ? readDatabaseGame(&db, game, moves, &result) : -1;
+    if (plyCount < 0) {
+        fprintf(stderr, "Error: Cannot read game %u of %s\n", game, dbPath);
+        free(moves);
+        closeGameDatabase(&db);
+        return 1;
+    }
+
+    for (int ply = 0; ply < plyCount; ply++) {
+        if (ply % 2 == 0) printf("%d. ", ply / 2 + 1);
+        printf("%c%d%c%d", 'a' + moves[ply].from.y, 8 - moves[ply].from.x, 'a' + moves[ply].to.y, 8 - moves[ply].to.x);
+        if (moves[ply].isPromotion) {
+            printf("%c", "  bnrq"[moves[ply].promotionPiece & TYPE_MASK]);
+        }
+        printf(" ");
+    }
+    printf("%s\n", resultNames[result]);
+    free(moves);
+    closeGameDatabase(&db);
+    return 0;
+}
+
+static void printUsage(const char* program) {
+    printf("Usage: %s import <db> <games.pgn|games.txt>\n", program);
+    printf("       %s export <db> <games.pgn>\n", program);
+    printf("       %s index <db>\n", program);
+    printf("       %s tree <db> <out> [-plies N]\n", program);
+    printf("       %s find <db> <FEN> [-limit N]\n", program);
+    printf("       %s show <db> <game>\n", program);
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 3) {
+        printUsage(argv[0]);
+        return 1;
+    }
+    initializeEngine();
+
+    if (strcmp(argv[1], "import") == 0 && argc == 4) {
+        return importGames(argv[2], argv[3]);
+    }
+    if (strcmp(argv[1], "export") == 0 && argc == 4) {
+        return exportGames(argv[2], argv[3]);
+    }
+    if (strcmp(argv[1], "index") == 0 && argc == 3) {
+        return rebuildIndex(argv[2]);
+    }
+    if (strcmp(argv[1], "tree") == 0 && argc >= 4) {
+        int maxPlies = OPENING_TREE_PLIES;
+        if (argc == 6 && strcmp(argv[4], "-plies") == 0) {
+            maxPlies = atoi(argv[5]);
+        } else if (argc != 4) {
+            printUsage(argv[0]);
+            return 1;
+        }
+        return buildTree(argv[2], argv[3], maxPlies);
+    }
+    if (strcmp(argv[1], "find") == 0 && argc >= 4) {
+        int limit = DEFAULT_FIND_LIMIT;
+        if (argc == 6 && strcmp(argv[4], "-limit") == 0) {
+            limit = atoi(argv[5]);
+        } else if (argc != 4) {
+            printUsage(argv[0]);
+            return 1;
+        }
+        return findGames(argv[2], argv[3], limit);
+    }
+    if (strcmp(argv[1], "show") == 0 && argc == 4) {
+        return showGame(argv[2], (uint32_t)strtoul(argv[3], NULL, 10));
+    }
+    printUsage(argv[0]);
+    return 1;
+}
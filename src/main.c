@@ -1,5 +1,6 @@
 #include <stdio.h>
 #include <stdint.h>
+#include <stdlib.h>
 #include <stdbool.h>
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_image.h>
@@ -13,6 +14,19 @@
 #include "util.h" // Now includes screen dimension constants
 #include "engine.h"
 #include "GameState.h"
+#include "ComputerPlayer.h"
+#include "History.h"
+#include "OpeningExplorer.h"
+#include "PositionAnalyzer.h"
+#include "TextCache.h"
+#include "FontManager.h"
+#include "Scene.h"
+#include "MoveHistoryView.h"
+#include "SoundBank.h"
+#include "Resources.h"
+#include "Profiler.h"
+#include "InputRecorder.h"
+#include <time.h>
 #include "app_globals.h"
 
 // --- GLOBAL VARIABLE DEFINITIONS (from app_globals.h) ---
@@ -21,13 +35,18 @@ GamePromptActionType currentPromptAction = PROMPT_ACTION_NONE;
 char inputFileNameBuffer[256] = "";
 SDL_bool textInputActive = SDL_FALSE;
 
-// GameState history management variables - DEFINED HERE (declared in GameState.h)
-GameState historyStates[MAX_HISTORY_STATES];
-int historyCount = 0;
-int currentHistoryIdx = -1;
+// Undo/redo log behind recordGameState, undoGame and redoGame
+GameHistory gameHistory;
+
+// What has to be redrawn before the next present
+Scene scene;
 // --- END GLOBAL VARIABLE DEFINITIONS ---
 
-int moveHistoryScrollOffset = 0;
+// Move list in the second sidebar; its area is laid out when it is drawn
+MoveHistoryView moveHistoryView;
+
+// The PvE opponent; its ponder search is dropped whenever the position is set other than by a move
+ComputerPlayer computer;
 
 /*----------Variable declaration------------*/
 bool gameRunning = true; // This should be state->gameRunning after initGameState
@@ -44,7 +63,6 @@ SDL_Color color_risky = {255, 128, 0, 255}; // Orange color for risky moves
 // REMOVED: const int screenWidth, screenHeight, squareSize, boardWidth, sidebar1_width, sidebar2_width, etc.
 // These are now external constants from util.h/util.c
 
-Uint64 currentTick, lastTick;
 double deltaTime;
 
 // Engine variables
@@ -89,21 +107,7 @@ bool init() {
         return false;
     }
 
-    if (Mix_OpenAudio(44100, MIX_DEFAULT_FORMAT, 2, 2048) < 0) {
-        printf("SDL_mixer failed: %s\n", Mix_GetError());
-        return false;
-    }
-
-    // Corrected font paths to ../res/fonts/
-    if (!initFont("../res/fonts/DejaVuSans-Bold.ttf", 24)) {
-        if (!initFont("../res/fonts/FreeSans.ttf", 24)) {
-            if (!initFont("../res/fonts/LiberationSans-Regular.ttf", 24)) {
-                fprintf(stderr, "Font failed to load, check the path and font file.\n");
-                return false;
-            }
-        }
-    }
-
+    // Fonts, sprites and sounds follow on loading threads, see startLoadingResources
     return true;
 }
 
@@ -119,48 +123,49 @@ void printfBoard(unsigned char board[8][8]) {
 
 /* --- NEW UNDO/REDO FUNCTIONS --- */
 void recordGameState(GameState* state) {
-    // If we are not at the latest state (i.e., some undos have happened),
-    // a new move truncates the redo history.
-    if (currentHistoryIdx < historyCount - 1) {
-        historyCount = currentHistoryIdx + 1;
-    }
+    // A new move truncates the redo history; clicks that didn't move anything aren't recorded
+    int previousMoveCount = gameHistory.current >= 0 ? gameHistory.currentState.moveCount : -1;
+    if (recordHistory(&gameHistory, state)) {
+        printf("Recorded state %d. Total states: %d\n", gameHistory.current, gameHistory.count);
+        invalidateScene(&scene, SCENE_POSITION);
+
+        // Sounded in the frame the move is made: the effects are already decoded
+        if (previousMoveCount >= 0 && state->moveCount == previousMoveCount + 1) {
+            playSound(moveSoundEvent(getMoveNotation(state, state->moveCount - 1), state->status.gameOver));
+        }
 
-    // Check for array bounds
-    if (historyCount >= MAX_HISTORY_STATES) {
-        // Option 1: Shift history to make space (more complex, not implemented here)
-        // Option 2: Just don't record if history is full (simple)
-        printf("History buffer full. Cannot record more states.\n");
-        return;
+        // Follow the game: the new move comes into view
+        scrollMoveHistoryToEnd(&moveHistoryView, state->moveCount);
     }
+}
 
-    currentHistoryIdx++;
-    historyStates[currentHistoryIdx] = *state; // Copy the entire current game state
-    historyCount = currentHistoryIdx + 1; // Update total count of states
-    printf("Recorded state %d. Total states: %d\n", currentHistoryIdx, historyCount);
+void resetGameHistory(GameState* state) {
+    stopPondering(&computer);
+    clearGameHistory(&gameHistory);
+    recordGameState(state);
+}
 
-    // Reset scroll offset to show current moves after recording a new state
-    moveHistoryScrollOffset = 0;
+// Jump straight to any recorded state
+static void gotoGameState(GameState* state, int index) {
+    if (gotoHistoryEntry(&gameHistory, state, index)) {
+        stopPondering(&computer);
+        invalidateScene(&scene, SCENE_POSITION);
+        // Bring the restored state's last move into view
+        scrollMoveHistoryToEnd(&moveHistoryView, state->moveCount);
+    }
 }
 
 void undoGame(GameState* state) {
-    if (currentHistoryIdx > 0) {
-        currentHistoryIdx--;
-        *state = historyStates[currentHistoryIdx]; // Revert to previous state
-        printf("Undone to state %d.\n", currentHistoryIdx);
-        // Reset scroll offset to show the newly reverted state's moves
-        moveHistoryScrollOffset = 0;
+    if (gameHistory.current > 0) {
+        gotoGameState(state, gameHistory.current - 1);
     } else {
         printf("Cannot undo further.\n");
     }
 }
 
 void redoGame(GameState* state) {
-    if (currentHistoryIdx < historyCount - 1) {
-        currentHistoryIdx++;
-        *state = historyStates[currentHistoryIdx]; // Re-apply next state
-        printf("Redone to state %d.\n", currentHistoryIdx);
-        // Reset scroll offset to show the newly redone state's moves
-        moveHistoryScrollOffset = 0;
+    if (gameHistory.current < gameHistory.count - 1) {
+        gotoGameState(state, gameHistory.current + 1);
     } else {
         printf("Cannot redo further.\n");
     }
@@ -196,123 +201,133 @@ void drawEvaluationBar(SDL_Renderer* renderer, int score) {
     SDL_RenderDrawRect(renderer, &borderRect);
 
     // Draw evaluation value
-    TTF_Font* font = TTF_OpenFont("../res/fonts/DejaVuSans.ttf", 16); // Corrected font path
-    if (font) {
-        char scoreText[32];
-        snprintf(scoreText, sizeof(scoreText), "%.2f", score / 100.0f);
-
-        SDL_Color textColor = {255, 255, 255, 255};
-        SDL_Surface* textSurface = TTF_RenderText_Solid(font, scoreText, textColor);
-        if (textSurface) {
-            SDL_Texture* textTexture = SDL_CreateTextureFromSurface(renderer, textSurface);
-            SDL_Rect textRect = {
-                    barX - textSurface->w - 5, // Position to the left of the bar
-                    barY + barHeight / 2 - textSurface->h / 2,
-                    textSurface->w,
-                    textSurface->h
-            };
-            SDL_RenderCopy(renderer, textTexture, NULL, &textRect);
-            SDL_DestroyTexture(textTexture);
-            SDL_FreeSurface(textSurface);
-        }
-        TTF_CloseFont(font);
+    char scoreText[32];
+    snprintf(scoreText, sizeof(scoreText), "%.2f", score / 100.0f);
+
+    int textWidth, textHeight;
+    SDL_Color textColor = {255, 255, 255, 255};
+    SDL_Texture* textTexture = getTextTexture(renderer, getFont(FONT_SANS, SMALL_FONT_SIZE), scoreText, textColor, &textWidth, &textHeight);
+    if (textTexture) {
+        SDL_Rect textRect = {
+                barX - textWidth - 5, // Position to the left of the bar
+                barY + barHeight / 2 - textHeight / 2,
+                textWidth,
+                textHeight
+        };
+        SDL_RenderCopy(renderer, textTexture, NULL, &textRect);
     }
 }
 
-// Function to draw game status text (check, checkmate, stalemate)
-void drawGameStatus(SDL_Renderer* renderer, bool isInCheck, bool isGameOver, bool isStalemate, bool blackTurn) {
-    TTF_Font* font = TTF_OpenFont("../res/fonts/DejaVuSans-Bold.ttf", 24); // Corrected font path
+// Function to draw game status text (check, checkmate, stalemate, draws by rule)
+void drawGameStatus(SDL_Renderer* renderer, const GameStatus* status, bool blackTurn) {
+    TTF_Font* font = getFont(FONT_SANS_BOLD, UI_FONT_SIZE);
     if (!font) return;
 
     SDL_Color textColor = {255, 0, 0, 255}; // Red for check/checkmate
-    if (isStalemate) textColor = (SDL_Color){255, 255, 0, 255}; // Yellow for stalemate
-
-    char statusText[32] = "";
-    if (isGameOver) {
-        if (isStalemate) {
-            strcpy(statusText, "Stalemate! Draw");
-        } else {
-            sprintf(statusText, "Checkmate! %s wins", blackTurn ? "White" : "Black");
-        }
-    } else if (isInCheck) {
+    if (status->stalemate || status->drawReason != DRAW_NONE) textColor = (SDL_Color){255, 255, 0, 255}; // Yellow for draws
+
+    char statusText[40] = "";
+    if (status->drawReason == DRAW_REPETITION) {
+        strcpy(statusText, "Draw by threefold repetition");
+    } else if (status->drawReason == DRAW_FIFTY_MOVES) {
+        strcpy(statusText, "Draw by fifty-move rule");
+    } else if (status->drawReason == DRAW_INSUFFICIENT_MATERIAL) {
+        strcpy(statusText, "Draw by insufficient material");
+    } else if (status->stalemate) {
+        strcpy(statusText, "Stalemate! Draw");
+    } else if (status->checkmate) {
+        sprintf(statusText, "Checkmate! %s wins", blackTurn ? "White" : "Black");
+    } else if (status->inCheck) {
         sprintf(statusText, "%s is in Check", blackTurn ? "Black" : "White");
     }
 
-    if (statusText[0] != '\0') {
-        SDL_Surface* textSurface = TTF_RenderText_Solid(font, statusText, textColor);
-        if (textSurface) {
-            SDL_Texture* textTexture = SDL_CreateTextureFromSurface(renderer, textSurface);
-            if (textTexture) {
-                SDL_Rect textRect = {
-                        (screenWidth - textSurface->w) / 2,
-                        10,  // Top of the screen
-                        textSurface->w,
-                        textSurface->h
-                };
-                SDL_RenderCopy(renderer, textTexture, NULL, &textRect);
-                SDL_DestroyTexture(textTexture);
-            }
-            SDL_FreeSurface(textSurface);
-        }
+    int textWidth, textHeight;
+    SDL_Texture* textTexture = getTextTexture(renderer, font, statusText, textColor, &textWidth, &textHeight);
+    if (textTexture) {
+        SDL_Rect textRect = {
+                (screenWidth - textWidth) / 2,
+                10,  // Top of the screen
+                textWidth,
+                textHeight
+        };
+        SDL_RenderCopy(renderer, textTexture, NULL, &textRect);
     }
-
-    TTF_CloseFont(font);
 }
 
-// Function to analyze the current position for display
-void displayPositionAnalysis(unsigned char board[8][8], bool blackTurn, Vector2f* lastDoublePawn, Vector2f kingsPositions[]) {
-    // Evaluate the current position
-    unsigned char currentColor = blackTurn ? 1 : 0;
-    int score = evaluatePosition(board, currentColor);
-
-    printf("Current evaluation: %.2f\n", score / 100.0f);
+// Function to draw the opening explorer at the bottom of the second sidebar
+void drawOpeningExplorer(SDL_Renderer* renderer, OpeningExplorer* explorer) {
+    int x = boardWidth + sidebar1_width + 10;
+    int y = screenHeight - EXPLORER_PANEL_HEIGHT;
+    SDL_Color white = {255, 255, 255, 255};
+    SDL_Color grey = {150, 150, 150, 255};
 
-    // Generate and evaluate legal moves
-    MoveList legalMoves;
-    generateMoves(board, currentColor, &legalMoves, lastDoublePawn);
+    SDL_SetRenderDrawColor(renderer, 100, 100, 100, 255);
+    SDL_RenderDrawLine(renderer, x, y, x + 240, y);
+    renderText(renderer, "OPENING EXPLORER:", white, x, y + 10);
 
-    if (legalMoves.count == 0) {
-        if (isCheck(board, kingsPositions[currentColor])) {
-            printf("Checkmate! %s wins!\n", blackTurn ? "White" : "Black");
-        } else {
-            printf("Stalemate! Game is drawn.\n");
-        }
+    if (!explorer->available) {
+        renderText(renderer, "No opening tree", grey, x + 5, y + 40);
+        return;
+    }
+    ExplorerResult result;
+    if (!getExplorerResult(explorer, &result)) {
+        return; // Still looking the position up; the next frame will have it
+    }
+    if (result.moveCount == 0) {
+        renderText(renderer, "Out of book", grey, x + 5, y + 40);
         return;
     }
 
-    // Evaluate move safety
-    evaluateMovesSafety(board, currentColor, &legalMoves);
+    char buffer[32];
+    for (int i = 0; i < result.moveCount; i++) {
+        int rowY = y + 40 + i * 25;
+        renderText(renderer, result.moves[i].san, white, x + 5, rowY);
+        snprintf(buffer, sizeof(buffer), "%u", (unsigned)result.moves[i].games);
+        renderText(renderer, buffer, grey, x + 85, rowY);
+        snprintf(buffer, sizeof(buffer), "%d%%", result.moves[i].scorePercent);
+        renderText(renderer, buffer, white, x + 175, rowY);
+    }
+}
 
-    // Find any risky moves
-    bool hasRiskyMoves = false;
-    for (int i = 0; i < legalMoves.count; i++) {
-        if (legalMoves.moves[i].safetyScore < 0) {
-            if (!hasRiskyMoves) {
-                printf("Risky moves detected:\n");
-                hasRiskyMoves = true;
-            }
+// Function to draw the live analysis above the opening explorer, one row per line
+void drawAnalysis(SDL_Renderer* renderer, PositionAnalyzer* analyzer, bool noLegalMoves) {
+    int x = boardWidth + sidebar1_width + 10;
+    int y = screenHeight - EXPLORER_PANEL_HEIGHT - ANALYSIS_PANEL_HEIGHT(analyzer->lineCount);
+    SDL_Color white = {255, 255, 255, 255};
+    SDL_Color grey = {150, 150, 150, 255};
 
-            // Convert board coordinates to algebraic notation
-            char fromFile = 'a' + legalMoves.moves[i].from.y;
-            int fromRank = 8 - legalMoves.moves[i].from.x;
-            char toFile = 'a' + legalMoves.moves[i].to.y;
-            int toRank = 8 - legalMoves.moves[i].to.x;
-
-            unsigned char pieceType = board[legalMoves.moves[i].from.x][legalMoves.moves[i].from.y] & TYPE_MASK;
-            const char* pieceName = "Unknown";
-            switch (pieceType) {
-                case PAWN: pieceName = "Pawn"; break;
-                case KNIGHT: pieceName = "Knight"; break;
-                case BISHOP: pieceName = "Bishop"; break;
-                case ROOK: pieceName = "Rook"; break;
-                case QUEEN: pieceName = "Queen"; break;
-                case KING: pieceName = "King"; break;
-            }
+    SDL_SetRenderDrawColor(renderer, 100, 100, 100, 255);
+    SDL_RenderDrawLine(renderer, x, y, x + 240, y);
 
-            printf("  %s %c%d -> %c%d: Risk score %d\n",
-                   pieceName, fromFile, fromRank, toFile, toRank,
-                   legalMoves.moves[i].safetyScore);
+    AnalysisInfo info;
+    if (noLegalMoves || !getAnalysisInfo(analyzer, &info)) {
+        renderText(renderer, "ANALYSIS:", white, x, y + 10);
+        renderText(renderer, noLegalMoves ? "No legal moves" : "Thinking...", grey, x + 5, y + 40);
+        return;
+    }
+
+    char buffer[64];
+    snprintf(buffer, sizeof(buffer), "ANALYSIS: d%d", info.depth);
+    renderText(renderer, buffer, white, x, y + 10);
+    snprintf(buffer, sizeof(buffer), "%d kn/s", info.nodesPerSecond / 1000);
+    renderText(renderer, buffer, grey, x + 5, y + 40);
+
+    // Score, then as much of the line as fits, cut at a move boundary
+    const int charsPerRow = 11;
+    for (int i = 0; i < info.lineCount; i++) {
+        int rowY = y + 65 + i * 25;
+        formatAnalysisScore(info.lines[i].score, buffer, sizeof(buffer));
+        renderText(renderer, buffer, white, x + 5, rowY);
+
+        const char* pv = info.lines[i].pv;
+        int length = (int)strlen(pv);
+        if (length > charsPerRow) {
+            length = charsPerRow;
+            while (length > 0 && pv[length] != ' ') length--;
+            if (length == 0) length = charsPerRow;
         }
+        snprintf(buffer, sizeof(buffer), "%.*s", length, pv);
+        renderText(renderer, buffer, grey, x + 80, rowY);
     }
 }
 
@@ -324,24 +339,24 @@ bool drawMenu(SDL_Renderer* renderer, int screenWidth_local, int screenHeight_lo
     SDL_Rect overlay = {0, 0, screenWidth_local, screenHeight_local};
     SDL_RenderFillRect(renderer, &overlay);
 
-    // Load font
-    TTF_Font* font = TTF_OpenFont("../res/fonts/DejaVuSans-Bold.ttf", 32); // Corrected font path
+    TTF_Font* font = getFont(FONT_SANS_BOLD, TITLE_FONT_SIZE);
     if (!font) {
-        printf("Failed to load font: %s\n", TTF_GetError());
         return false;
     }
 
     // Title
+    int textWidth, textHeight;
     SDL_Color titleColor = {255, 215, 0, 255}; // Gold color
-    SDL_Surface* titleSurface = TTF_RenderText_Solid(font, "Chess Game", titleColor);
-    SDL_Texture* titleTexture = SDL_CreateTextureFromSurface(renderer, titleSurface);
-    SDL_Rect titleRect = {
-            (screenWidth_local - titleSurface->w) / 2,
-            screenHeight_local / 4 - titleSurface->h / 2,
-            titleSurface->w,
-            titleSurface->h
-    };
-    SDL_RenderCopy(renderer, titleTexture, NULL, &titleRect);
+    SDL_Texture* titleTexture = getTextTexture(renderer, font, "Chess Game", titleColor, &textWidth, &textHeight);
+    if (titleTexture) {
+        SDL_Rect titleRect = {
+                (screenWidth_local - textWidth) / 2,
+                screenHeight_local / 4 - textHeight / 2,
+                textWidth,
+                textHeight
+        };
+        SDL_RenderCopy(renderer, titleTexture, NULL, &titleRect);
+    }
 
     // Button dimensions
     int buttonWidth = 200;
@@ -350,9 +365,6 @@ bool drawMenu(SDL_Renderer* renderer, int screenWidth_local, int screenHeight_lo
 
     // PvP Button
     SDL_Color buttonColor = {255, 255, 255, 255}; // White text
-    SDL_Surface* pvpSurface = TTF_RenderText_Solid(font, "Player vs Player", buttonColor);
-    SDL_Texture* pvpTexture = SDL_CreateTextureFromSurface(renderer, pvpSurface);
-
     SDL_Rect pvpButtonRect = {
             (screenWidth_local - buttonWidth) / 2,
             screenHeight_local / 2 - buttonHeight - buttonSpacing / 2,
@@ -365,18 +377,18 @@ bool drawMenu(SDL_Renderer* renderer, int screenWidth_local, int screenHeight_lo
     SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255); // Button border color
     SDL_RenderDrawRect(renderer, &pvpButtonRect);
 
-    SDL_Rect pvpTextRect = {
-            (screenWidth_local - pvpSurface->w) / 2,
-            pvpButtonRect.y + (buttonHeight - pvpSurface->h) / 2,
-            pvpSurface->w,
-            pvpSurface->h
-    };
-    SDL_RenderCopy(renderer, pvpTexture, NULL, &pvpTextRect);
+    SDL_Texture* pvpTexture = getTextTexture(renderer, font, "Player vs Player", buttonColor, &textWidth, &textHeight);
+    if (pvpTexture) {
+        SDL_Rect pvpTextRect = {
+                (screenWidth_local - textWidth) / 2,
+                pvpButtonRect.y + (buttonHeight - textHeight) / 2,
+                textWidth,
+                textHeight
+        };
+        SDL_RenderCopy(renderer, pvpTexture, NULL, &pvpTextRect);
+    }
 
     // PvE Button
-    SDL_Surface* pveSurface = TTF_RenderText_Solid(font, "Player vs Computer", buttonColor);
-    SDL_Texture* pveTexture = SDL_CreateTextureFromSurface(renderer, pveSurface);
-
     SDL_Rect pveButtonRect = {
             (screenWidth_local - buttonWidth) / 2,
             screenHeight_local / 2 + buttonSpacing / 2,
@@ -389,26 +401,20 @@ bool drawMenu(SDL_Renderer* renderer, int screenWidth_local, int screenHeight_lo
     SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255); // Button border color
     SDL_RenderDrawRect(renderer, &pveButtonRect);
 
-    SDL_Rect pveTextRect = {
-            (screenWidth_local - pveSurface->w) / 2,
-            pveButtonRect.y + (buttonHeight - pveSurface->h) / 2,
-            pvpSurface->w,
-            pvpSurface->h
-    };
-    SDL_RenderCopy(renderer, pveTexture, NULL, &pveTextRect);
-
-    // Clean up
-    SDL_FreeSurface(titleSurface);
-    SDL_DestroyTexture(titleTexture);
-    SDL_FreeSurface(pvpSurface);
-    SDL_DestroyTexture(pvpTexture);
-    SDL_FreeSurface(pveSurface);
-    SDL_DestroyTexture(pveTexture);
-    TTF_CloseFont(font);
+    SDL_Texture* pveTexture = getTextTexture(renderer, font, "Player vs Computer", buttonColor, &textWidth, &textHeight);
+    if (pveTexture) {
+        SDL_Rect pveTextRect = {
+                (screenWidth_local - textWidth) / 2,
+                pveButtonRect.y + (buttonHeight - textHeight) / 2,
+                textWidth,
+                textHeight
+        };
+        SDL_RenderCopy(renderer, pveTexture, NULL, &pveTextRect);
+    }
 
     // Check for button clicks
     int mouseX, mouseY;
-    Uint32 mouseState = SDL_GetMouseState(&mouseX, &mouseY);
+    Uint32 mouseState = getInputMouseState(&mouseX, &mouseY);
 
     if (mouseState & SDL_BUTTON(SDL_BUTTON_LEFT)) {
         if (mouseX >= pvpButtonRect.x && mouseX <= pvpButtonRect.x + pvpButtonRect.w &&
@@ -431,42 +437,321 @@ bool drawMenu(SDL_Renderer* renderer, int screenWidth_local, int screenHeight_lo
     return false;
 }
 
+// Highlights for the selected piece and where it can go
+static BoardOverlay buildBoardOverlay(GameState* state) {
+    BoardOverlay overlay = {-1, 0, 0};
+    if (state->pieceActions[0] && state->selectedSquare.x >= 0) {
+        overlay.selectedSquare = SQUARE((int)state->selectedSquare.y, (int)state->selectedSquare.x);
+        overlay.movable = getSelectedDestinations(state);
+        overlay.risky = attackedDestinations(state->board, overlay.selectedSquare, overlay.movable);
+    }
+    return overlay;
+}
+
+// Where the move list goes: below its title, down to the panels under it (e.g. 800 - 300 - 50 = 18 moves)
+static SDL_Rect moveHistoryArea(int analysisLines) {
+    int panelsHeight = EXPLORER_PANEL_HEIGHT + (analysisLines > 0 ? ANALYSIS_PANEL_HEIGHT(analysisLines) : 0);
+    return (SDL_Rect){boardWidth + sidebar1_width + 15, 40, sidebar2_width - 15, screenHeight - panelsHeight - 50};
+}
+
+// Just the move list, over a fresh background; a scroll redraws nothing else
+static void drawMoveHistoryRegion(GameState* state) {
+    beginStaticRegion(&scene, renderer, &moveHistoryView.area);
+    SDL_SetRenderDrawColor(renderer, 100, 100, 100, 255); // Second sidebar background
+    SDL_RenderFillRect(renderer, &moveHistoryView.area);
+    drawMoveHistory(&moveHistoryView, renderer, state);
+    endStaticRegion(&scene, renderer);
+}
+
+// Both sidebars with everything on them but the captured pieces
+static void drawSidebars(GameState* state, OpeningExplorer* explorer, const SDL_Rect* sidebarRegion) {
+    beginStaticRegion(&scene, renderer, sidebarRegion);
+
+    // First sidebar background
+    SDL_Rect sidebar1_background = {boardWidth, 0, sidebar1_width, screenHeight};
+    SDL_SetRenderDrawColor(renderer, 120, 120, 120, 255);
+    SDL_RenderFillRect(renderer, &sidebar1_background);
+
+    // Second sidebar background
+    SDL_Rect sidebar2_background = {boardWidth + sidebar1_width, 0, sidebar2_width, screenHeight};
+    SDL_SetRenderDrawColor(renderer, 100, 100, 100, 255); // Slightly different color for distinction
+    SDL_RenderFillRect(renderer, &sidebar2_background);
+
+    // Timer labels; the times themselves are drawn over the layer
+    renderText(renderer, "White:", (SDL_Color){255, 255, 255, 255}, boardWidth + 10, 10);
+    renderText(renderer, "Black:", (SDL_Color){255, 255, 255, 255}, boardWidth + 10, 40);
+
+    // Labels for captured pieces in the first sidebar
+    renderText(renderer, "Captured by white:", (SDL_Color) {255, 255, 255, 255}, boardWidth + 10, timer_height + 10);
+    renderText(renderer, "Captured by black:", (SDL_Color) {255, 255, 255, 255}, boardWidth + 10, timer_height + captured_area_height + 10);
+
+    // Buttons at the bottom of the first sidebar
+    SDL_Rect saveButton = {boardWidth + 10, screenHeight - 140, 140, 40};
+    SDL_Rect loadButton = {boardWidth + 160, screenHeight - 140, 140, 40};
+    SDL_Rect undoButton = {boardWidth + 10, screenHeight - 90, 140, 40}; // Example position
+    SDL_Rect redoButton = {boardWidth + 160, screenHeight - 90, 140, 40}; // Example position
+
+    SDL_SetRenderDrawColor(renderer, 0, 150, 0, 255); // Green for save
+    SDL_RenderFillRect(renderer, &saveButton);
+    renderText(renderer, "Save", (SDL_Color){255, 255, 255, 255}, saveButton.x + 10, saveButton.y + 5);
+
+    SDL_SetRenderDrawColor(renderer, 0, 0, 150, 255); // Blue for load
+    SDL_RenderFillRect(renderer, &loadButton);
+    renderText(renderer, "Load", (SDL_Color){255, 255, 255, 255}, loadButton.x + 10, loadButton.y + 5);
+
+    SDL_SetRenderDrawColor(renderer, 150, 50, 0, 255); // Orange for undo
+    SDL_RenderFillRect(renderer, &undoButton);
+    renderText(renderer, "Undo", (SDL_Color){255, 255, 255, 255}, undoButton.x + 40, undoButton.y + 5);
+
+    SDL_SetRenderDrawColor(renderer, 0, 150, 150, 255); // Cyan for redo
+    SDL_RenderFillRect(renderer, &redoButton);
+    renderText(renderer, "Redo", (SDL_Color){255, 255, 255, 255}, redoButton.x + 40, redoButton.y + 5);
+
+    // Move history at the top of the second sidebar; the moves themselves have a region of their own
+    renderText(renderer, "MOVE HISTORY:", (SDL_Color){255, 255, 255, 255}, boardWidth + sidebar1_width + 10, 10);
+
+    drawOpeningExplorer(renderer, explorer);
+    endStaticRegion(&scene, renderer);
+    drawMoveHistoryRegion(state);
+}
+
+// Board, sidebars and everything on them that only changes with the position; only the
+// regions holding a part in 'parts' are redrawn. The pieces of both regions are queued
+// while drawing them and go out last, in a single batch from the atlas.
+static void drawStaticParts(Uint32 parts, GameState* state, const PieceAtlas* atlas,
+                            OpeningExplorer* explorer, int analysisLines) {
+    // A resized move list leaves old lines where the panels below it now go: redraw the sidebars
+    SDL_Rect historyArea = moveHistoryArea(analysisLines);
+    bool historyResized = historyArea.h != moveHistoryView.area.h;
+    setMoveHistoryArea(&moveHistoryView, historyArea, state->moveCount);
+
+    bool boardDirty = parts & (SCENE_BOARD | SCENE_PIECES);
+    bool sidebarDirty = (parts & (SCENE_PIECES | SCENE_EXPLORER)) || historyResized;
+    bool historyDirty = parts & SCENE_HISTORY;
+    if (!boardDirty && !sidebarDirty && !historyDirty) {
+        return;
+    }
+    static PieceBatch pieceBatch;
+    clearPieceBatch(&pieceBatch);
+    SDL_Rect boardRegion = {0, 0, boardWidth, boardWidth};
+    SDL_Rect sidebarRegion = {boardWidth, 0, screenWidth - boardWidth, screenHeight};
+
+    if (boardDirty) {
+        BoardOverlay boardOverlay = buildBoardOverlay(state);
+        beginStaticRegion(&scene, renderer, &boardRegion);
+        drawBoard(renderer, squareSize, 0, color_light, color_dark, color_clicked, color_possible, color_risky, &boardOverlay);
+        endStaticRegion(&scene, renderer);
+        for (int row = 0; row < 8; row++) {
+            for (int col = 0; col < 8; col++) {
+                SDL_Rect square = {col * squareSize, row * squareSize, squareSize, squareSize};
+                addPieceToBatch(&pieceBatch, atlas, state->board[row][col], square);
+            }
+        }
+    }
+
+    if (sidebarDirty) {
+        drawSidebars(state, explorer, &sidebarRegion);
+        batchCapturedPieces(&pieceBatch, atlas, state);
+    } else if (historyDirty) {
+        drawMoveHistoryRegion(state);
+    }
+    if (!boardDirty && !sidebarDirty) {
+        return;
+    }
+
+    // Clipped to whatever was redrawn: both regions together cover the window
+    SDL_Rect pieceRegion = boardDirty ? boardRegion : sidebarRegion;
+    if (boardDirty && sidebarDirty) {
+        pieceRegion = (SDL_Rect){0, 0, screenWidth, screenHeight};
+    }
+    beginStaticRegion(&scene, renderer, &pieceRegion);
+    drawPieceBatch(&pieceBatch, renderer, atlas);
+    endStaticRegion(&scene, renderer);
+}
+
+#define BACKGROUND_POLL_MS 50 // How often to look in on running searches and lookups
+
+// How long the loop may sleep: until the running clock shows its next second, and no
+// longer than a poll interval while a search or lookup could finish
+static int idleTimeout(const GameState* state, bool backgroundPending) {
+    int clockMs = state->blackTurn ? state->blackTimeMs : state->whiteTimeMs;
+    int timeout = clockMs > 0 ? clockMs % 1000 + 1 : 1000;
+    if (backgroundPending && timeout > BACKGROUND_POLL_MS) {
+        timeout = BACKGROUND_POLL_MS;
+    }
+    return timeout;
+}
+
+#define LOADING_POLL_MS 16 // How often the menu looks in on the loading threads
+
+// What the loading threads produce while the menu is up
+typedef struct {
+    AudioConfig audio;
+    SDL_Surface* pieceSheet;     // Uploaded into the atlas on the main thread
+    bool fontsLoaded;
+    int fontJob;
+} StartupResources;
+
+static int loadFontsJob(void* data) {
+    StartupResources* resources = data;
+    resources->fontsLoaded = loadFonts();
+    return 0;
+}
+
+static int loadPieceSheetJob(void* data) {
+    StartupResources* resources = data;
+    resources->pieceSheet = buildPieceSheet(squareSize, CAPTURED_PIECE_SIZE);
+    return 0;
+}
+
+static int loadSoundsJob(void* data) {
+    StartupResources* resources = data;
+    loadSounds(&resources->audio);
+    return 0;
+}
+
+// Fonts, sprites and sounds are read and decoded in parallel, each on a thread of its own,
+// instead of one after the other before the first frame
+static void startLoadingResources(StartupResources* resources) {
+    resources->fontJob = startResourceJob("fonts", loadFontsJob, resources, PRELOADED_FONT_COUNT);
+    startResourceJob("piece sprites", loadPieceSheetJob, resources, 12);
+    startResourceJob("sounds", loadSoundsJob, resources, LOADED_SOUND_ASSETS);
+}
+
+// Progress of the startup loading, along the bottom of the menu
+static void drawLoadingBar(SDL_Renderer* renderer, float progress) {
+    SDL_Rect outline = {(screenWidth - 400) / 2, screenHeight - 80, 400, 12};
+    SDL_Rect filled = {outline.x, outline.y, (int)(outline.w * progress), outline.h};
+    SDL_SetRenderDrawColor(renderer, 50, 100, 150, 255);
+    SDL_RenderFillRect(renderer, &filled);
+    SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
+    SDL_RenderDrawRect(renderer, &outline);
+}
+
+// The computer's move once it is ready: searched, or the recorded one when replaying
+static bool nextComputerMove(ComputerPlayer* computer, GameState* state, EngineMove* move) {
+    if (getInputMode() == INPUT_REPLAYING) {
+        return replayComputerMove(move);
+    }
+    if (!updateComputerPlayer(computer, state, move)) {
+        return false;
+    }
+    recordEngineSearch(&computer->lastResult);
+    recordComputerMove(move);
+    return true;
+}
+
+static double millisecondsSince(Uint64 start) {
+    return 1000.0 * (SDL_GetPerformanceCounter() - start) / SDL_GetPerformanceFrequency();
+}
+
 int main(int argc, char* argv[]) {
+    Uint64 startupCounter = SDL_GetPerformanceCounter();
+
+    // Smaller buffers cut the delay before a sound plays, at the risk of crackling on slow machines
+    StartupResources resources = {0};
+    resources.audio = defaultAudioConfig();
+    const char* tracePath = NULL;
+    const char* recordPath = NULL;
+    const char* replayPath = NULL;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-audiobuffer") == 0 && i + 1 < argc) {
+            resources.audio.bufferSamples = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-channels") == 0 && i + 1 < argc) {
+            resources.audio.channels = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-trace") == 0 && i + 1 < argc) {
+            tracePath = argv[++i];
+        } else if (strcmp(argv[i], "-record") == 0 && i + 1 < argc) {
+            recordPath = argv[++i];
+        } else if (strcmp(argv[i], "-replay") == 0 && i + 1 < argc) {
+            replayPath = argv[++i];
+        }
+    }
+
+    // A replay runs headless and as fast as it can, from the input of an earlier -record run
+    if (replayPath) {
+        if (!startInputReplay(replayPath)) {
+            return 1;
+        }
+        SDL_setenv("SDL_VIDEODRIVER", "dummy", 1);
+        SDL_setenv("SDL_AUDIODRIVER", "dummy", 1);
+    } else if (recordPath && !startInputRecording(recordPath)) {
+        return 1;
+    }
+
+    // Frame and engine timings for the F3 overlay, and for the trace when asked for
+    initProfiler(tracePath);
+
+    // Assets are found from the executable, whatever the working directory
+    initResourcePaths();
+
+    // Initialize engine first: the game state hashes its starting position
+    initializeEngine();
+
     // Initialize game state
     GameState gameState;
     initGameState(&gameState);
 
     // Initialize SDL
     bool SDLInit = init();
+    if (SDLInit) {
+        startLoadingResources(&resources);
+    }
     bool windowCreation = createWindow("Chess Game", &window, &renderer, screenWidth, screenHeight);
 
     if (!windowCreation || !SDLInit) {
+        waitForResourceJobs();
         return -1;
     }
     printf("Program started successfully\n");
 
     // Record initial game state
+    initMoveHistoryView(&moveHistoryView, moveHistoryArea(0));
+    initGameHistory(&gameHistory);
     recordGameState(&gameState);
 
-    // Load piece textures
-    SDL_Texture* pieceTextures[2][7];
-    loadPieceTextures(pieceTextures, &renderer);
-    SDL_Rect pieceTextureCoordinates = {0, 0, 60, 60};
+    // All piece sprites, pre-scaled for the board and the captured boxes; uploaded once loaded
+    PieceAtlas pieceAtlas = {0};
+
+    // Board and sidebars are kept in a render target and redrawn only where they change
+    initScene(&scene, renderer, screenWidth, screenHeight);
 
     // Initialize game variables
     SDL_Event event;
     int mouseX, mouseY;
-    bool isInCheck = false;
-    bool isGameOver = false;
-    bool isStalemate = false;
-
-    // Initialize engine
-    initializeEngine();
+    // What was last put on screen, to tell when it is out of date
+    int shownClockSeconds[2] = {-1, -1};
+    bool explorerPending = false;
+    uint64_t shownAnalysisKey = 0;
+    int shownAnalysisDepth = 0;
+    bool backgroundPending = false;
+
+    // Initialize computer player
+    initComputerPlayer(&computer);
+
+    // Opening explorer; the game runs without it when no tree has been built
+    OpeningExplorer openingExplorer;
+    char openingTreePath[1100];
+    resourcePath(OPENING_TREE_PATH, openingTreePath, sizeof(openingTreePath));
+    initOpeningExplorer(&openingExplorer, openingTreePath);
+
+    // Infinite analysis of the position on the board, toggled with 'a'
+    PositionAnalyzer analyzer;
+    initPositionAnalyzer(&analyzer);
+
+    // Recorded and replayed runs pass the menu the same number of times: without the loading
+    // threads to look in on, it only wakes up for input
+    if (getInputMode() != INPUT_LIVE) {
+        waitForResourceJobs();
+    }
 
-    // Main menu loop
+    // Main menu loop; it is up while the resources load, and the game starts once both are done
     bool inMenu = true;
-    while (inMenu && gameState.gameRunning) {
-        while (SDL_PollEvent(&event)) {
+    bool loading = true;
+    bool firstFrame = true;
+    while ((inMenu || loading) && gameState.gameRunning) {
+        beginInputTick();
+        while (pollInputEvent(&event)) {
             if (event.type == SDL_QUIT) {
                 gameState.gameRunning = false;
                 inMenu = false;
@@ -489,24 +774,68 @@ int main(int argc, char* argv[]) {
                 }
             }
         }
+        if (loading && resourceJobsDone()) {
+            waitForResourceJobs();
+            loading = false;
+            printf("Resources loaded %.1f ms after start:\n", millisecondsSince(startupCounter));
+            printResourceTimings();
+            if (!resources.fontsLoaded) {
+                gameState.gameRunning = false;
+                break;
+            }
+            createPieceAtlas(&pieceAtlas, renderer, resources.pieceSheet, squareSize, CAPTURED_PIECE_SIZE);
+            resources.pieceSheet = NULL;
+        }
+        if (!inMenu && !loading) {
+            if (gameState.gameRunning) {
+                playSound(SOUND_GAME_START);
+            }
+            break;
+        }
 
-        // Render menu
+        // Render menu; its text waits for the fonts, the bar for everything else
         SDL_SetRenderDrawColor(renderer, 30, 30, 30, 255);
         SDL_RenderClear(renderer);
-        // Pass global screenWidth, screenHeight
-        drawMenu(renderer, screenWidth, screenHeight, &gameMode);
+        if (isResourceJobDone(resources.fontJob) && resources.fontsLoaded) {
+            // Pass global screenWidth, screenHeight
+            drawMenu(renderer, screenWidth, screenHeight, &gameMode);
+        }
+        if (loading) {
+            drawLoadingBar(renderer, resourceProgress());
+        }
         SDL_RenderPresent(renderer);
+        if (firstFrame) {
+            printf("First frame %.1f ms after start\n", millisecondsSince(startupCounter));
+            firstFrame = false;
+        }
+
+        // Nothing on the menu moves by itself: sleep until there is input, or until the
+        // loading threads are due another look
+        if (getInputMode() == INPUT_REPLAYING) {
+            continue;
+        } else if (loading) {
+            SDL_WaitEventTimeout(NULL, LOADING_POLL_MS);
+        } else {
+            SDL_WaitEvent(NULL);
+        }
     }
 
-    // Initialize game time tracking
-    lastTick = SDL_GetPerformanceCounter();
-    currentTick = lastTick;
+    // Initialize game time tracking; the clock is the input clock, so a replay sees the recorded times
+    double lastClockMs = getInputClockMs();
+    Uint64 replayStart = SDL_GetPerformanceCounter();
 
     // Main game loop
     while (gameState.gameRunning) {
-        lastTick = currentTick;
-        currentTick = SDL_GetPerformanceCounter();
-        deltaTime = (double)((currentTick - lastTick) * 1000 / (double)SDL_GetPerformanceFrequency());
+        // Sleep until input arrives, a clock is due to show a new second, or background work
+        // could have finished; an idle window costs nothing between those
+        if (!scene.dirty && getInputMode() != INPUT_REPLAYING) {
+            SDL_WaitEventTimeout(NULL, idleTimeout(&gameState, backgroundPending));
+        }
+        beginProfileFrame();
+
+        beginInputTick();
+        deltaTime = getInputClockMs() - lastClockMs;
+        lastClockMs = getInputClockMs();
 
         // Update timers
         if (gameState.blackTurn) {
@@ -516,11 +845,25 @@ int main(int argc, char* argv[]) {
             gameState.whiteTimeMs -= deltaTime;
             if (gameState.whiteTimeMs < 0) gameState.whiteTimeMs = 0;
         }
+        if (gameState.whiteTimeMs / 1000 != shownClockSeconds[0] || gameState.blackTimeMs / 1000 != shownClockSeconds[1]) {
+            shownClockSeconds[0] = gameState.whiteTimeMs / 1000;
+            shownClockSeconds[1] = gameState.blackTimeMs / 1000;
+            invalidateScene(&scene, SCENE_TIMERS);
+        }
+
+        // The move list glides to where it was scrolled
+        if (animateMoveHistory(&moveHistoryView, deltaTime)) {
+            invalidateScene(&scene, SCENE_HISTORY);
+        }
 
         // Process events
-        while (SDL_PollEvent(&event)) {
+        beginProfilePhase(PHASE_INPUT);
+        while (pollInputEvent(&event)) {
             if (event.type == SDL_QUIT) {
                 gameState.gameRunning = false;
+            } else if (event.type == SDL_WINDOWEVENT || event.type == SDL_RENDER_TARGETS_RESET) {
+                // Uncovered, restored, or the layer's contents were lost
+                invalidateScene(&scene, SCENE_ALL);
             } else if (event.type == SDL_KEYDOWN) {
                 switch (event.key.keysym.sym) {
                     case SDLK_ESCAPE:
@@ -532,14 +875,34 @@ int main(int argc, char* argv[]) {
                         } else if (currentScreenState == GAME_STATE_PLAYING) {
                             inMenu = !inMenu;
                         }
+                        invalidateScene(&scene, SCENE_ALL);
                         break;
                     case SDLK_e:
                         // Toggle evaluation bar
                         showEvaluationBar = !showEvaluationBar;
+                        invalidateScene(&scene, SCENE_EVALUATION);
                         break;
                     case SDLK_a:
                         // Toggle analysis
                         showAnalysis = !showAnalysis;
+                        invalidateScene(&scene, SCENE_ANALYSIS | SCENE_HISTORY);
+                        break;
+                    case SDLK_EQUALS:
+                    case SDLK_KP_PLUS:
+                        // One more analysis line
+                        setAnalysisLines(&analyzer, analyzer.lineCount + 1);
+                        invalidateScene(&scene, SCENE_ANALYSIS | SCENE_HISTORY);
+                        break;
+                    case SDLK_MINUS:
+                    case SDLK_KP_MINUS:
+                        // One analysis line less
+                        setAnalysisLines(&analyzer, analyzer.lineCount - 1);
+                        invalidateScene(&scene, SCENE_ANALYSIS | SCENE_HISTORY);
+                        break;
+                    case SDLK_F3:
+                        // Toggle the frame timing overlay
+                        toggleProfilerOverlay();
+                        invalidateScene(&scene, SCENE_OVERLAY);
                         break;
                     case SDLK_RETURN:
                         // Handle filename prompt confirmation
@@ -548,33 +911,54 @@ int main(int argc, char* argv[]) {
                                 saveGameToFile(&gameState, inputFileNameBuffer);
                             } else if (currentPromptAction == PROMPT_ACTION_LOAD) {
                                 loadGameFromFile(&gameState, inputFileNameBuffer);
-                                recordGameState(&gameState); // Record the loaded state
+                                resetGameHistory(&gameState); // The loaded state starts a new history
                             }
                             currentScreenState = GAME_STATE_PLAYING;
                             SDL_StopTextInput();
                             textInputActive = SDL_FALSE;
+                            invalidateScene(&scene, SCENE_ALL);
+                        }
+                        break;
+                    case SDLK_HOME:
+                        // Jump to the start of the game
+                        if (currentScreenState == GAME_STATE_PLAYING) {
+                            gotoGameState(&gameState, 0);
+                        }
+                        break;
+                    case SDLK_END:
+                        // Jump to the latest recorded move
+                        if (currentScreenState == GAME_STATE_PLAYING) {
+                            gotoGameState(&gameState, gameHistory.count - 1);
                         }
                         break;
                     case SDLK_BACKSPACE:
                         // Handle backspace in text input
                         if (currentScreenState == GAME_STATE_PROMPT_FILENAME && strlen(inputFileNameBuffer) > 0) {
                             inputFileNameBuffer[strlen(inputFileNameBuffer) - 1] = '\0';
+                            invalidateScene(&scene, SCENE_OVERLAY);
                         }
                         break;
                 }
+            } else if (event.type == SDL_MOUSEWHEEL) {
+                // Scroll the move list
+                scrollMoveHistory(&moveHistoryView, -event.wheel.y * MOVE_HISTORY_LINE_HEIGHT, gameState.moveCount);
+                invalidateScene(&scene, SCENE_HISTORY);
             } else if (event.type == SDL_TEXTINPUT) {
                 // Handle text input for filename
                 if (currentScreenState == GAME_STATE_PROMPT_FILENAME) {
                     if (strlen(inputFileNameBuffer) < sizeof(inputFileNameBuffer) - 1) {
                         strcat(inputFileNameBuffer, event.text.text);
+                        invalidateScene(&scene, SCENE_OVERLAY);
                     }
                 }
             } else if (event.type == SDL_MOUSEBUTTONDOWN) {
                 if (event.button.button == SDL_BUTTON_LEFT) {
                     gameState.mouseActions[0] = true;
+                    // A click can select a piece, press a button or pick from the menu
+                    invalidateScene(&scene, SCENE_BOARD | SCENE_OVERLAY);
 
                     // Get mouse position
-                    SDL_GetMouseState(&mouseX, &mouseY);
+                    getInputMouseState(&mouseX, &mouseY);
 
                     // Check for button clicks in sidebar
                     if (currentScreenState == GAME_STATE_PLAYING) {
@@ -587,6 +971,7 @@ int main(int argc, char* argv[]) {
                         if (mouseX >= saveButton.x && mouseX <= saveButton.x + saveButton.w &&
                             mouseY >= saveButton.y && mouseY <= saveButton.y + saveButton.h) {
                             printf("Save Game button clicked! Opening prompt...\n");
+                            invalidateScene(&scene, SCENE_OVERLAY);
                             currentScreenState = GAME_STATE_PROMPT_FILENAME;
                             currentPromptAction = PROMPT_ACTION_SAVE;
                             SDL_StartTextInput();
@@ -596,6 +981,7 @@ int main(int argc, char* argv[]) {
                         else if (mouseX >= loadButton.x && mouseX <= loadButton.x + loadButton.w &&
                                  mouseY >= loadButton.y && mouseY <= loadButton.y + loadButton.h) {
                             printf("Load Game button clicked! Opening prompt...\n");
+                            invalidateScene(&scene, SCENE_OVERLAY);
                             currentScreenState = GAME_STATE_PROMPT_FILENAME;
                             currentPromptAction = PROMPT_ACTION_LOAD;
                             SDL_StartTextInput();
@@ -617,12 +1003,13 @@ int main(int argc, char* argv[]) {
             } else if (event.type == SDL_MOUSEBUTTONUP) {
                 if (event.button.button == SDL_BUTTON_LEFT) {
                     gameState.mouseActions[1] = true;
+                    invalidateScene(&scene, SCENE_BOARD | SCENE_OVERLAY);
                 }
             }
         }
 
         // Handle mouse input for chess moves
-        SDL_GetMouseState(&mouseX, &mouseY);
+        getInputMouseState(&mouseX, &mouseY);
         // Pass &gameState directly to handleMouseInput
         if (mouseX < boardWidth && mouseY < boardWidth && currentScreenState == GAME_STATE_PLAYING && !inMenu) {
             handleMouseInput(&gameState, mouseX, mouseY, squareSize);
@@ -642,33 +1029,91 @@ int main(int argc, char* argv[]) {
             // and it's now the computer's turn.
             // The turn change is now handled inside makeMove.
             if (gameMode == 2 && gameState.blackTurn && computerPlaysBlack && !gameState.mouseActions[0]) {
-                moveTimestamp = SDL_GetTicks();
+                moveTimestamp = (Uint32)getInputClockMs();
             }
         }
 
         // Reset mouse actions
         gameState.mouseActions[0] = false;
         gameState.mouseActions[1] = false;
+        endProfilePhase(PHASE_INPUT);
 
         // Make computer move in PvE mode after delay
-        if (gameMode == 2 && gameState.blackTurn && computerPlaysBlack && SDL_GetTicks() - moveTimestamp > 500) {
+        beginProfilePhase(PHASE_ENGINE);
+        // Nothing to ponder once the game is over or the computer is out of it
+        if (gameState.status.gameOver || gameMode != 2) {
+            stopPondering(&computer);
+        }
+        if (gameMode == 2 && gameState.blackTurn && computerPlaysBlack && (Uint32)getInputClockMs() - moveTimestamp > 500) {
             unsigned char color = gameState.blackTurn ? 1 : 0;
-            EngineMove bestMove = findBestMove(gameState.board, color, &gameState.lastDoublePushPawn, gameState.kingsPositions);
-
-            if (bestMove.from.x != -1) {
+            EngineMove bestMove;
+
+            // No moving on once the game is over, mated or drawn; the search runs in the background
+            if (!gameState.status.gameOver &&
+                nextComputerMove(&computer, &gameState, &bestMove)) {
+                bool irreversible = bestMove.capturedPiece != NONE ||
+                                    (gameState.board[bestMove.from.x][bestMove.from.y] & TYPE_MASK) == PAWN;
+                addMoveToHistory(&gameState, bestMove);
                 engineMakeMove(gameState.board, bestMove, &gameState.lastDoublePushPawn, gameState.kingsPositions, 1);
                 gameState.blackTurn = !gameState.blackTurn; // Computer made its move, change turn
+                recordPosition(&gameState.positionHistory, gameState.board, color ^ 1, &gameState.lastDoublePushPawn, irreversible);
+                updateGameStatus(&gameState);
                 recordGameState(&gameState); // Record computer's move
+
+                // Think on the human's time; a replay has the human's moves already
+                if (getInputMode() != INPUT_REPLAYING) {
+                    startPondering(&computer, &gameState);
+                }
             }
         }
 
-        // Check game status
-        isInCheck = isCheck(gameState.board, gameState.kingsPositions[gameState.blackTurn ? 1 : 0]);
+        // Analysis follows the position; a move cancels the old search before the next frame
+        if (showAnalysis && gameState.status.legalMoveCount > 0) {
+            updatePositionAnalyzer(&analyzer, &gameState);
+        } else {
+            stopPositionAnalyzer(&analyzer);
+        }
+        AnalysisInfo analysisInfo;
+        if (showAnalysis && getAnalysisInfo(&analyzer, &analysisInfo) &&
+            (analysisInfo.key != shownAnalysisKey || analysisInfo.depth != shownAnalysisDepth)) {
+            shownAnalysisKey = analysisInfo.key;
+            shownAnalysisDepth = analysisInfo.depth;
+            invalidateScene(&scene, SCENE_ANALYSIS);
+        }
 
-        MoveList moveList;
-        generateMoves(gameState.board, gameState.blackTurn ? 1 : 0, &moveList, &gameState.lastDoublePushPawn);
-        isGameOver = (moveList.count == 0 && isInCheck);
-        isStalemate = (moveList.count == 0 && !isInCheck);
+        // The lookup runs on the explorer's thread; this only hands over a new position
+        requestExplorerPosition(&openingExplorer, &gameState);
+        ExplorerResult explorerResult;
+        bool explorerReady = getExplorerResult(&openingExplorer, &explorerResult);
+        if (explorerReady && explorerPending) {
+            invalidateScene(&scene, SCENE_EXPLORER);
+        }
+        explorerPending = openingExplorer.available && !explorerReady;
+
+        // Keep waking up while a search or lookup may hand over something new
+        backgroundPending = (gameMode == 2 && gameState.blackTurn && computerPlaysBlack && !gameState.status.gameOver) ||
+                            (showAnalysis && isSearchThreadRunning(&analyzer.search)) ||
+                            explorerPending;
+        endProfilePhase(PHASE_ENGINE);
+
+        // The overlay's numbers are kept up to date while it is shown
+        if (isProfilerOverlayStale()) {
+            invalidateScene(&scene, SCENE_OVERLAY);
+        }
+        backgroundPending = backgroundPending || isProfilerOverlayVisible();
+
+        // Nothing changed: nothing to draw and nothing to present
+        if (!scene.dirty) {
+            endProfileFrame(false);
+            continue;
+        }
+        beginProfilePhase(PHASE_RENDER);
+        int analysisLines = showAnalysis ? analyzer.lineCount : 0;
+
+        // The static layer is brought up to date off screen first, then copied under the rest
+        if (!inMenu && scene.staticLayer) {
+            drawStaticParts(scene.dirty & SCENE_STATIC_PARTS, &gameState, &pieceAtlas, &openingExplorer, analysisLines);
+        }
 
         // Clear screen
         SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
@@ -677,143 +1122,90 @@ int main(int argc, char* argv[]) {
         if (inMenu) {
             // Render menu overlay
             drawMenu(renderer, screenWidth, screenHeight, &gameMode);
-        } else if (currentScreenState == GAME_STATE_PROMPT_FILENAME) {
-            // Render the main game in the background
-            drawBoard(renderer, squareSize, 0, color_light, color_dark, color_clicked, color_possible, color_risky, gameState.board);
-
-            // Render pieces
-            for (int row = 0; row < 8; row++) {
-                for (int col = 0; col < 8; col++) {
-                    if (gameState.board[row][col] & TYPE_MASK) {
-                        renderPiece(pieceTextureCoordinates, 0, squareSize, row, col,
-                                    getPieceTexture(pieceTextures, gameState.board[row][col]), &renderer);
-                    }
-                }
+        } else {
+            if (scene.staticLayer) {
+                drawStaticLayer(&scene, renderer);
+            } else {
+                drawStaticParts(SCENE_STATIC_PARTS, &gameState, &pieceAtlas, &openingExplorer, analysisLines);
             }
 
-            // Render the prompt overlay
-            SDL_SetRenderDrawColor(renderer, 0, 0, 0, 150);
-            SDL_Rect dimmer = {0, 0, screenWidth, screenHeight};
-            SDL_RenderFillRect(renderer, &dimmer);
-
-            SDL_Rect promptBox = {screenWidth / 2 - 200, screenHeight / 2 - 75, 400, 150};
-            SDL_SetRenderDrawColor(renderer, 50, 50, 50, 255);
-            SDL_RenderFillRect(renderer, &promptBox);
-            SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
-            SDL_RenderDrawRect(renderer, &promptBox);
-
-            char promptText[64];
-            if (currentPromptAction == PROMPT_ACTION_SAVE) {
-                snprintf(promptText, sizeof(promptText), "Enter filename to SAVE:");
-            } else if (currentPromptAction == PROMPT_ACTION_LOAD) {
-                snprintf(promptText, sizeof(promptText), "Enter filename to LOAD:");
+            if (currentScreenState == GAME_STATE_PROMPT_FILENAME) {
+                // Render the prompt overlay over the game
+                SDL_SetRenderDrawColor(renderer, 0, 0, 0, 150);
+                SDL_Rect dimmer = {0, 0, screenWidth, screenHeight};
+                SDL_RenderFillRect(renderer, &dimmer);
+
+                SDL_Rect promptBox = {screenWidth / 2 - 200, screenHeight / 2 - 75, 400, 150};
+                SDL_SetRenderDrawColor(renderer, 50, 50, 50, 255);
+                SDL_RenderFillRect(renderer, &promptBox);
+                SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
+                SDL_RenderDrawRect(renderer, &promptBox);
+
+                char promptText[64];
+                if (currentPromptAction == PROMPT_ACTION_SAVE) {
+                    snprintf(promptText, sizeof(promptText), "Enter filename to SAVE:");
+                } else if (currentPromptAction == PROMPT_ACTION_LOAD) {
+                    snprintf(promptText, sizeof(promptText), "Enter filename to LOAD:");
+                } else {
+                    snprintf(promptText, sizeof(promptText), "Enter filename:");
+                }
+                renderText(renderer, promptText, (SDL_Color){255, 255, 255, 255}, promptBox.x + 20, promptBox.y + 10);
+                renderText(renderer, inputFileNameBuffer, (SDL_Color){255, 255, 255, 255}, promptBox.x + 20, promptBox.y + 50);
+                renderText(renderer, "Press ENTER to confirm", (SDL_Color){150, 150, 150, 255}, promptBox.x + 20, promptBox.y + 90);
+                renderText(renderer, "Press ESC to cancel", (SDL_Color){150, 150, 150, 255}, promptBox.x + 20, promptBox.y + 110);
             } else {
-                snprintf(promptText, sizeof(promptText), "Enter filename:");
-            }
-            renderText(renderer, promptText, (SDL_Color){255, 255, 255, 255}, promptBox.x + 20, promptBox.y + 10);
-            renderText(renderer, inputFileNameBuffer, (SDL_Color){255, 255, 255, 255}, promptBox.x + 20, promptBox.y + 50);
-            renderText(renderer, "Press ENTER to confirm", (SDL_Color){150, 150, 150, 255}, promptBox.x + 20, promptBox.y + 90);
-            renderText(renderer, "Press ESC to cancel", (SDL_Color){150, 150, 150, 255}, promptBox.x + 20, promptBox.y + 110);
-        } else {
-            // Render the main game
-            // 1. Draw the board
-            drawBoard(renderer, squareSize, 0, color_light, color_dark, color_clicked, color_possible, color_risky, gameState.board);
-
-            // 2. Render first sidebar background
-            SDL_Rect sidebar1_background = {boardWidth, 0, sidebar1_width, screenHeight};
-            SDL_SetRenderDrawColor(renderer, 120, 120, 120, 255);
-            SDL_RenderFillRect(renderer, &sidebar1_background);
-
-            // 3. Render second sidebar background
-            SDL_Rect sidebar2_background = {boardWidth + sidebar1_width, 0, sidebar2_width, screenHeight};
-            SDL_SetRenderDrawColor(renderer, 100, 100, 100, 255); // Slightly different color for distinction
-            SDL_RenderFillRect(renderer, &sidebar2_background);
-
-            // Render elements within the first sidebar (timers, captured pieces, buttons)
-            // Format and render timers
-            renderText(renderer, "White:", (SDL_Color){255, 255, 255, 255}, boardWidth + 10, 10);
-            formatTime(whiteTimerStr, gameState.whiteTimeMs);
-            renderText(renderer, whiteTimerStr, (SDL_Color){255, 255, 255, 255}, boardWidth + 100, 10);
-
-            renderText(renderer, "Black:", (SDL_Color){255, 255, 255, 255}, boardWidth + 10, 40);
-            formatTime(blackTimerStr, gameState.blackTimeMs);
-            renderText(renderer, blackTimerStr, (SDL_Color){255, 255, 255, 255}, boardWidth + 100, 40);
-
-            // Labels for captured pieces in the first sidebar
-            renderText(renderer, "Captured by white:", (SDL_Color) {255, 255, 255, 255}, boardWidth + 10, timer_height + 10);
-            renderText(renderer, "Captured by black:", (SDL_Color) {255, 255, 255, 255}, boardWidth + 10, timer_height + captured_area_height + 10);
-
-            for (int row = 0; row < 8; row++) {
-                for (int col = 0; col < 8; col++) {
-                    renderPiece(pieceTextureCoordinates, 0, squareSize, row, col,
-                                getPieceTexture(pieceTextures, gameState.board[row][col]), &renderer);
+                // Timers
+                formatTime(whiteTimerStr, gameState.whiteTimeMs);
+                renderText(renderer, whiteTimerStr, (SDL_Color){255, 255, 255, 255}, boardWidth + 100, 10);
+                formatTime(blackTimerStr, gameState.blackTimeMs);
+                renderText(renderer, blackTimerStr, (SDL_Color){255, 255, 255, 255}, boardWidth + 100, 40);
+
+                // Draw game status (check, checkmate, stalemate) - This remains centrally at the top, overlaying the board area
+                drawGameStatus(renderer, &gameState.status, gameState.blackTurn);
+
+                // Draw evaluation bar if enabled
+                if (showEvaluationBar) {
+                    drawEvaluationBar(renderer, gameState.status.evaluation); // Now positioned within the second sidebar
                 }
-            }
-
-            renderCapturedPieces(renderer, pieceTextures, &gameState);
-
-            // Render buttons at the bottom of the first sidebar
-            SDL_Rect saveButton = {boardWidth + 10, screenHeight - 140, 140, 40};
-            SDL_Rect loadButton = {boardWidth + 160, screenHeight - 140, 140, 40};
-            SDL_Rect undoButton = {boardWidth + 10, screenHeight - 90, 140, 40}; // Example position
-            SDL_Rect redoButton = {boardWidth + 160, screenHeight - 90, 140, 40}; // Example position
-
-            SDL_SetRenderDrawColor(renderer, 0, 150, 0, 255); // Green for save
-            SDL_RenderFillRect(renderer, &saveButton);
-            renderText(renderer, "Save", (SDL_Color){255, 255, 255, 255}, saveButton.x + 10, saveButton.y + 5);
-
-            SDL_SetRenderDrawColor(renderer, 0, 0, 150, 255); // Blue for load
-            SDL_RenderFillRect(renderer, &loadButton);
-            renderText(renderer, "Load", (SDL_Color){255, 255, 255, 255}, loadButton.x + 10, loadButton.y + 5);
-
-            // --- RENDER UNDO/REDO BUTTONS ---
-            SDL_SetRenderDrawColor(renderer, 150, 50, 0, 255); // Orange for undo
-            SDL_RenderFillRect(renderer, &undoButton);
-            renderText(renderer, "Undo", (SDL_Color){255, 255, 255, 255}, undoButton.x + 40, undoButton.y + 5);
-
-            SDL_SetRenderDrawColor(renderer, 0, 150, 150, 255); // Cyan for redo
-            SDL_RenderFillRect(renderer, &redoButton);
-            renderText(renderer, "Redo", (SDL_Color){255, 255, 255, 255}, redoButton.x + 40, redoButton.y + 5);
-
-            // Render elements within the second sidebar (move history, evaluation bar, analysis)
-            renderText(renderer, "MOVE HISTORY:", (SDL_Color){255, 255, 255, 255}, boardWidth + sidebar1_width + 10, 10); // Placed at top of second sidebar
 
-            const int moveHeight = 25;
-            int visibleStart = moveHistoryScrollOffset / moveHeight;
-            // Adjust visibleEnd calculation to fit within the second sidebar's height (e.g., 800 - 10 - 40 - 20 = 730 / 25 = ~29 moves)
-            int visibleEnd = visibleStart + (screenHeight - 80) / moveHeight;
-
-            for (int i = visibleStart; i < visibleEnd && i < gameState.moveCount; ++i) {
-                char buffer[64];
-                // Display moves in a single column, numbered sequentially
-                sprintf(buffer, "%d. %s", (i + 1), gameState.moveHistory[i].notation); // Number all moves sequentially
-
-                int y = 40 + (i * moveHeight) - moveHistoryScrollOffset; // Adjusted Y to start closer to "MOVE HISTORY:" label
-
-                renderText(renderer, buffer, (SDL_Color){255, 255, 255, 255}, boardWidth + sidebar1_width + 15, y);
-            }
-
-            // Draw game status (check, checkmate, stalemate) - This remains centrally at the top, overlaying the board area
-            drawGameStatus(renderer, isInCheck, isGameOver, isStalemate, gameState.blackTurn);
-
-            // Draw evaluation bar if enabled
-            if (showEvaluationBar) {
-                int score = evaluatePosition(gameState.board, gameState.blackTurn ? 1 : 0);
-                drawEvaluationBar(renderer, score); // Now positioned within the second sidebar
-            }
-
-            // Show position analysis if enabled
-            if (showAnalysis) {
-                displayPositionAnalysis(gameState.board, gameState.blackTurn, &gameState.lastDoublePushPawn, gameState.kingsPositions);
+                // Show the live analysis if enabled
+                if (showAnalysis) {
+                    drawAnalysis(renderer, &analyzer, gameState.status.legalMoveCount == 0);
+                }
             }
         }
+        drawProfilerOverlay(renderer, 10, 10);
+        endProfilePhase(PHASE_RENDER);
 
         // Present the renderer
+        beginProfilePhase(PHASE_PRESENT);
         SDL_RenderPresent(renderer);
+        endProfilePhase(PHASE_PRESENT);
+        markScenePresented(&scene);
+        endProfileFrame(true);
+    }
+
+    if (getInputMode() == INPUT_REPLAYING) {
+        printf("Replayed %d ticks: game loop %.2f s, %.2f s of CPU time in all\n", getInputTick(),
+               millisecondsSince(replayStart) / 1000.0, (double)clock() / CLOCKS_PER_SEC);
+        printProfileSummary();
     }
 
-    // Cleanup
-    destroyFont();
+    // Cleanup; quitting during startup still has the loading threads to wait for
+    waitForResourceJobs();
+    SDL_FreeSurface(resources.pieceSheet);
+    destroyComputerPlayer(&computer);
+    destroyOpeningExplorer(&openingExplorer);
+    destroyPositionAnalyzer(&analyzer);
+    freeGameHistory(&gameHistory);
+    destroyScene(&scene);
+    destroyMoveHistoryView(&moveHistoryView);
+    destroyPieceAtlas(&pieceAtlas);
+    freeMoveLog(&gameState);
+    closeSounds();
+    closeFonts();
+    closeProfiler();
+    stopInput();
     cleanUp(window);
     printf("Program ended\n");
     return 0;
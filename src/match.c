@@ -0,0 +1,446 @@
+// src/match.c
+// Headless self-play match runner: plays two engine configurations against each other,
+// one game per core, writes PGN and reports Elo and an SPRT verdict.
+//
+// Usage: match <matchfile> [-games N] [-concurrency N] [-pgn out.pgn] [-hash MB]
+//              [-a params.h] [-b params.h] [-adepth N] [-bdepth N]
+//              [-sprt elo0 elo1] [-alpha A] [-beta B]
+//
+// The match file holds the time control and the opening positions:
+//   # comment
+//   tc 10+0.1          base seconds + increment seconds per move
+//   <FEN>              one opening per line, each played once with either color
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <SDL2/SDL.h>
+
+#include "engine.h"
+#include "Piece.h"
+#include "pgn.h"
+
+#define MAX_OPENINGS 4096
+#define MAX_GAME_PLIES 600
+#define MAX_THREADS 64
+
+// Adjudication thresholds
+#define RESIGN_SCORE 1000      // Centipawns both engines must agree on...
+#define RESIGN_MOVES 5         // ...for this many moves in a row
+#define MIN_THINK_TIME_MS 10
+
+typedef struct {
+    char name[64];
+    EvalParams params;
+    int maxDepth;              // 0 = limited by the clock only
+} EngineConfig;
+
+typedef enum {
+    RESULT_WHITE_WINS,
+    RESULT_BLACK_WINS,
+    RESULT_DRAW
+} GameResult;
+
+typedef struct {
+    char fen[FEN_LENGTH];
+    EngineMove moves[MAX_GAME_PLIES];
+    int plyCount;
+    GameResult result;
+    const char* termination;
+} GameRecord;
+
+// Everything shared between the worker threads
+typedef struct {
+    EngineConfig engines[2];
+    char openings[MAX_OPENINGS][FEN_LENGTH];
+    int openingCount;
+    int baseTimeMs;
+    int incrementMs;
+    int totalGames;
+    int hashSizeMB;            // Per engine, per worker
+    SDL_atomic_t nextGame;
+    SDL_atomic_t stop;
+
+    // Results, guarded by lock
+    SDL_mutex* lock;
+    int wins, draws, losses;   // From engine A's point of view
+    int gamesDone;
+    FILE* pgn;
+
+    // SPRT
+    bool sprtEnabled;
+    double elo0, elo1, alpha, beta;
+} Match;
+
+static const char* startPosition = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+
+static bool loadMatchFile(const char* path, Match* match) {
+    FILE* file = fopen(path, "r");
+    if (!file) {
+        fprintf(stderr, "Error: Could not open match file %s\n", path);
+        return false;
+    }
+
+    char line[256];
+    while (fgets(line, sizeof(line), file)) {
+        line[strcspn(line, "\r\n")] = '\0';
+        if (line[0] == '\0' || line[0] == '#') continue;
+
+        double base, increment = 0.0;
+        if (strncmp(line, "tc ", 3) == 0) {
+            if (sscanf(line + 3, "%lf+%lf", &base, &increment) >= 1) {
+                match->baseTimeMs = (int)(base * 1000.0);
+                match->incrementMs = (int)(increment * 1000.0);
+            }
+        } else if (strlen(line) >= FEN_LENGTH) {
+            fprintf(stderr, "Error: Opening longer than %d characters, skipped: %s\n", FEN_LENGTH - 1, line);
+        } else if (match->openingCount < MAX_OPENINGS) {
+            strcpy(match->openings[match->openingCount++], line);
+        }
+    }
+    fclose(file);
+
+    if (match->openingCount == 0) {
+        strcpy(match->openings[match->openingCount++], startPosition);
+    }
+    return true;
+}
+
+// tables[0] / tables[1] belong to white / black for this game
+static void playGame(Match* match, const char* fen, const EngineConfig* white, const EngineConfig* black, TranspositionTable tables[2], GameRecord* record) {
+    unsigned char board[8][8];
+    bool blackTurn;
+    Vector2f lastDoublePawn;
+    Vector2f kings[2];
+
+    strncpy(record->fen, fen, FEN_LENGTH - 1);
+    record->fen[FEN_LENGTH - 1] = '\0';
+    record->plyCount = 0;
+    record->result = RESULT_DRAW;
+    record->termination = "unterminated";
+
+    if (!loadFEN(fen, board, &blackTurn, &lastDoublePawn)) {
+        record->termination = "invalid opening";
+        return;
+    }
+    findKings(board, kings);
+
+    const EngineConfig* engines[2] = {white, black};
+    int clocks[2] = {match->baseTimeMs, match->baseTimeMs};
+    int winningStreak[2] = {0, 0}; // Consecutive moves each side was judged winning by both engines
+
+    PositionHistory* history = malloc(sizeof(PositionHistory));
+    resetPositionHistory(history, board, blackTurn ? 1 : 0, &lastDoublePawn, 0);
+
+    while (record->plyCount < MAX_GAME_PLIES) {
+        unsigned char color = blackTurn ? 1 : 0;
+
+        // Rules-based endings
+        MoveList legalMoves;
+        generateMoves(board, color, &legalMoves, &lastDoublePawn);
+        if (legalMoves.count == 0) {
+            if (isCheck(board, kings[color])) {
+                record->result = blackTurn ? RESULT_WHITE_WINS : RESULT_BLACK_WINS;
+                record->termination = "checkmate";
+            } else {
+                record->result = RESULT_DRAW;
+                record->termination = "stalemate";
+            }
+            break;
+        }
+        DrawReason drawReason = getDrawReason(board, history);
+        if (drawReason != DRAW_NONE) {
+            record->termination = drawReason == DRAW_REPETITION ? "threefold repetition" :
+                                  drawReason == DRAW_FIFTY_MOVES ? "fifty-move rule" : "insufficient material";
+            break;
+        }
+
+        // Budget: a slice of the remaining clock plus most of the increment
+        int budget = clocks[color] / 30 + match->incrementMs * 3 / 4;
+        if (budget > clocks[color] / 2) budget = clocks[color] / 2;
+        if (budget < MIN_THINK_TIME_MS) budget = MIN_THINK_TIME_MS;
+
+        SearchLimits limits = {engines[color]->maxDepth, match->baseTimeMs > 0 ? budget : 0, &engines[color]->params, &tables[color], NULL};
+        SearchResult search = searchPosition(board, color, &lastDoublePawn, kings, history, &limits);
+
+        if (match->baseTimeMs > 0) {
+            clocks[color] -= search.timeMs;
+            if (clocks[color] < 0) {
+                record->result = blackTurn ? RESULT_WHITE_WINS : RESULT_BLACK_WINS;
+                record->termination = "time forfeit";
+                break;
+            }
+            clocks[color] += match->incrementMs;
+        }
+
+        // Win adjudication once both engines agree the game is decided
+        int whiteScore = blackTurn ? -search.score : search.score;
+        if (whiteScore >= RESIGN_SCORE) {
+            winningStreak[0]++;
+            winningStreak[1] = 0;
+        } else if (whiteScore <= -RESIGN_SCORE) {
+            winningStreak[1]++;
+            winningStreak[0] = 0;
+        } else {
+            winningStreak[0] = winningStreak[1] = 0;
+        }
+
+        EngineMove move = search.bestMove;
+        record->moves[record->plyCount++] = move;
+
+        bool irreversible = move.capturedPiece != NONE || (board[move.from.x][move.from.y] & TYPE_MASK) == PAWN;
+        engineMakeMove(board, move, &lastDoublePawn, kings, 0);
+        blackTurn = !blackTurn;
+        recordPosition(history, board, blackTurn ? 1 : 0, &lastDoublePawn, irreversible);
+
+        if (winningStreak[0] >= 2 * RESIGN_MOVES || winningStreak[1] >= 2 * RESIGN_MOVES) {
+            record->result = winningStreak[0] > 0 ? RESULT_WHITE_WINS : RESULT_BLACK_WINS;
+            record->termination = "adjudication";
+            break;
+        }
+    }
+
+    if (record->plyCount >= MAX_GAME_PLIES) {
+        record->result = RESULT_DRAW;
+        record->termination = "move limit";
+    }
+    free(history);
+}
+
+static const char* resultString(GameResult result) {
+    switch (result) {
+        case RESULT_WHITE_WINS: return "1-0";
+        case RESULT_BLACK_WINS: return "0-1";
+        default: return "1/2-1/2";
+    }
+}
+
+// game is scratch space for the PGN writer
+static void writePGN(FILE* file, const GameRecord* record, int round, const char* white, const char* black, const Match* match, PgnGame* game) {
+    PgnTags* tags = &game->tags;
+    initPgnTags(tags);
+    strcpy(tags->event, "Engine match");
+    time_t now = time(NULL);
+    strftime(tags->date, sizeof(tags->date), "%Y.%m.%d", localtime(&now));
+    snprintf(tags->round, sizeof(tags->round), "%d", round);
+    snprintf(tags->white, sizeof(tags->white), "%s", white);
+    snprintf(tags->black, sizeof(tags->black), "%s", black);
+    strcpy(tags->result, resultString(record->result));
+    if (strcmp(record->fen, startPosition) != 0) {
+        snprintf(tags->fen, sizeof(tags->fen), "%s", record->fen);
+    }
+    if (match->baseTimeMs > 0) {
+        snprintf(tags->timeControl, sizeof(tags->timeControl), "%g+%g", match->baseTimeMs / 1000.0, match->incrementMs / 1000.0);
+    }
+    snprintf(tags->termination, sizeof(tags->termination), "%s", record->termination);
+
+    memcpy(game->moves, record->moves, record->plyCount * sizeof(EngineMove));
+    game->plyCount = record->plyCount;
+    writePgnGame(file, game);
+}
+
+// Expected score for an Elo difference
+static double eloToScore(double elo) {
+    return 1.0 / (1.0 + pow(10.0, -elo / 400.0));
+}
+
+static double scoreToElo(double score) {
+    if (score <= 0.0) return -INFINITY;
+    if (score >= 1.0) return INFINITY;
+    return -400.0 * log10(1.0 / score - 1.0);
+}
+
+// Generalized SPRT log-likelihood ratio from the trinomial results (normal approximation)
+static double sprtLLR(int wins, int draws, int losses, double elo0, double elo1) {
+    int n = wins + draws + losses;
+    if (wins == 0 || losses == 0 || n == 0) return 0.0;
+
+    double mean = (wins + 0.5 * draws) / n;
+    double variance = (wins * pow(1.0 - mean, 2) + draws * pow(0.5 - mean, 2) + losses * pow(mean, 2)) / n;
+    if (variance <= 0.0) return 0.0;
+
+    double s0 = eloToScore(elo0);
+    double s1 = eloToScore(elo1);
+    return (s1 - s0) * (2.0 * mean - s0 - s1) / (2.0 * variance / n);
+}
+
+static void printStandings(const Match* match) {
+    int n = match->wins + match->draws + match->losses;
+    if (n == 0) return;
+
+    double mean = (match->wins + 0.5 * match->draws) / n;
+    double variance = (match->wins * pow(1.0 - mean, 2) + match->draws * pow(0.5 - mean, 2) +
+                       match->losses * pow(mean, 2)) / n;
+    double margin = 1.96 * sqrt(variance / n);
+    double elo = scoreToElo(mean);
+    double eloLow = scoreToElo(mean - margin);
+    double eloHigh = scoreToElo(mean + margin);
+
+    printf("Score of %s vs %s: %d - %d - %d [%.3f] %d\n",
+           match->engines[0].name, match->engines[1].name, match->wins, match->losses, match->draws, mean, n);
+    double eloMargin = (eloHigh - eloLow) / 2.0;
+    if (isnan(eloMargin)) eloMargin = INFINITY; // Only wins or only losses so far
+    printf("Elo difference: %.1f +/- %.1f\n", elo, eloMargin);
+
+    if (match->sprtEnabled) {
+        double llr = sprtLLR(match->wins, match->draws, match->losses, match->elo0, match->elo1);
+        double lower = log(match->beta / (1.0 - match->alpha));
+        double upper = log((1.0 - match->beta) / match->alpha);
+        printf("SPRT: elo0=%.1f elo1=%.1f LLR %.2f (%.2f, %.2f)%s\n", match->elo0, match->elo1, llr, lower, upper,
+               llr >= upper ? " - H1 accepted (PASS)" : llr <= lower ? " - H0 accepted (FAIL)" : "");
+    }
+}
+
+static int matchWorker(void* data) {
+    Match* match = data;
+    GameRecord* record = malloc(sizeof(GameRecord));
+    PgnGame* pgnGame = malloc(sizeof(PgnGame));
+
+    // Each engine keeps its own table, cleared between games
+    TranspositionTable tables[2];
+    initTranspositionTable(&tables[0], match->hashSizeMB);
+    initTranspositionTable(&tables[1], match->hashSizeMB);
+
+    while (!SDL_AtomicGet(&match->stop)) {
+        int game = SDL_AtomicAdd(&match->nextGame, 1);
+        if (game >= match->totalGames) break;
+
+        // Each opening is played twice with colors reversed
+        const char* fen = match->openings[(game / 2) % match->openingCount];
+        int whiteIndex = game % 2;
+        const EngineConfig* white = &match->engines[whiteIndex];
+        const EngineConfig* black = &match->engines[1 - whiteIndex];
+
+        clearTranspositionTable(&tables[0]);
+        clearTranspositionTable(&tables[1]);
+        playGame(match, fen, white, black, tables, record);
+
+        SDL_LockMutex(match->lock);
+        if (record->result == RESULT_DRAW) {
+            match->draws++;
+        } else if ((record->result == RESULT_WHITE_WINS) == (whiteIndex == 0)) {
+            match->wins++;
+        } else {
+            match->losses++;
+        }
+        match->gamesDone++;
+
+        if (match->pgn) {
+            writePGN(match->pgn, record, game + 1, white->name, black->name, match, pgnGame);
+            fflush(match->pgn);
+        }
+
+        printf("Game %d/%d: %s vs %s %s (%s, %d plies)\n", match->gamesDone, match->totalGames,
+               white->name, black->name, resultString(record->result), record->termination, record->plyCount);
+        printStandings(match);
+
+        if (match->sprtEnabled) {
+            double llr = sprtLLR(match->wins, match->draws, match->losses, match->elo0, match->elo1);
+            if (llr >= log((1.0 - match->beta) / match->alpha) || llr <= log(match->beta / (1.0 - match->alpha))) {
+                SDL_AtomicSet(&match->stop, 1);
+            }
+        }
+        SDL_UnlockMutex(match->lock);
+    }
+
+    freeTranspositionTable(&tables[0]);
+    freeTranspositionTable(&tables[1]);
+    free(record);
+    free(pgnGame);
+    return 0;
+}
+
+static void initEngineConfig(EngineConfig* engine, const char* name) {
+    strncpy(engine->name, name, sizeof(engine->name) - 1);
+    engine->name[sizeof(engine->name) - 1] = '\0';
+    engine->params = evalParams;
+    engine->maxDepth = 0;
+}
+
+int main(int argc, char* argv[]) {
+    static Match match;
+    const char* matchPath = NULL;
+    const char* pgnPath = "match.pgn";
+    int concurrency = SDL_GetCPUCount();
+
+    match.totalGames = 100;
+    match.hashSizeMB = DEFAULT_TT_SIZE_MB;
+    match.baseTimeMs = 10000;
+    match.incrementMs = 100;
+    match.alpha = 0.05;
+    match.beta = 0.05;
+    initEngineConfig(&match.engines[0], "A");
+    initEngineConfig(&match.engines[1], "B");
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-games") == 0 && i + 1 < argc) {
+            match.totalGames = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-hash") == 0 && i + 1 < argc) {
+            match.hashSizeMB = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-concurrency") == 0 && i + 1 < argc) {
+            concurrency = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-pgn") == 0 && i + 1 < argc) {
+            pgnPath = argv[++i];
+        } else if ((strcmp(argv[i], "-a") == 0 || strcmp(argv[i], "-b") == 0) && i + 1 < argc) {
+            EngineConfig* engine = &match.engines[argv[i][1] == 'a' ? 0 : 1];
+            const char* path = argv[++i];
+            initEngineConfig(engine, path);
+            if (!loadEvalParams(path, &engine->params)) return 1;
+        } else if ((strcmp(argv[i], "-adepth") == 0 || strcmp(argv[i], "-bdepth") == 0) && i + 1 < argc) {
+            int engine = argv[i][1] == 'a' ? 0 : 1;
+            match.engines[engine].maxDepth = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-sprt") == 0 && i + 2 < argc) {
+            match.sprtEnabled = true;
+            match.elo0 = atof(argv[++i]);
+            match.elo1 = atof(argv[++i]);
+        } else if (strcmp(argv[i], "-alpha") == 0 && i + 1 < argc) {
+            match.alpha = atof(argv[++i]);
+        } else if (strcmp(argv[i], "-beta") == 0 && i + 1 < argc) {
+            match.beta = atof(argv[++i]);
+        } else {
+            matchPath = argv[i];
+        }
+    }
+
+    initializeEngine();
+
+    if (!matchPath) {
+        printf("Usage: %s <matchfile> [-games N] [-concurrency N] [-pgn out.pgn] [-hash MB]\n"
+               "       [-a params.h] [-b params.h] [-adepth N] [-bdepth N] [-sprt elo0 elo1] [-alpha A] [-beta B]\n", argv[0]);
+        return 1;
+    }
+    if (!loadMatchFile(matchPath, &match)) {
+        return 1;
+    }
+    if (concurrency < 1) concurrency = 1;
+    if (concurrency > MAX_THREADS) concurrency = MAX_THREADS;
+
+    match.pgn = fopen(pgnPath, "w");
+    if (!match.pgn) {
+        fprintf(stderr, "Error: Could not open file %s for writing\n", pgnPath);
+    }
+    match.lock = SDL_CreateMutex();
+
+    printf("%s vs %s: %d games, %d openings, tc %g+%g, %d threads\n",
+           match.engines[0].name, match.engines[1].name, match.totalGames, match.openingCount,
+           match.baseTimeMs / 1000.0, match.incrementMs / 1000.0, concurrency);
+
+    SDL_Thread* threads[MAX_THREADS];
+    for (int t = 0; t < concurrency; t++) {
+        threads[t] = SDL_CreateThreadWithStackSize(matchWorker, "match-worker", SEARCH_STACK_SIZE, &match);
+    }
+    for (int t = 0; t < concurrency; t++) {
+        SDL_WaitThread(threads[t], NULL);
+    }
+
+    printf("\nFinished %d games\n", match.gamesDone);
+    printStandings(&match);
+
+    SDL_DestroyMutex(match.lock);
+    if (match.pgn) {
+        fclose(match.pgn);
+    }
+    return 0;
+}
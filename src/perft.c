@@ -0,0 +1,128 @@
+// src/perft.c
+// Move generator regression check: counts the leaf nodes of the full legal move tree of
+// well-known positions and compares them with the published numbers. Any change to
+// bitboard.c or to move generation and making in engine.c should leave them all matching.
+//
+// Usage: perft [-d depth]        depth 1 to 4, 4 by default
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <SDL2/SDL.h>
+
+#include "engine.h"
+#include "Piece.h"
+
+#define PERFT_MAX_DEPTH 4
+
+typedef struct {
+    const char* name;
+    const char* fen;
+    long long nodes[PERFT_MAX_DEPTH]; // Depth 1 to PERFT_MAX_DEPTH
+} PerftPosition;
+
+// From the Chess Programming Wiki's perft results page
+static const PerftPosition positions[] = {
+    {"startpos", "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+     {20, 400, 8902, 197281}},
+    {"kiwipete", "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+     {48, 2039, 97862, 4085603}},
+    {"position 3", "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+     {14, 191, 2812, 43238}},
+    {"position 4", "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+     {6, 264, 9467, 422333}},
+    {"position 5", "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+     {44, 1486, 62379, 2103487}},
+    {"position 6", "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+     {46, 2079, 89890, 3894594}},
+};
+#define POSITION_COUNT (int)(sizeof(positions) / sizeof(positions[0]))
+
+static int stageMismatches = 0;
+
+// Leaf nodes 'depth' plies below the position. At the last ply the moves are only counted,
+// and countLegalMoves and the capture and quiet stages must agree with the full list.
+static long long perft(unsigned char board[8][8], unsigned char color, Vector2f lastDoublePawn, Vector2f kings[], int depth) {
+    MoveGenContext gen;
+    MoveList list;
+    initMoveGen(&gen, board, color, &lastDoublePawn);
+    generateStagedMoves(&gen, board, GEN_ALL, &list);
+
+    if (depth == 1) {
+        MoveList captures, quiets;
+        generateStagedMoves(&gen, board, GEN_CAPTURES, &captures);
+        generateStagedMoves(&gen, board, GEN_QUIETS, &quiets);
+        if (countLegalMoves(&gen, board) != list.count || captures.count + quiets.count != list.count) {
+            stageMismatches++;
+        }
+        return list.count;
+    }
+
+    long long nodes = 0;
+    for (int i = 0; i < list.count; i++) {
+        // engineMakeMove has no undo; every move is made on a copy
+        unsigned char child[8][8];
+        Vector2f childKings[2] = {kings[0], kings[1]};
+        Vector2f childDoublePawn = lastDoublePawn;
+        memcpy(child, board, sizeof(child));
+        engineMakeMove(child, list.moves[i], &childDoublePawn, childKings, 0);
+        nodes += perft(child, color ^ 1, childDoublePawn, childKings, depth - 1);
+    }
+    return nodes;
+}
+
+int main(int argc, char* argv[]) {
+    int maxDepth = PERFT_MAX_DEPTH;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-d") == 0 && i + 1 < argc) {
+            maxDepth = atoi(argv[++i]);
+        } else {
+            maxDepth = 0;
+        }
+        if (maxDepth < 1 || maxDepth > PERFT_MAX_DEPTH) {
+            printf("Usage: %s [-d depth]  (1 to %d)\n", argv[0], PERFT_MAX_DEPTH);
+            return 1;
+        }
+    }
+
+    initializeEngine();
+
+    int failures = 0;
+    long long totalNodes = 0;
+    Uint64 start = SDL_GetPerformanceCounter();
+    for (int p = 0; p < POSITION_COUNT; p++) {
+        unsigned char board[8][8];
+        bool blackTurn;
+        Vector2f lastDoublePawn, kings[2];
+        if (!loadFEN(positions[p].fen, board, &blackTurn, &lastDoublePawn)) {
+            fprintf(stderr, "Error: Invalid FEN \"%s\"\n", positions[p].fen);
+            return 1;
+        }
+        findKings(board, kings);
+
+        for (int depth = 1; depth <= maxDepth; depth++) {
+            long long expected = positions[p].nodes[depth - 1];
+            long long nodes = perft(board, blackTurn, lastDoublePawn, kings, depth);
+            totalNodes += nodes;
+            printf("%-10s depth %d %10lld", positions[p].name, depth, nodes);
+            if (nodes == expected) {
+                printf("  ok\n");
+            } else {
+                printf("  expected %lld\n", expected);
+                failures++;
+            }
+        }
+    }
+    double seconds = (double)(SDL_GetPerformanceCounter() - start) / SDL_GetPerformanceFrequency();
+
+    if (stageMismatches > 0) {
+        printf("%d positions where the staged or counted moves differ from the full list\n", stageMismatches);
+        failures++;
+    }
+    printf("%lld nodes in %.2f s (%.1f M nodes/s)\n", totalNodes, seconds, seconds > 0 ? totalNodes / seconds / 1e6 : 0.0);
+    if (failures > 0) {
+        printf("FAILED: %d mismatches\n", failures);
+        return 1;
+    }
+    printf("All node counts match\n");
+    return 0;
+}
@@ -0,0 +1,355 @@
+// src/pgn.c
+#include "pgn.h"
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const char* resultTokens[] = {"1-0", "0-1", "1/2-1/2", "*"};
+
+// The position a game is played from
+typedef struct {
+    unsigned char board[8][8];
+    Vector2f kings[2];
+    Vector2f lastDoublePawn;
+    unsigned char color;
+    int fullmoveNumber;
+} PgnPosition;
+
+void initPgnTags(PgnTags* tags) {
+    memset(tags, 0, sizeof(*tags));
+    strcpy(tags->event, "?");
+    strcpy(tags->site, "?");
+    strcpy(tags->date, "????.??.??");
+    strcpy(tags->round, "?");
+    strcpy(tags->white, "?");
+    strcpy(tags->black, "?");
+    strcpy(tags->result, "*");
+}
+
+static bool setupPosition(PgnPosition* position, const PgnTags* tags) {
+    bool blackTurn;
+    const char* fen = tags->fen[0] ? tags->fen : START_FEN;
+    if (!loadFEN(fen, position->board, &blackTurn, &position->lastDoublePawn)) {
+        return false;
+    }
+    findKings(position->board, position->kings);
+    position->color = blackTurn ? 1 : 0;
+
+    // The fullmove number is the last field
+    const char* lastSpace = strrchr(fen, ' ');
+    position->fullmoveNumber = lastSpace ? atoi(lastSpace + 1) : 1;
+    if (position->fullmoveNumber < 1) position->fullmoveNumber = 1;
+    return true;
+}
+
+/*==========
+Reading
+==========*/
+bool openPgnReader(PgnReader* reader, const char* path) {
+    reader->file = fopen(path, "rb");
+    reader->length = 0;
+    reader->position = 0;
+    reader->line = 1;
+    reader->bytesRead = 0;
+    if (!reader->file) {
+        fprintf(stderr, "Error: Cannot open %s\n", path);
+        return false;
+    }
+    return true;
+}
+
+void closePgnReader(PgnReader* reader) {
+    if (reader->file) {
+        fclose(reader->file);
+        reader->file = NULL;
+    }
+}
+
+static int peekChar(PgnReader* reader) {
+    if (reader->position == reader->length) {
+        reader->length = fread(reader->buffer, 1, sizeof(reader->buffer), reader->file);
+        reader->position = 0;
+        if (reader->length == 0) return EOF;
+    }
+    return (unsigned char)reader->buffer[reader->position];
+}
+
+static int nextChar(PgnReader* reader) {
+    int c = peekChar(reader);
+    if (c != EOF) {
+        reader->position++;
+        reader->bytesRead++;
+        if (c == '\n') reader->line++;
+    }
+    return c;
+}
+
+static void skipPast(PgnReader* reader, char end) {
+    int c;
+    do {
+        c = nextChar(reader);
+    } while (c != EOF && c != end);
+}
+
+// Skip a variation, with any nested variations and comments in it
+static void skipVariation(PgnReader* reader) {
+    int depth = 0;
+    int c;
+    while ((c = nextChar(reader)) != EOF) {
+        if (c == '(') {
+            depth++;
+        } else if (c == ')') {
+            if (--depth == 0) return;
+        } else if (c == '{') {
+            skipPast(reader, '}');
+        } else if (c == ';') {
+            skipPast(reader, '\n');
+        }
+    }
+}
+
+static void storeTag(PgnTags* tags, const char* name, const char* value) {
+    struct {
+        const char* name;
+        char* field;
+        size_t size;
+    } fields[] = {
+        {"Event", tags->event, sizeof(tags->event)},
+        {"Site", tags->site, sizeof(tags->site)},
+        {"Date", tags->date, sizeof(tags->date)},
+        {"Round", tags->round, sizeof(tags->round)},
+        {"White", tags->white, sizeof(tags->white)},
+        {"Black", tags->black, sizeof(tags->black)},
+        {"Result", tags->result, sizeof(tags->result)},
+        {"FEN", tags->fen, sizeof(tags->fen)},
+        {"TimeControl", tags->timeControl, sizeof(tags->timeControl)},
+        {"Termination", tags->termination, sizeof(tags->termination)},
+    };
+    for (size_t i = 0; i < sizeof(fields) / sizeof(fields[0]); i++) {
+        if (strcmp(name, fields[i].name) == 0) {
+            snprintf(fields[i].field, fields[i].size, "%s", value);
+            return;
+        }
+    }
+}
+
+// [Name "value"], with \" and \\ escapes in the value; a tag never spans lines
+static void readTag(PgnReader* reader, PgnTags* tags) {
+    char name[PGN_MAX_TOKEN];
+    char value[PGN_TAG_LENGTH];
+    size_t nameLength = 0, valueLength = 0;
+    int c;
+
+    nextChar(reader); // '['
+    while ((c = peekChar(reader)) != EOF && isspace(c) && c != '\n') nextChar(reader);
+    while ((c = peekChar(reader)) != EOF && !isspace(c) && c != '"' && c != ']') {
+        if (nameLength < sizeof(name) - 1) name[nameLength++] = (char)c;
+        nextChar(reader);
+    }
+    name[nameLength] = '\0';
+
+    while ((c = peekChar(reader)) != EOF && c != '"' && c != ']' && c != '\n') nextChar(reader);
+    if (c == '"') {
+        nextChar(reader);
+        while ((c = nextChar(reader)) != EOF && c != '"' && c != '\n') {
+            if (c == '\\' && (peekChar(reader) == '"' || peekChar(reader) == '\\')) {
+                c = nextChar(reader);
+            }
+            if (valueLength < sizeof(value) - 1) value[valueLength++] = (char)c;
+        }
+    }
+    value[valueLength] = '\0';
+    while ((c = peekChar(reader)) != EOF && c != ']' && c != '\n') nextChar(reader);
+    if (c == ']') nextChar(reader);
+
+    storeTag(tags, name, value);
+}
+
+// A symbol: a move, move number, NAG or result
+static void readToken(PgnReader* reader, char* token) {
+    size_t length = 0;
+    int c;
+    while ((c = peekChar(reader)) != EOF && !isspace(c) && !strchr("[]{}();", c)) {
+        if (length < PGN_MAX_TOKEN - 1) token[length++] = (char)c;
+        nextChar(reader);
+    }
+    token[length] = '\0';
+}
+
+static const char* resultToken(const char* token) {
+    for (int i = 0; i < 4; i++) {
+        if (strcmp(token, resultTokens[i]) == 0) return resultTokens[i];
+    }
+    return NULL;
+}
+
+PgnStatus readPgnGame(PgnReader* reader, PgnGame* game) {
+    initPgnTags(&game->tags);
+    game->plyCount = 0;
+
+    PgnPosition position;
+    bool started = false;        // Anything of this game has been read
+    bool inMovetext = false;
+    bool positionReady = false;
+    bool skipping = false;       // Illegal game: read on to its end
+    char token[PGN_MAX_TOKEN];
+
+    int c;
+    while ((c = peekChar(reader)) != EOF) {
+        if (isspace(c)) {
+            nextChar(reader);
+        } else if (c == '[') {
+            // Tags after movetext belong to the next game; this one had no termination marker
+            if (inMovetext) break;
+            readTag(reader, &game->tags);
+            started = true;
+        } else if (c == '{') {
+            skipPast(reader, '}');
+        } else if (c == ';' || c == '%') {
+            skipPast(reader, '\n');
+        } else if (c == '(') {
+            skipVariation(reader);
+        } else if (c == ')' || c == ']' || c == '}') {
+            nextChar(reader);
+        } else {
+            readToken(reader, token);
+            started = true;
+            inMovetext = true;
+
+            const char* result = resultToken(token);
+            if (result) {
+                strcpy(game->tags.result, result);
+                break;
+            }
+            if (skipping || token[0] == '$') continue; // NAG
+
+            // Move numbers: "12." "12..." and "12.e4"
+            const char* move = token;
+            while (isdigit((unsigned char)*move)) move++;
+            if (*move == '.' || *move == '\0') {
+                while (*move == '.') move++;
+                if (*move == '\0') continue;
+            } else {
+                move = token;
+            }
+
+            long long line = reader->line;
+            if (!positionReady) {
+                if (!setupPosition(&position, &game->tags)) {
+                    fprintf(stderr, "Error: Line %lld: Invalid FEN \"%s\", game skipped\n", line, game->tags.fen);
+                    skipping = true;
+                    continue;
+                }
+                positionReady = true;
+            }
+            EngineMove parsed;
+            if (game->plyCount == PGN_MAX_PLIES) {
+                fprintf(stderr, "Error: Line %lld: Game longer than %d plies, skipped\n", line, PGN_MAX_PLIES);
+                skipping = true;
+            } else if (!parseSAN(position.board, position.color, &position.lastDoublePawn, move, &parsed)) {
+                fprintf(stderr, "Error: Line %lld: Illegal move \"%s\", game skipped\n", line, move);
+                skipping = true;
+            } else {
+                game->moves[game->plyCount++] = parsed;
+                engineMakeMove(position.board, parsed, &position.lastDoublePawn, position.kings, 0);
+                position.color ^= 1;
+            }
+        }
+    }
+
+    if (!started) return PGN_END;
+    return skipping ? PGN_GAME_SKIPPED : PGN_GAME_READ;
+}
+
+/*==========
+Writing
+==========*/
+static bool writeTag(FILE* file, const char* name, const char* value) {
+    fprintf(file, "[%s \"", name);
+    for (const char* c = value; *c; c++) {
+        if (*c == '"' || *c == '\\') fputc('\\', file);
+        fputc(*c, file);
+    }
+    return fprintf(file, "\"]\n") > 0;
+}
+
+// Append a movetext token, wrapping the line when it would get too long
+static void writeToken(FILE* file, const char* token, int* column) {
+    int length = (int)strlen(token);
+    if (*column > 0 && *column + 1 + length > PGN_LINE_WIDTH) {
+        fputc('\n', file);
+        *column = 0;
+    } else if (*column > 0) {
+        fputc(' ', file);
+        (*column)++;
+    }
+    fputs(token, file);
+    *column += length;
+}
+
+// Play the moves through on a copy of the position; false at the first illegal one
+static bool checkPgnMoves(const PgnGame* game, PgnPosition position) {
+    for (int ply = 0; ply < game->plyCount; ply++) {
+        EngineMove move = game->moves[ply];
+        MoveGenContext gen;
+        initMoveGen(&gen, position.board, position.color, &position.lastDoublePawn);
+        if (move.from.x < 0 || move.from.x > 7 || move.from.y < 0 || move.from.y > 7 ||
+            !(legalDestinations(&gen, position.board, SQUARE(move.from.x, move.from.y)) &
+              SQUARE_BIT(SQUARE(move.to.x, move.to.y)))) {
+            fprintf(stderr, "Error: Illegal move at ply %d, game not written\n", ply + 1);
+            return false;
+        }
+        engineMakeMove(position.board, move, &position.lastDoublePawn, position.kings, 0);
+        position.color ^= 1;
+    }
+    return true;
+}
+
+bool writePgnGame(FILE* file, const PgnGame* game) {
+    const PgnTags* tags = &game->tags;
+    PgnPosition position;
+    if (!setupPosition(&position, tags)) {
+        fprintf(stderr, "Error: Invalid FEN \"%s\"\n", tags->fen);
+        return false;
+    }
+    // Nothing is written for a game with an illegal move, so no half game ends up in the file
+    if (!checkPgnMoves(game, position)) {
+        return false;
+    }
+
+    writeTag(file, "Event", tags->event);
+    writeTag(file, "Site", tags->site);
+    writeTag(file, "Date", tags->date);
+    writeTag(file, "Round", tags->round);
+    writeTag(file, "White", tags->white);
+    writeTag(file, "Black", tags->black);
+    writeTag(file, "Result", tags->result);
+    if (tags->fen[0]) {
+        writeTag(file, "SetUp", "1");
+        writeTag(file, "FEN", tags->fen);
+    }
+    if (tags->timeControl[0]) writeTag(file, "TimeControl", tags->timeControl);
+    if (tags->termination[0]) writeTag(file, "Termination", tags->termination);
+    fputc('\n', file);
+
+    int column = 0;
+    char token[PGN_MAX_TOKEN];
+    for (int ply = 0; ply < game->plyCount; ply++) {
+        EngineMove move = game->moves[ply];
+        if (position.color == 0) {
+            snprintf(token, sizeof(token), "%d.", position.fullmoveNumber);
+            writeToken(file, token, &column);
+        } else if (ply == 0) {
+            snprintf(token, sizeof(token), "%d...", position.fullmoveNumber);
+            writeToken(file, token, &column);
+        }
+        moveToSAN(position.board, move, position.color, &position.lastDoublePawn, position.kings, token);
+        writeToken(file, token, &column);
+
+        engineMakeMove(position.board, move, &position.lastDoublePawn, position.kings, 0);
+        if (position.color == 1) position.fullmoveNumber++;
+        position.color ^= 1;
+    }
+    writeToken(file, tags->result, &column);
+    return fprintf(file, "\n\n") > 0 && !ferror(file);
+}
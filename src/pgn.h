@@ -0,0 +1,64 @@
+// src/pgn.h
+#ifndef PGN_H
+#define PGN_H
+
+#include <stdbool.h>
+#include <stdio.h>
+#include "engine.h"
+#include "Piece.h"
+
+#define PGN_MAX_PLIES 4096       // Longer games are skipped
+#define PGN_TAG_LENGTH 128       // Longer tag values are cut
+#define PGN_MAX_TOKEN 64
+#define PGN_BUFFER_SIZE 65536
+#define PGN_LINE_WIDTH 79        // Movetext is wrapped before this column
+
+// The Seven Tag Roster, plus the starting position and two optional tags; other tags are dropped
+typedef struct {
+    char event[PGN_TAG_LENGTH];
+    char site[PGN_TAG_LENGTH];
+    char date[PGN_TAG_LENGTH];
+    char round[PGN_TAG_LENGTH];
+    char white[PGN_TAG_LENGTH];
+    char black[PGN_TAG_LENGTH];
+    char result[8];              // "1-0", "0-1", "1/2-1/2" or "*"
+    char fen[FEN_LENGTH];        // Empty for the standard starting position
+    char timeControl[PGN_TAG_LENGTH]; // Optional, written only when not empty, e.g. "10+0.1"
+    char termination[PGN_TAG_LENGTH]; // Optional, written only when not empty, e.g. "checkmate"
+} PgnTags;
+
+typedef struct {
+    PgnTags tags;
+    EngineMove moves[PGN_MAX_PLIES];
+    int plyCount;
+} PgnGame;
+
+// Reads one game at a time through a fixed buffer, so files of any size take the same memory
+typedef struct {
+    FILE* file;
+    char buffer[PGN_BUFFER_SIZE];
+    size_t length;
+    size_t position;
+    long long line;              // Current line, for error messages
+    long long bytesRead;
+} PgnReader;
+
+typedef enum {
+    PGN_GAME_READ,
+    PGN_GAME_SKIPPED,            // Not a legal game; the reason went to stderr
+    PGN_END
+} PgnStatus;
+
+// "?" for every roster tag, result "*", standard starting position, no optional tags
+void initPgnTags(PgnTags* tags);
+
+bool openPgnReader(PgnReader* reader, const char* path);
+void closePgnReader(PgnReader* reader);
+
+// Read the next game; moves are checked against the legal moves as they are read
+PgnStatus readPgnGame(PgnReader* reader, PgnGame* game);
+
+// Write the game with SAN moves; false on a write error or an illegal move
+bool writePgnGame(FILE* file, const PgnGame* game);
+
+#endif // PGN_H
@@ -0,0 +1,433 @@
+// src/tuner.c
+// Headless Texel tuner for the evaluation weights in eval_params.h.
+//
+// Usage: tuner <dataset> [-t threads] [-e epochs] [-r learningRate] [-k K] [-o eval_params.h]
+//
+// Each dataset line holds a FEN followed by the game result from white's point of view,
+// either as "[1.0]" / "[0.5]" / "[0.0]" or as a quoted "1-0" / "1/2-1/2" / "0-1".
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <math.h>
+#include <SDL2/SDL.h>
+
+#include "engine.h"
+#include "Piece.h"
+
+#define MAX_LINE_LENGTH 512
+#define MAX_THREADS 64
+
+// Non-zero evaluation coefficients of one position
+typedef struct {
+    unsigned short index;
+    float coef;
+} TraceEntry;
+
+typedef struct {
+    int firstEntry;
+    int entryCount;
+    float result; // 1.0 white win, 0.5 draw, 0.0 black win
+} TunerPosition;
+
+typedef struct {
+    TunerPosition* positions;
+    int count;
+    TraceEntry* entries;
+    int entryCount;
+} Dataset;
+
+// Work assigned to one thread
+typedef struct {
+    const Dataset* data;
+    char** lines;          // Only used while loading
+    TunerPosition* loaded; // Only used while loading
+    TraceEntry** loadedEntries;
+    int* loadedEntryCounts;
+    int start, end;
+    const double* params;
+    double k;
+    double error;
+    double gradient[EVAL_PARAM_COUNT];
+} TunerJob;
+
+static int threadCount = 1;
+
+// Parse "<fen> <result>" into a board and a white-relative result
+static bool parseDatasetLine(char* line, unsigned char board[8][8], float* result) {
+    char* marker = strchr(line, '[');
+    if (!marker) {
+        marker = strchr(line, '"');
+    }
+    if (!marker) {
+        return false;
+    }
+
+    if (strncmp(marker, "[1.0]", 5) == 0 || strncmp(marker, "\"1-0\"", 5) == 0) {
+        *result = 1.0f;
+    } else if (strncmp(marker, "[0.0]", 5) == 0 || strncmp(marker, "\"0-1\"", 5) == 0) {
+        *result = 0.0f;
+    } else if (strncmp(marker, "[0.5]", 5) == 0 || strncmp(marker, "\"1/2-1/2\"", 9) == 0) {
+        *result = 0.5f;
+    } else {
+        return false;
+    }
+
+    *marker = '\0';
+    bool blackTurn;
+    Vector2f lastDoublePawn;
+    return loadFEN(line, board, &blackTurn, &lastDoublePawn);
+}
+
+// Thread body: turn raw lines into sparse evaluation traces
+static int loadWorker(void* data) {
+    TunerJob* job = data;
+    EvalTrace* trace = malloc(sizeof(EvalTrace));
+    TraceEntry scratch[EVAL_PARAM_COUNT];
+
+    for (int i = job->start; i < job->end; i++) {
+        unsigned char board[8][8];
+        job->loadedEntries[i] = NULL;
+        job->loadedEntryCounts[i] = 0;
+        if (!parseDatasetLine(job->lines[i], board, &job->loaded[i].result)) {
+            job->loadedEntryCounts[i] = -1;
+            continue;
+        }
+
+        evaluateWithParams(board, &evalParams, trace);
+
+        int count = 0;
+        for (int p = 0; p < EVAL_PARAM_COUNT; p++) {
+            if (trace->coef[p] != 0.0f) {
+                scratch[count].index = (unsigned short)p;
+                scratch[count].coef = trace->coef[p];
+                count++;
+            }
+        }
+        job->loadedEntries[i] = malloc(count * sizeof(TraceEntry));
+        memcpy(job->loadedEntries[i], scratch, count * sizeof(TraceEntry));
+        job->loadedEntryCounts[i] = count;
+    }
+
+    free(trace);
+    return 0;
+}
+
+static bool loadDataset(const char* path, Dataset* data) {
+    FILE* file = fopen(path, "r");
+    if (!file) {
+        fprintf(stderr, "Error: Could not open dataset %s\n", path);
+        return false;
+    }
+
+    int capacity = 1024, lineCount = 0;
+    char** lines = malloc(capacity * sizeof(char*));
+    char line[MAX_LINE_LENGTH];
+    while (fgets(line, sizeof(line), file)) {
+        if (line[0] == '\n' || line[0] == '#') continue;
+        if (lineCount == capacity) {
+            capacity *= 2;
+            lines = realloc(lines, capacity * sizeof(char*));
+        }
+        lines[lineCount] = malloc(strlen(line) + 1);
+        strcpy(lines[lineCount++], line);
+    }
+    fclose(file);
+
+    Uint64 startTime = SDL_GetPerformanceCounter();
+
+    TunerPosition* loaded = malloc((lineCount > 0 ? lineCount : 1) * sizeof(TunerPosition));
+    TraceEntry** loadedEntries = malloc((lineCount > 0 ? lineCount : 1) * sizeof(TraceEntry*));
+    int* loadedEntryCounts = malloc((lineCount > 0 ? lineCount : 1) * sizeof(int));
+
+    TunerJob* jobs = calloc(threadCount, sizeof(TunerJob));
+    SDL_Thread* threads[MAX_THREADS];
+    for (int t = 0; t < threadCount; t++) {
+        jobs[t].lines = lines;
+        jobs[t].loaded = loaded;
+        jobs[t].loadedEntries = loadedEntries;
+        jobs[t].loadedEntryCounts = loadedEntryCounts;
+        jobs[t].start = (int)((long long)lineCount * t / threadCount);
+        jobs[t].end = (int)((long long)lineCount * (t + 1) / threadCount);
+        threads[t] = SDL_CreateThread(loadWorker, "tuner-load", &jobs[t]);
+    }
+    for (int t = 0; t < threadCount; t++) {
+        SDL_WaitThread(threads[t], NULL);
+    }
+    free(jobs);
+
+    // Pack the per-line traces into one contiguous array
+    int totalEntries = 0, skipped = 0;
+    for (int i = 0; i < lineCount; i++) {
+        if (loadedEntryCounts[i] > 0) totalEntries += loadedEntryCounts[i];
+    }
+    data->positions = malloc((lineCount > 0 ? lineCount : 1) * sizeof(TunerPosition));
+    data->entries = malloc((totalEntries > 0 ? totalEntries : 1) * sizeof(TraceEntry));
+    data->count = 0;
+    data->entryCount = 0;
+    for (int i = 0; i < lineCount; i++) {
+        if (loadedEntryCounts[i] < 0) {
+            skipped++;
+        } else {
+            TunerPosition* pos = &data->positions[data->count++];
+            pos->result = loaded[i].result;
+            pos->firstEntry = data->entryCount;
+            pos->entryCount = loadedEntryCounts[i];
+            memcpy(&data->entries[data->entryCount], loadedEntries[i], loadedEntryCounts[i] * sizeof(TraceEntry));
+            data->entryCount += loadedEntryCounts[i];
+        }
+        free(loadedEntries[i]);
+        free(lines[i]);
+    }
+    free(loaded);
+    free(loadedEntries);
+    free(loadedEntryCounts);
+    free(lines);
+
+    double seconds = (double)(SDL_GetPerformanceCounter() - startTime) / SDL_GetPerformanceFrequency();
+    printf("Loaded %d positions (%d skipped) in %.2fs, %.0f positions/s\n",
+           data->count, skipped, seconds, seconds > 0 ? data->count / seconds : 0.0);
+    return data->count > 0;
+}
+
+static double sigmoid(double k, double score) {
+    return 1.0 / (1.0 + pow(10.0, -k * score / 400.0));
+}
+
+// Thread body: mean squared error and its gradient over a slice of the dataset
+static int errorWorker(void* data) {
+    TunerJob* job = data;
+    const Dataset* set = job->data;
+    job->error = 0.0;
+    memset(job->gradient, 0, sizeof(job->gradient));
+
+    for (int i = job->start; i < job->end; i++) {
+        const TunerPosition* pos = &set->positions[i];
+        const TraceEntry* entries = &set->entries[pos->firstEntry];
+
+        double score = 0.0;
+        for (int e = 0; e < pos->entryCount; e++) {
+            score += entries[e].coef * job->params[entries[e].index];
+        }
+
+        double s = sigmoid(job->k, score);
+        double diff = pos->result - s;
+        job->error += diff * diff;
+
+        // d/dparam of (result - s)^2
+        double base = -2.0 * diff * s * (1.0 - s) * log(10.0) * job->k / 400.0;
+        for (int e = 0; e < pos->entryCount; e++) {
+            job->gradient[entries[e].index] += base * entries[e].coef;
+        }
+    }
+    return 0;
+}
+
+// Mean error over the whole dataset; fills 'gradient' when it is not NULL
+static double computeError(const Dataset* data, const double* params, double k, double* gradient) {
+    static TunerJob jobs[MAX_THREADS];
+    SDL_Thread* threads[MAX_THREADS];
+
+    for (int t = 0; t < threadCount; t++) {
+        jobs[t].data = data;
+        jobs[t].params = params;
+        jobs[t].k = k;
+        jobs[t].start = (int)((long long)data->count * t / threadCount);
+        jobs[t].end = (int)((long long)data->count * (t + 1) / threadCount);
+        threads[t] = SDL_CreateThread(errorWorker, "tuner-error", &jobs[t]);
+    }
+
+    double error = 0.0;
+    if (gradient) {
+        memset(gradient, 0, EVAL_PARAM_COUNT * sizeof(double));
+    }
+    for (int t = 0; t < threadCount; t++) {
+        SDL_WaitThread(threads[t], NULL);
+        error += jobs[t].error;
+        if (gradient) {
+            for (int p = 0; p < EVAL_PARAM_COUNT; p++) {
+                gradient[p] += jobs[t].gradient[p];
+            }
+        }
+    }
+
+    if (gradient) {
+        for (int p = 0; p < EVAL_PARAM_COUNT; p++) {
+            gradient[p] /= data->count;
+        }
+    }
+    return error / data->count;
+}
+
+// Find the scaling constant K that best maps the current scores onto results
+static double findBestK(const Dataset* data, const double* params) {
+    double bestK = 1.0;
+    double bestError = computeError(data, params, bestK, NULL);
+    double step = 0.5;
+
+    for (int iteration = 0; iteration < 20; iteration++) {
+        bool improved = false;
+        for (int dir = -1; dir <= 1; dir += 2) {
+            double k = bestK + dir * step;
+            if (k <= 0.0) continue;
+            double error = computeError(data, params, k, NULL);
+            if (error < bestError) {
+                bestError = error;
+                bestK = k;
+                improved = true;
+            }
+        }
+        if (!improved) {
+            step /= 2.0;
+        }
+    }
+
+    printf("Best K = %.4f (error %.6f)\n", bestK, bestError);
+    return bestK;
+}
+
+static void writeTable(FILE* file, const char* name, const int table[8][8]) {
+    fprintf(file, "#define %s { \\\n", name);
+    for (int row = 0; row < 8; row++) {
+        fprintf(file, "    {");
+        for (int col = 0; col < 8; col++) {
+            fprintf(file, "%4d%s", table[row][col], col < 7 ? "," : "");
+        }
+        fprintf(file, "}%s \\\n", row < 7 ? "," : "");
+    }
+    fprintf(file, "}\n\n");
+}
+
+// Write the parameters in the format of eval_params.h
+static bool writeParamsHeader(const char* path, const EvalParams* params) {
+    FILE* file = fopen(path, "w");
+    if (!file) {
+        fprintf(stderr, "Error: Could not open file %s for writing\n", path);
+        return false;
+    }
+
+    fprintf(file, "// src/eval_params.h\n");
+    fprintf(file, "// Generated by the evaluation tuner (tuner.c). Re-run the tuner instead of\n");
+    fprintf(file, "// editing these values by hand; the next tuning run overwrites this file.\n");
+    fprintf(file, "#ifndef EVAL_PARAMS_H\n#define EVAL_PARAMS_H\n\n");
+
+    fprintf(file, "// Piece values\n");
+    fprintf(file, "#define PAWN_VALUE %d\n", params->pieceValue[PAWN]);
+    fprintf(file, "#define BISHOP_VALUE %d\n", params->pieceValue[BISHOP]);
+    fprintf(file, "#define KNIGHT_VALUE %d\n", params->pieceValue[KNIGHT]);
+    fprintf(file, "#define ROOK_VALUE %d\n", params->pieceValue[ROOK]);
+    fprintf(file, "#define QUEEN_VALUE %d\n\n", params->pieceValue[QUEEN]);
+
+    fprintf(file, "// Positional terms\n");
+    fprintf(file, "#define MOBILITY_WEIGHT %d\n", params->mobilityWeight);
+    fprintf(file, "#define KING_CENTER_PENALTY %d\n", params->kingCenterPenalty);
+    fprintf(file, "#define KING_PAWN_SHIELD_BONUS %d\n", params->kingPawnShieldBonus);
+    fprintf(file, "#define KING_IN_CHECK_PENALTY %d\n", params->kingInCheckPenalty);
+    fprintf(file, "#define PASSED_PAWN_BONUS %d\n", params->passedPawnBonus);
+    fprintf(file, "#define PASSED_PAWN_RANK_BONUS %d\n", params->passedPawnRankBonus);
+    fprintf(file, "#define DOUBLED_PAWN_PENALTY %d\n", params->doubledPawnPenalty);
+    fprintf(file, "#define ISOLATED_PAWN_PENALTY %d\n\n", params->isolatedPawnPenalty);
+
+    fprintf(file, "// Piece-square tables (same orientation as evaluatePieceSquareTables)\n");
+    const char* names[7] = {"", "PAWN", "BISHOP", "KNIGHT", "ROOK", "QUEEN", "KING"};
+    char tableName[32];
+    for (int piece = PAWN; piece <= KING; piece++) {
+        snprintf(tableName, sizeof(tableName), "%s_TABLE_MG", names[piece]);
+        writeTable(file, tableName, params->pstMG[piece]);
+        snprintf(tableName, sizeof(tableName), "%s_TABLE_EG", names[piece]);
+        writeTable(file, tableName, params->pstEG[piece]);
+    }
+
+    fprintf(file, "#endif // EVAL_PARAMS_H\n");
+    fclose(file);
+    printf("Wrote tuned parameters to %s\n", path);
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    const char* datasetPath = NULL;
+    const char* outputPath = "eval_params.h";
+    int epochs = 1000;
+    double learningRate = 1.0;
+    double k = 0.0; // 0 = fit K to the dataset first
+    threadCount = SDL_GetCPUCount();
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-t") == 0 && i + 1 < argc) {
+            threadCount = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-e") == 0 && i + 1 < argc) {
+            epochs = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-r") == 0 && i + 1 < argc) {
+            learningRate = atof(argv[++i]);
+        } else if (strcmp(argv[i], "-k") == 0 && i + 1 < argc) {
+            k = atof(argv[++i]);
+        } else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+            outputPath = argv[++i];
+        } else {
+            datasetPath = argv[i];
+        }
+    }
+    if (!datasetPath) {
+        printf("Usage: %s <dataset> [-t threads] [-e epochs] [-r learningRate] [-k K] [-o eval_params.h]\n", argv[0]);
+        return 1;
+    }
+    if (threadCount < 1) threadCount = 1;
+    if (threadCount > MAX_THREADS) threadCount = MAX_THREADS;
+    printf("Tuning %d parameters with %d threads\n", EVAL_PARAM_COUNT, threadCount);
+    initializeEngine();
+
+    Dataset data;
+    if (!loadDataset(datasetPath, &data)) {
+        return 1;
+    }
+
+    // Work on a double copy of the flat parameter array
+    double params[EVAL_PARAM_COUNT];
+    const int* initial = (const int*)&evalParams;
+    for (int p = 0; p < EVAL_PARAM_COUNT; p++) {
+        params[p] = initial[p];
+    }
+
+    if (k <= 0.0) {
+        k = findBestK(&data, params);
+    }
+
+    // Adam optimizer state
+    static double gradient[EVAL_PARAM_COUNT], momentum[EVAL_PARAM_COUNT], velocity[EVAL_PARAM_COUNT];
+    const double beta1 = 0.9, beta2 = 0.999, epsilon = 1e-8;
+
+    Uint64 startTime = SDL_GetPerformanceCounter();
+    double error = 0.0;
+    for (int epoch = 1; epoch <= epochs; epoch++) {
+        error = computeError(&data, params, k, gradient);
+
+        for (int p = 0; p < EVAL_PARAM_COUNT; p++) {
+            momentum[p] = beta1 * momentum[p] + (1.0 - beta1) * gradient[p];
+            velocity[p] = beta2 * velocity[p] + (1.0 - beta2) * gradient[p] * gradient[p];
+            double mHat = momentum[p] / (1.0 - pow(beta1, epoch));
+            double vHat = velocity[p] / (1.0 - pow(beta2, epoch));
+            params[p] -= learningRate * mHat / (sqrt(vHat) + epsilon);
+        }
+
+        if (epoch % 50 == 0 || epoch == epochs) {
+            double seconds = (double)(SDL_GetPerformanceCounter() - startTime) / SDL_GetPerformanceFrequency();
+            printf("Epoch %d: error %.6f, %.0f positions/s\n",
+                   epoch, error, seconds > 0 ? (double)data.count * epoch / seconds : 0.0);
+        }
+    }
+
+    // Round back into the integer weights the engine compiles against
+    EvalParams tuned = evalParams;
+    int* out = (int*)&tuned;
+    for (int p = 0; p < EVAL_PARAM_COUNT; p++) {
+        out[p] = (int)lround(params[p]);
+    }
+    tuned.pieceValue[KING] = KING_VALUE;
+
+    printf("Final error: %.6f\n", computeError(&data, params, k, NULL));
+    bool written = writeParamsHeader(outputPath, &tuned);
+
+    free(data.positions);
+    free(data.entries);
+    return written ? 0 : 1;
+}
@@ -0,0 +1,286 @@
+// src/uci.c
+// UCI front end: lets chess GUIs and tournament managers play and analyse with the engine
+// over stdin/stdout.
+//
+// Usage: uci
+//
+// Understands uci, isready, ucinewgame, setoption (Hash, MultiPV), stop, quit,
+//   position [startpos | fen <FEN>] [moves <move>...]
+//   go [depth N] [movetime MS] [wtime MS] [btime MS] [winc MS] [binc MS] [movestogo N] [infinite]
+// Every completed iteration prints one info line per PV line; MultiPV sets how many.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <SDL2/SDL.h>
+
+#include "engine.h"
+#include "Piece.h"
+
+#define ENGINE_NAME "Chess-Game"
+#define MAX_COMMAND_LENGTH 16384
+#define MAX_HASH_MB 1024
+#define DEFAULT_MOVES_TO_GO 30
+#define MIN_THINK_TIME_MS 10
+
+typedef struct {
+    // Position set by the last "position" command
+    unsigned char board[8][8];
+    bool blackTurn;
+    Vector2f lastDoublePawn;
+    Vector2f kings[2];
+    PositionHistory history;
+
+    // Options
+    TranspositionTable tt;
+    int hashMB;
+    int multiPV;
+
+    // The running search; the position above stays untouched while it runs
+    SDL_Thread* thread;
+    SDL_atomic_t stop;
+    bool infinite;               // Hold bestmove back until "stop"
+    SearchLimits limits;
+} UciEngine;
+
+// Output comes from both threads. The line and its newline go out in a single stdio call, which
+// holds the stream's lock throughout, so a readyok can't land in the middle of an info line.
+static void sendLine(const char* line) {
+    printf("%s\n", line);
+    fflush(stdout);
+}
+
+// "cp 35", or "mate 3" / "mate -3" in moves
+static void formatScore(int score, char* text, size_t size) {
+    if (abs(score) >= MATE_SCORE - MAX_PV_LENGTH) {
+        int moves = (MATE_SCORE - abs(score) + 1) / 2;
+        snprintf(text, size, "mate %d", score < 0 ? -moves : moves);
+    } else {
+        snprintf(text, size, "cp %d", score);
+    }
+}
+
+// Runs on the search thread after every completed iteration
+static void sendInfo(const SearchResult* result, void* data) {
+    (void)data;
+    long long nps = result->timeMs > 0 ? result->nodes * 1000 / result->timeMs : 0;
+    for (int i = 0; i < result->lineCount; i++) {
+        const SearchLine* line = &result->lines[i];
+        char text[MAX_PV_LENGTH * 6 + 160];
+        char score[24];
+        formatScore(line->score, score, sizeof(score));
+        int length = snprintf(text, sizeof(text), "info depth %d multipv %d score %s nodes %lld nps %lld time %d pv",
+                              result->depth, i + 1, score, result->nodes, nps, result->timeMs);
+        for (int j = 0; j < line->pvLength; j++) {
+            text[length++] = ' ';
+            moveToCoordinates(line->pv[j], text + length);
+            length += (int)strlen(text + length);
+        }
+        sendLine(text);
+    }
+}
+
+static int searchThreadMain(void* data) {
+    UciEngine* engine = data;
+    SearchResult result = searchPosition(engine->board, engine->blackTurn ? 1 : 0, &engine->lastDoublePawn,
+                                         engine->kings, &engine->history, &engine->limits);
+
+    // "go infinite" answers only once told to stop, even when the search ended first
+    while (engine->infinite && !SDL_AtomicGet(&engine->stop)) {
+        SDL_Delay(1);
+    }
+
+    char text[32] = "bestmove 0000";
+    if (result.bestMove.from.x != -1) {
+        strcpy(text, "bestmove ");
+        moveToCoordinates(result.bestMove, text + strlen(text));
+        if (result.pvLength > 1) {
+            strcat(text, " ponder ");
+            moveToCoordinates(result.pv[1], text + strlen(text));
+        }
+    }
+    sendLine(text);
+    return 0;
+}
+
+static void stopSearch(UciEngine* engine) {
+    if (engine->thread) {
+        SDL_AtomicSet(&engine->stop, 1);
+        SDL_WaitThread(engine->thread, NULL);
+        engine->thread = NULL;
+    }
+}
+
+static void setStartPosition(UciEngine* engine) {
+    loadFEN(START_FEN, engine->board, &engine->blackTurn, &engine->lastDoublePawn);
+    findKings(engine->board, engine->kings);
+    resetPositionHistory(&engine->history, engine->board, 0, &engine->lastDoublePawn, 0);
+}
+
+// position [startpos | fen <FEN>] [moves <move>...]
+static void setPosition(UciEngine* engine, char* arguments) {
+    char* moves = strstr(arguments, "moves");
+    if (moves) {
+        *moves = '\0';
+        moves += strlen("moves");
+    }
+
+    char* fen = strstr(arguments, "fen");
+    if (fen) {
+        fen += strlen("fen");
+        while (*fen == ' ') fen++;
+        if (!loadFEN(fen, engine->board, &engine->blackTurn, &engine->lastDoublePawn)) {
+            fprintf(stderr, "Error: Invalid FEN \"%s\"\n", fen);
+            setStartPosition(engine);
+            return;
+        }
+        findKings(engine->board, engine->kings);
+
+        // The halfmove clock is the fifth field
+        int halfmoveClock = 0;
+        char* field = fen;
+        for (int i = 0; i < 4 && field; i++) {
+            field = strchr(field, ' ');
+            if (field) field++;
+        }
+        if (field) halfmoveClock = atoi(field);
+        resetPositionHistory(&engine->history, engine->board, engine->blackTurn ? 1 : 0, &engine->lastDoublePawn, halfmoveClock);
+    } else {
+        setStartPosition(engine);
+    }
+
+    for (char* token = moves ? strtok(moves, " \t") : NULL; token; token = strtok(NULL, " \t")) {
+        unsigned char color = engine->blackTurn ? 1 : 0;
+        EngineMove move;
+        if (!parseCoordinateMove(engine->board, color, &engine->lastDoublePawn, token, &move)) {
+            fprintf(stderr, "Error: Illegal move \"%s\", ignoring the rest\n", token);
+            return;
+        }
+        bool irreversible = move.capturedPiece != NONE || (engine->board[move.from.x][move.from.y] & TYPE_MASK) == PAWN;
+        engineMakeMove(engine->board, move, &engine->lastDoublePawn, engine->kings, 0);
+        engine->blackTurn = !engine->blackTurn;
+        recordPosition(&engine->history, engine->board, engine->blackTurn ? 1 : 0, &engine->lastDoublePawn, irreversible);
+    }
+}
+
+// go [depth N] [movetime MS] [wtime MS] [btime MS] [winc MS] [binc MS] [movestogo N] [infinite]
+static void startSearch(UciEngine* engine, char* arguments) {
+    int depth = 0, moveTime = 0, movesToGo = DEFAULT_MOVES_TO_GO;
+    int remaining[2] = {-1, -1}, increment[2] = {0, 0};
+    engine->infinite = false;
+
+    for (char* token = strtok(arguments, " \t"); token; token = strtok(NULL, " \t")) {
+        if (strcmp(token, "infinite") == 0) {
+            engine->infinite = true;
+            continue;
+        }
+        char* value = strtok(NULL, " \t");
+        if (!value) break;
+        int number = atoi(value);
+        if (strcmp(token, "depth") == 0) depth = number;
+        else if (strcmp(token, "movetime") == 0) moveTime = number;
+        else if (strcmp(token, "wtime") == 0) remaining[0] = number;
+        else if (strcmp(token, "btime") == 0) remaining[1] = number;
+        else if (strcmp(token, "winc") == 0) increment[0] = number;
+        else if (strcmp(token, "binc") == 0) increment[1] = number;
+        else if (strcmp(token, "movestogo") == 0 && number > 0) movesToGo = number;
+    }
+
+    // Budget on a clock: a slice of the remaining time plus most of the increment
+    int color = engine->blackTurn ? 1 : 0;
+    if (moveTime == 0 && remaining[color] >= 0 && !engine->infinite) {
+        moveTime = remaining[color] / movesToGo + increment[color] * 3 / 4;
+        if (moveTime > remaining[color] / 2) moveTime = remaining[color] / 2;
+        if (moveTime < MIN_THINK_TIME_MS) moveTime = MIN_THINK_TIME_MS;
+    }
+
+    SearchLimits limits = {depth, engine->infinite ? 0 : moveTime, NULL, &engine->tt, &engine->stop, sendInfo, engine, engine->multiPV};
+    engine->limits = limits;
+    SDL_AtomicSet(&engine->stop, 0);
+    engine->thread = SDL_CreateThreadWithStackSize(searchThreadMain, "search", SEARCH_STACK_SIZE, engine);
+    if (!engine->thread) {
+        fprintf(stderr, "Error: Could not create search thread: %s\n", SDL_GetError());
+        sendLine("bestmove 0000");
+    }
+}
+
+// setoption name <name> value <value>
+static void setOption(UciEngine* engine, char* arguments) {
+    char* name = strstr(arguments, "name");
+    char* value = strstr(arguments, "value");
+    if (!name || !value) return;
+    name += strlen("name");
+    while (*name == ' ') name++;
+    int number = atoi(value + strlen("value"));
+
+    if (strncmp(name, "Hash", 4) == 0) {
+        if (number < 1) number = 1;
+        if (number > MAX_HASH_MB) number = MAX_HASH_MB;
+        freeTranspositionTable(&engine->tt);
+        if (initTranspositionTable(&engine->tt, number)) {
+            engine->hashMB = number;
+        } else {
+            fprintf(stderr, "Error: Out of memory for a %d MB table\n", number);
+            initTranspositionTable(&engine->tt, engine->hashMB);
+        }
+    } else if (strncmp(name, "MultiPV", 7) == 0) {
+        engine->multiPV = number < 1 ? 1 : number > MAX_MULTI_PV ? MAX_MULTI_PV : number;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    (void)argc;
+    (void)argv;
+    initializeEngine();
+
+    UciEngine* engine = calloc(1, sizeof(UciEngine));
+    if (!engine || !initTranspositionTable(&engine->tt, DEFAULT_TT_SIZE_MB)) {
+        fprintf(stderr, "Error: Out of memory\n");
+        return 1;
+    }
+    engine->hashMB = DEFAULT_TT_SIZE_MB;
+    engine->multiPV = 1;
+    setStartPosition(engine);
+
+    static char command[MAX_COMMAND_LENGTH];
+    while (fgets(command, sizeof(command), stdin)) {
+        command[strcspn(command, "\r\n")] = '\0';
+        char* arguments = strchr(command, ' ');
+        if (arguments) *arguments++ = '\0';
+        else arguments = command + strlen(command);
+
+        if (strcmp(command, "uci") == 0) {
+            char text[128];
+            sendLine("id name " ENGINE_NAME);
+            sendLine("id author " ENGINE_NAME " contributors");
+            snprintf(text, sizeof(text), "option name Hash type spin default %d min 1 max %d", DEFAULT_TT_SIZE_MB, MAX_HASH_MB);
+            sendLine(text);
+            snprintf(text, sizeof(text), "option name MultiPV type spin default 1 min 1 max %d", MAX_MULTI_PV);
+            sendLine(text);
+            sendLine("uciok");
+        } else if (strcmp(command, "isready") == 0) {
+            sendLine("readyok");
+        } else if (strcmp(command, "ucinewgame") == 0) {
+            stopSearch(engine);
+            clearTranspositionTable(&engine->tt);
+            setStartPosition(engine);
+        } else if (strcmp(command, "setoption") == 0) {
+            stopSearch(engine);
+            setOption(engine, arguments);
+        } else if (strcmp(command, "position") == 0) {
+            stopSearch(engine);
+            setPosition(engine, arguments);
+        } else if (strcmp(command, "go") == 0) {
+            stopSearch(engine);
+            startSearch(engine, arguments);
+        } else if (strcmp(command, "stop") == 0) {
+            stopSearch(engine);
+        } else if (strcmp(command, "quit") == 0) {
+            break;
+        }
+    }
+
+    stopSearch(engine);
+    freeTranspositionTable(&engine->tt);
+    free(engine);
+    return 0;
+}